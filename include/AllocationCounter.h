@@ -0,0 +1,15 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+// Heap allocation counting, for checking that hot paths (chunk builds) stay allocation-free.
+// Counting replaces the global operator new, so it is only compiled in with TERRAIN_COUNT_ALLOCATIONS
+// (CMake option of the same name); otherwise every count reads 0 and isEnabled() is false.
+namespace AllocationCounter {
+    bool isEnabled();
+    uint64_t threadAllocations(); // operator new calls made by the calling thread so far
+    uint64_t totalAllocations();  // ... by all threads
+}
+
+#endif // ALLOCATION_COUNTER_H
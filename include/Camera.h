@@ -25,10 +25,17 @@ const float SENSITIVITY =  0.1f;
 const float ZOOM        =  45.0f;
 
 
+// Point everything is drawn relative to: the camera's horizontal position, with heights left absolute (the
+// height shading reads them). Subtracting it in double before narrowing to float keeps vertex positions
+// small, so the terrain does not jitter far from the world origin.
+inline glm::dvec3 renderOriginFor(const glm::dvec3& position) {
+    return glm::dvec3(position.x, 0.0, position.z);
+}
+
 class Camera {
 public:
     // Camera Attributes
-    glm::vec3 Position;
+    glm::dvec3 Position; // Double: at 1e7 units a float position only moves in whole units
     glm::vec3 Front;
     glm::vec3 Up;
     glm::vec3 Right;
@@ -42,7 +49,7 @@ public:
     float Zoom;
 
     // Constructor with vectors
-    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), 
+    Camera(glm::dvec3 position = glm::dvec3(0.0, 0.0, 0.0), 
            glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), 
            float yaw = YAW, float pitch = PITCH);
     // Constructor with scalar values
@@ -50,7 +57,10 @@ public:
            float upX, float upY, float upZ, 
            float yaw, float pitch);
 
+    // View matrix for the camera at its position relative to GetRenderOrigin(); pair it with model matrices
+    // and uniforms relative to the same origin
     glm::mat4 GetViewMatrix();
+    glm::dvec3 GetRenderOrigin() const { return renderOriginFor(Position); }
     void ProcessKeyboard(Camera_Movement direction, float deltaTime);
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true);
     void ProcessMouseScroll(float yoffset);
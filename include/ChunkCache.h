@@ -0,0 +1,54 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include "terrain_types.h" // For Vec2i
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+class PerlinNoise;
+
+// Persistent on-disk cache of chunk heights, so revisiting an area (in this run or a later one with the same
+// seed) skips the noise evaluation. Each chunk is one small binary file holding its bordered height grid
+// (see Chunk::generateHeights), before MESH_VERTICAL_SCALE, so it serves every mesher and LOD setting.
+//
+// Files live in <root>/<key>/ where the key hashes the format version, the noise permutation and every
+// Chunk:: parameter that shapes the heights. Changing any of them switches to a fresh directory, so stale
+// data is never read; the header repeats the key and coordinates as a guard against collisions and
+// truncated files. Reads use mmap where available; writes go to a temporary file that is then renamed.
+// read() and write() may be called from several worker threads, as long as no two work on the same chunk.
+class ChunkCache {
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+
+    ChunkCache();
+
+    // Enables the cache under rootDirectory (created if needed). Returns false and stays disabled on failure.
+    bool open(const std::string& rootDirectory, const PerlinNoise& noise);
+    void close();
+    bool isOpen() const { return open_; }
+    const std::string& getDirectory() const { return directory_; }
+
+    // Fills 'heights' (count floats) from the cache; false on a miss or an unusable file
+    bool read(Vec2i coords, float* heights, size_t count);
+    bool write(Vec2i coords, const float* heights, size_t count);
+
+    // Hash of everything that shapes a chunk's heights for this noise generator
+    static uint64_t computeParameterKey(const PerlinNoise& noise);
+
+private:
+    std::atomic<bool> open_;
+    std::string root_;
+    std::string directory_;
+    uint64_t noiseHash_; // Hash of the permutation table, which never changes for one generator
+    uint64_t key_;
+    std::mutex mutex_;   // Guards the key and directory; file I/O runs unlocked
+
+    bool refreshKey();   // Picks up changed Chunk:: parameters; false if the new directory cannot be created
+    // Under the lock: refreshes the key and formats the .bin and .tmp paths of a chunk
+    bool locate(Vec2i coords, char* path, char* temporaryPath, size_t pathSize, uint64_t& key);
+};
+
+#endif // CHUNK_CACHE_H
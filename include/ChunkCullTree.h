@@ -0,0 +1,156 @@
+#ifndef CHUNK_CULL_TREE_H
+#define CHUNK_CULL_TREE_H
+
+#include "terrain_types.h" // For Vec2i
+#include "Mesh.h"          // For BoundingBox
+#include "Frustum.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm> // For std::min
+#include <cstdint>
+#include <cstddef>
+
+// What one ChunkCullTree::cull pass did
+struct ChunkCullStats {
+    size_t boundsTested = 0;  // Frustum tests, of blocks and of chunks
+    size_t blocksCulled = 0;  // Blocks of several chunks rejected with one test
+    size_t chunksCulled = 0;
+    size_t chunksVisible = 0;
+};
+
+// Quadtree over a square of chunk positions (TerrainManager's window), holding the world-space bounds of the
+// chunks that are drawable. Level 0 has one leaf per position; each level above merges 2x2 nodes of the one
+// below, up to a single root. cull() walks it from the root: a block outside the frustum is dropped with one
+// test, a block entirely inside accepts all its chunks without further tests, and only blocks crossing the
+// frustum's planes are opened (testing just the planes they cross). Large radii then cost a few dozen tests
+// instead of one per chunk.
+class ChunkCullTree {
+public:
+    ChunkCullTree() : side_(0) {}
+
+    // Rebuilds over the side x side positions starting at origin (the minimum corner).
+    // boundsOf(coords, BoundingBox&) fills the chunk's world bounds and returns false for positions with none.
+    template <typename BoundsFn>
+    void build(Vec2i origin, int side, BoundsFn&& boundsOf) {
+        origin_ = origin;
+        side_ = side < 0 ? 0 : side;
+        levelSides_.clear();
+        for (int levelSide = side_; ; levelSide = (levelSide + 1) / 2) {
+            levelSides_.push_back(levelSide);
+            if (levelSide <= 1) break;
+        }
+        levels_.resize(levelSides_.size());
+        for (size_t level = 0; level < levels_.size(); ++level) {
+            levels_[level].assign(static_cast<size_t>(levelSides_[level]) * levelSides_[level], Node());
+        }
+        for (int z = 0; z < side_; ++z) {
+            for (int x = 0; x < side_; ++x) {
+                Node& leaf = levels_[0][static_cast<size_t>(z) * side_ + x];
+                leaf.chunkCount = boundsOf(Vec2i(origin_.x + x, origin_.z + z), leaf.bounds) ? 1 : 0;
+            }
+        }
+        for (size_t level = 1; level < levels_.size(); ++level) {
+            for (int z = 0; z < levelSides_[level]; ++z) {
+                for (int x = 0; x < levelSides_[level]; ++x) {
+                    refresh(static_cast<int>(level), x, z);
+                }
+            }
+        }
+    }
+
+    bool covers(Vec2i origin, int side) const { return side_ == side && origin_ == origin && side_ > 0; }
+    void invalidate() { side_ = 0; } // The next use must build()
+
+    // One position gained, lost or changed its chunk: refreshes its leaf and the blocks above it
+    template <typename BoundsFn>
+    void update(Vec2i coords, BoundsFn&& boundsOf) {
+        int x = coords.x - origin_.x;
+        int z = coords.z - origin_.z;
+        if (x < 0 || z < 0 || x >= side_ || z >= side_) {
+            return;
+        }
+        Node& leaf = levels_[0][static_cast<size_t>(z) * side_ + x];
+        leaf.bounds = BoundingBox();
+        leaf.chunkCount = boundsOf(coords, leaf.bounds) ? 1 : 0;
+        for (size_t level = 1; level < levels_.size(); ++level) {
+            x /= 2;
+            z /= 2;
+            refresh(static_cast<int>(level), x, z);
+        }
+    }
+
+    // Calls onVisible(coords) for every chunk whose bounds are not entirely outside the frustum
+    template <typename VisibleFn>
+    void cull(const Frustum& frustum, VisibleFn&& onVisible, ChunkCullStats& stats) const {
+        if (levels_.empty() || side_ == 0) {
+            return;
+        }
+        cullNode(static_cast<int>(levels_.size()) - 1, 0, 0, Frustum::ALL_PLANES, frustum, onVisible, stats);
+    }
+
+private:
+    struct Node {
+        BoundingBox bounds;      // Union of the chunk bounds below; empty (min > max) without chunks
+        uint32_t chunkCount = 0;
+    };
+    std::vector<std::vector<Node>> levels_;
+    std::vector<int> levelSides_;
+    Vec2i origin_;
+    int side_;
+
+    void refresh(int level, int x, int z) {
+        Node& node = levels_[level][static_cast<size_t>(z) * levelSides_[level] + x];
+        node = Node();
+        int childSide = levelSides_[level - 1];
+        for (int cz = 2 * z; cz <= 2 * z + 1 && cz < childSide; ++cz) {
+            for (int cx = 2 * x; cx <= 2 * x + 1 && cx < childSide; ++cx) {
+                const Node& child = levels_[level - 1][static_cast<size_t>(cz) * childSide + cx];
+                if (child.chunkCount == 0) continue;
+                node.bounds.min = glm::min(node.bounds.min, child.bounds.min);
+                node.bounds.max = glm::max(node.bounds.max, child.bounds.max);
+                node.chunkCount += child.chunkCount;
+            }
+        }
+    }
+
+    template <typename VisibleFn>
+    void cullNode(int level, int x, int z, unsigned planeMask, const Frustum& frustum, VisibleFn& onVisible, ChunkCullStats& stats) const {
+        const Node& node = levels_[level][static_cast<size_t>(z) * levelSides_[level] + x];
+        if (node.chunkCount == 0) {
+            return;
+        }
+        if (planeMask != 0) {
+            stats.boundsTested++;
+            if (frustum.classifyAABB(node.bounds, planeMask) == FrustumTest::Outside) {
+                stats.chunksCulled += node.chunkCount;
+                if (level > 0) stats.blocksCulled++;
+                return;
+            }
+        }
+        if (planeMask == 0 || level == 0) {
+            acceptAll(level, x, z, onVisible, stats); // Inside every plane (or a single visible chunk)
+            return;
+        }
+        int childSide = levelSides_[level - 1];
+        for (int cz = 2 * z; cz <= 2 * z + 1 && cz < childSide; ++cz) {
+            for (int cx = 2 * x; cx <= 2 * x + 1 && cx < childSide; ++cx) {
+                cullNode(level - 1, cx, cz, planeMask, frustum, onVisible, stats);
+            }
+        }
+    }
+
+    template <typename VisibleFn>
+    void acceptAll(int level, int x, int z, VisibleFn& onVisible, ChunkCullStats& stats) const {
+        int x0 = x << level, z0 = z << level;
+        int x1 = std::min((x + 1) << level, side_), z1 = std::min((z + 1) << level, side_);
+        for (int lz = z0; lz < z1; ++lz) {
+            for (int lx = x0; lx < x1; ++lx) {
+                if (levels_[0][static_cast<size_t>(lz) * side_ + lx].chunkCount == 0) continue;
+                onVisible(Vec2i(origin_.x + lx, origin_.z + lz));
+                stats.chunksVisible++;
+            }
+        }
+    }
+};
+
+#endif // CHUNK_CULL_TREE_H
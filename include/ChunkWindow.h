@@ -0,0 +1,116 @@
+#ifndef CHUNK_WINDOW_H
+#define CHUNK_WINDOW_H
+
+#include "terrain_types.h" // For Vec2i
+#include <vector>
+#include <cstdlib> // For std::abs
+
+// Square window of (2 * radius + 1)^2 chunk slots centred on a chunk coordinate, stored toroidally: chunk (x, z)
+// always lives in slot (x mod size, z mod size), so moving the window never moves the slots. Recentering only
+// visits the strips that leave and enter, O(size * shift) instead of comparing the old and new sets, and a
+// lookup is two modulos instead of a hash. Used by TerrainManager for the chunks inside the unload radius.
+template <typename T>
+class ChunkWindow {
+public:
+    ChunkWindow() : radius_(-1), size_(0) {}
+
+    // Resizes the window (all slots value-initialized); the caller empties the old slots first
+    void reset(int radius, Vec2i center) {
+        radius_ = radius < 0 ? 0 : radius;
+        size_ = 2 * radius_ + 1;
+        center_ = center;
+        slots_.clear();
+        slots_.resize(static_cast<size_t>(size_) * size_);
+    }
+
+    bool isValid() const { return radius_ >= 0; }
+    int getRadius() const { return radius_; }
+    Vec2i getCenter() const { return center_; }
+    size_t getSlotCount() const { return slots_.size(); }
+
+    bool contains(Vec2i coords) const {
+        return radius_ >= 0 && std::abs(coords.x - center_.x) <= radius_ && std::abs(coords.z - center_.z) <= radius_;
+    }
+
+    // Only valid for coordinates inside the window
+    T& at(Vec2i coords) { return slots_[slotIndex(coords)]; }
+    const T& at(Vec2i coords) const { return slots_[slotIndex(coords)]; }
+
+    // Null outside the window
+    T* find(Vec2i coords) { return contains(coords) ? &slots_[slotIndex(coords)] : nullptr; }
+    const T* find(Vec2i coords) const { return contains(coords) ? &slots_[slotIndex(coords)] : nullptr; }
+
+    // Moves the window to newCenter. onLeave(coords, slot) runs for every chunk position that drops out and must
+    // leave the slot empty, because the same slot then holds a position that comes in (see forEachOutside for
+    // those). A jump of a full window or more visits every slot once.
+    template <typename LeaveFn>
+    void recenter(Vec2i newCenter, LeaveFn&& onLeave) {
+        if (newCenter == center_) {
+            return;
+        }
+        forEachOutside(center_, newCenter, radius_, [this, &onLeave](const Vec2i& coords) {
+            onLeave(coords, slots_[slotIndex(coords)]);
+        });
+        center_ = newCenter;
+    }
+
+    // Visits every position in the window, row by row, as fn(coords, slot)
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (int z = center_.z - radius_; z <= center_.z + radius_; ++z) {
+            for (int x = center_.x - radius_; x <= center_.x + radius_; ++x) {
+                Vec2i coords(x, z);
+                fn(coords, slots_[slotIndex(coords)]);
+            }
+        }
+    }
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (int z = center_.z - radius_; z <= center_.z + radius_; ++z) {
+            for (int x = center_.x - radius_; x <= center_.x + radius_; ++x) {
+                Vec2i coords(x, z);
+                fn(coords, slots_[slotIndex(coords)]);
+            }
+        }
+    }
+
+    // Visits fn(coords) for the positions of the square of 'radius' around 'from' that are not in the square of
+    // the same radius around 'to': whole rows outside the other square's z range, and in the shared rows only the
+    // columns outside its x range. With from = new centre and to = old centre these are the positions entering.
+    template <typename Fn>
+    static void forEachOutside(Vec2i from, Vec2i to, int radius, Fn&& fn) {
+        for (int z = from.z - radius; z <= from.z + radius; ++z) {
+            bool rowShared = std::abs(z - to.z) <= radius;
+            int xBegin = from.x - radius;
+            int xEnd = from.x + radius;
+            if (rowShared) {
+                if (std::abs(from.x - to.x) > 2 * radius) {
+                    // Disjoint columns: the whole row is outside
+                } else if (to.x > from.x) {
+                    xEnd = to.x - radius - 1;   // Left strip
+                } else {
+                    xBegin = to.x + radius + 1; // Right strip
+                }
+            }
+            for (int x = xBegin; x <= xEnd; ++x) {
+                fn(Vec2i(x, z));
+            }
+        }
+    }
+
+private:
+    int radius_;
+    int size_;
+    Vec2i center_;
+    std::vector<T> slots_;
+
+    int wrap(int value) const {
+        int wrapped = value % size_;
+        return wrapped < 0 ? wrapped + size_ : wrapped;
+    }
+    size_t slotIndex(Vec2i coords) const {
+        return static_cast<size_t>(wrap(coords.z)) * size_ + static_cast<size_t>(wrap(coords.x));
+    }
+};
+
+#endif // CHUNK_WINDOW_H
@@ -0,0 +1,72 @@
+#ifndef EVICTED_CHUNK_CACHE_H
+#define EVICTED_CHUNK_CACHE_H
+
+#include "terrain_types.h" // For Vec2i
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+class Chunk;
+
+// What is kept of a chunk that left TerrainManager's unload radius: either the whole chunk with its GPU buffers
+// (drawable again as soon as it is taken back) or only its bordered heights (the mesh is rebuilt from them).
+struct EvictedChunk {
+    std::unique_ptr<Chunk> chunk;
+    std::vector<float> heights;
+};
+
+// Memory-budgeted LRU of evicted chunks, keyed by grid coordinates. Lookups go through an open-addressing table
+// (linear probing, power-of-two size, at most half full) hashed with std::hash<Vec2i>; entries live in a node
+// array threaded on a doubly linked recency list, so insert, take and dropping the oldest are all O(1).
+// Main thread only.
+class EvictedChunkCache {
+public:
+    EvictedChunkCache();
+    ~EvictedChunkCache();
+    EvictedChunkCache(const EvictedChunkCache&) = delete;
+    EvictedChunkCache& operator=(const EvictedChunkCache&) = delete;
+
+    // Budget for the summed entry sizes; lowering it drops the oldest entries on the next insert
+    void setMaxBytes(size_t maxBytes) { maxBytes_ = maxBytes; }
+    size_t getMaxBytes() const { return maxBytes_; }
+
+    // Stores 'entry' as the most recent one (replacing any entry for the same coordinates), then drops least
+    // recently used entries until the total fits the budget. Dropped entries (possibly this one, if it alone
+    // exceeds the budget) are appended to 'dropped' so the caller can release what they hold.
+    void insert(Vec2i coords, EvictedChunk&& entry, size_t bytes, std::vector<EvictedChunk>& dropped);
+    // Removes and returns the entry for coords; false on a miss
+    bool take(Vec2i coords, EvictedChunk& out);
+    bool contains(Vec2i coords) const { return findBucket(coords) >= 0; }
+    // Moves every entry to 'dropped'
+    void clear(std::vector<EvictedChunk>& dropped);
+
+    size_t size() const { return count_; }
+    size_t getBytes() const { return bytes_; }
+
+private:
+    struct Node {
+        Vec2i coords;
+        EvictedChunk entry;
+        size_t bytes = 0;
+        int32_t newer = -1; // Recency list; -1 ends it
+        int32_t older = -1;
+    };
+    std::vector<Node> nodes_;
+    std::vector<int32_t> freeNodes_;
+    std::vector<int32_t> table_; // Node index per bucket, -1 if empty
+    int32_t newest_;
+    int32_t oldest_;
+    size_t count_;
+    size_t bytes_;
+    size_t maxBytes_;
+
+    size_t bucketFor(Vec2i coords) const;
+    int32_t findBucket(Vec2i coords) const; // -1 on a miss
+    void eraseBucket(size_t bucket);        // Backward-shift deletion keeps probe chains unbroken
+    void grow();
+    void unlink(int32_t node);
+    void removeNode(int32_t node, EvictedChunk& out);
+};
+
+#endif // EVICTED_CHUNK_CACHE_H
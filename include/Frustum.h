@@ -2,7 +2,9 @@
 #define FRUSTUM_H
 
 #include <glm/glm.hpp>
-#include "Mesh.h" // <<< This line is important to define BoundingBox
+#include "Mesh.h" // <<< This line is important to define BoundingBox (and AABBBatch)
+#include <cstddef>
+#include <cstdint>
 
 // Defines a plane equation: normal.x*x + normal.y*y + normal.z*z + distance = 0
 struct Plane {
@@ -36,13 +38,48 @@ struct Plane {
     }
 };
 
+// Result of Frustum::classifyAABB
+enum class FrustumTest {
+    Outside,
+    Intersecting,
+    Inside
+};
+
+// Instruction set Frustum::cullBatch runs on
+enum class CullBackend {
+    Scalar,
+    AVX2,   // 8 boxes per instruction
+    AVX512  // 16 boxes per instruction
+};
+
 class Frustum {
 public:
     Plane planes[6]; // 0:Left, 1:Right, 2:Bottom, 3:Top, 4:Near, 5:Far
 
     Frustum() = default;
     void update(const glm::mat4& viewProjectionMatrix);
+    // For a view-projection matrix relative to renderOrigin (see Camera::GetViewMatrix): the planes are moved
+    // back to absolute world space (in double), so chunk bounds can stay in world coordinates
+    void update(const glm::mat4& relativeViewProjectionMatrix, const glm::dvec3& renderOrigin);
     bool isAABBVisible(const BoundingBox& bbox) const; // Name can be isAABBVisible, but type is BoundingBox
+    // Like isAABBVisible, but also tells boxes entirely inside apart, for hierarchical culling. planeMask holds
+    // the planes still to test (bit i = planes[i], ALL_PLANES to start); planes the box is entirely inside are
+    // cleared, so the children of a box never test them again.
+    static const unsigned ALL_PLANES = 0x3Fu;
+    FrustumTest classifyAABB(const BoundingBox& bbox, unsigned& planeMask) const;
+
+    // isAABBVisible for a whole batch of boxes, each moved by 'offset' (e.g. mesh-space bounds of a translated
+    // mesh). Writes the indices of the boxes not entirely outside to visibleIndices, which needs room for
+    // boxes.size(), in increasing order and returns how many there are. Each box starts with the plane that
+    // rejected it last time (boxes.planeHint, updated here), so boxes that stay off screen usually cost one plane.
+    size_t cullBatch(AABBBatch& boxes, uint32_t* visibleIndices, const glm::vec3& offset = glm::vec3(0.0f)) const;
+
+    // The instruction set cullBatch uses, for every frustum. Defaults to the best one the CPU has; asking for
+    // one it lacks falls back to the best it has.
+    static void setCullBackend(CullBackend backend);
+    static CullBackend getCullBackend();
+    static CullBackend bestCullBackend();
+    static const char* cullBackendName(CullBackend backend);
 
 private:
     // Plane planes[6]; // Or your plane storage
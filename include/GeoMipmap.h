@@ -0,0 +1,69 @@
+#ifndef GEOMIPMAP_H
+#define GEOMIPMAP_H
+
+#include <vector>
+#include <glad/glad.h>
+#include "IndexOptimizer.h"
+
+class HeightMap;
+
+// Edges of a chunk that border a neighbor one LOD level coarser.
+// The grid is row-major with x along rows and z along columns, as in Mesh::generateFromHeightMap.
+enum GeoMipmapEdge {
+    EDGE_NEG_X = 1 << 0,
+    EDGE_POS_X = 1 << 1,
+    EDGE_NEG_Z = 1 << 2,
+    EDGE_POS_Z = 1 << 3
+};
+
+// Shared index buffer holding every LOD level of a (2^n + 1)^2 vertex grid, each with the 16 edge-stitching
+// variants. All chunks share the same vertex layout, so one GeoMipmapIndexSet serves the whole terrain and
+// a chunk only picks a (level, stitch mask) range to draw from its own vertex buffer.
+class GeoMipmapIndexSet {
+public:
+    static const int STITCH_VARIANTS = 16;
+
+    struct Range {
+        size_t byteOffset = 0;
+        GLsizei count = 0;
+        size_t triangleCount = 0;
+    };
+
+    GeoMipmapIndexSet();
+    ~GeoMipmapIndexSet();
+
+    // Builds all index variants for a width x depth grid. Both dimensions must be 2^n + 1 and equal.
+    // Returns false (and leaves the set empty) if the resolution is not supported.
+    bool build(int width, int depth, int cacheSize = 16);
+    void setupGPU();   // Uploads the shared EBO (needs a GL context)
+    void clearGPUData();
+
+    bool isValid() const { return levelCount_ > 0; }
+    int getLevelCount() const { return levelCount_; }
+    int getGridWidth() const { return width_; }
+    int getGridDepth() const { return depth_; }
+    GLuint getEBO() const { return EBO_; }
+    GLenum getIndexType() const { return indexType_; }
+
+    // stitchMask is a combination of GeoMipmapEdge bits; it is ignored on the coarsest level.
+    const Range& getRange(int level, int stitchMask) const;
+
+    // Emits the triangle list for one level/variant (exposed for tools and for building custom sets).
+    static void buildLevelTriangles(int width, int depth, int level, int stitchMask, std::vector<unsigned int>& out);
+
+private:
+    int width_, depth_;
+    int levelCount_;
+    GLenum indexType_;
+    GLuint EBO_;
+    std::vector<Range> ranges_;            // levelCount_ * STITCH_VARIANTS
+    std::vector<uint16_t> indices16_;      // Kept until setupGPU()
+    std::vector<uint32_t> indices32_;
+};
+
+// Per-level geometric error of a heightmap grid: the largest vertical distance between the full-resolution
+// surface and the surface drawn at each LOD level (monotonically non-decreasing, level 0 is 0).
+// outErrors must hold levelCount floats.
+void computeGeoMipmapLevelErrors(const HeightMap& heightMap, int levelCount, float* outErrors);
+
+#endif // GEOMIPMAP_H
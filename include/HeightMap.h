@@ -3,10 +3,13 @@
 
 #include <vector>
 #include "PerlinNoise.h"
+#include "ScratchArena.h"
 
 class HeightMap {
 public:
-    HeightMap(int width, int depth);
+    // Heights are stored in one row-major array. With an arena the storage is scratch memory (chunk builds);
+    // the HeightMap must then not outlive the arena's current Scope.
+    HeightMap(int width, int depth, ScratchArena* arena = nullptr);
     ~HeightMap();
 
     void generateRandomHeights(float minHeight = 0.0f, float maxHeight = 10.0f);
@@ -23,12 +26,12 @@ public:
     void setHeight(int x, int z, float height); // <<< ADD THIS LINE (the declaration)
     int getWidth() const;
     int getDepth() const;
-    const std::vector<std::vector<float>>& getHeights() const;
+    const float* getData() const { return heights_.data(); } // width * depth, row-major (index z * width + x)
 
 private:
     int width_;
     int depth_;
-    std::vector<std::vector<float>> heights_;
+    ScratchVector<float> heights_;
 };
 
 #endif // HEIGHTMAP_H
\ No newline at end of file
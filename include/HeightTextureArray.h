@@ -0,0 +1,49 @@
+#ifndef HEIGHT_TEXTURE_ARRAY_H
+#define HEIGHT_TEXTURE_ARRAY_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glad/glad.h>
+
+// GL_R16 texture array holding one small heightfield per layer (used for texture-displaced chunks).
+// Heights are normalized to [0, 1] by the caller. A CPU copy of every layer is kept so the array can grow
+// (OpenGL 3.3 has no GPU-side copy between textures); at 35x35 texels that is about 2.4 KB per layer.
+// The array never grows past GL_MAX_ARRAY_TEXTURE_LAYERS (2048 on many GPUs); once that is full, allocate()
+// fails and the chunk asking for a layer is not drawn.
+class HeightTextureArray {
+public:
+    HeightTextureArray();
+    ~HeightTextureArray();
+
+    // Sets the layer size; must be called before the first allocate(). Drops any existing layers. The initial
+    // capacity is clamped to the GPU's layer limit, queried here.
+    void configure(int width, int depth, int initialCapacity);
+
+    int allocate(); // Returns a free layer, growing the array if needed; -1 if it is full (or cannot grow)
+    void upload(int layer, const std::vector<uint16_t>& texels); // width * depth texels, row-major
+    void release(int layer);
+    void bind(int textureUnit) const;
+
+    bool isConfigured() const { return width_ > 0; }
+    int getWidth() const { return width_; }
+    int getDepth() const { return depth_; }
+    int getCapacity() const { return capacity_; }
+    int getMaxLayers() const { return maxLayers_; }
+    int getLayersInUse() const { return layersInUse_; }
+    size_t getLayerBytes() const { return static_cast<size_t>(width_) * depth_ * sizeof(uint16_t); }
+
+private:
+    GLuint texture_;
+    int width_, depth_;
+    int capacity_;
+    int maxLayers_;  // GL_MAX_ARRAY_TEXTURE_LAYERS
+    int layersInUse_;
+    bool reportedFull_; // The "array is full" message is printed once per configure()
+    std::vector<int> freeLayers_;
+    std::vector<uint16_t> shadow_; // capacity_ layers, for re-uploading after a resize
+
+    bool reallocate(int newCapacity); // False (capacity unchanged) if the GL allocation failed
+};
+
+#endif // HEIGHT_TEXTURE_ARRAY_H
@@ -0,0 +1,103 @@
+#ifndef INDEX_OPTIMIZER_H
+#define INDEX_OPTIMIZER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+// How the GPU-side index buffer of a mesh is laid out.
+enum class IndexTopology {
+    Triangles,      // GL_TRIANGLES, 3 indices per triangle
+    TriangleStrip   // GL_TRIANGLE_STRIP, one strip per grid row segment, joined by primitive restart
+};
+
+// Order in which triangles are emitted, to make better use of the post-transform vertex cache.
+enum class VertexCacheOrdering {
+    None,   // Plain row order (what Mesh::generateFromHeightMap used to emit)
+    Grid,   // Grid walk in vertical stripes sized to the cache (grids only)
+    Tipsify // Tipsify (Sander et al. 2007), works for arbitrary triangle lists
+};
+
+struct IndexBuildOptions {
+    IndexTopology topology = IndexTopology::Triangles;
+    VertexCacheOrdering ordering = VertexCacheOrdering::Grid;
+    bool allow16BitIndices = true; // Use GL_UNSIGNED_SHORT when every index (and the restart index) fits
+    int cacheSize = 16;            // Post-transform cache entries assumed for ordering and ACMR
+    int clusterQuads = 0;          // Grids only: group indices into square clusters of this many quads a side (0 = off)
+};
+
+// Before/after numbers of the last index build, for reporting.
+struct IndexBuildStats {
+    float acmrBefore = 0.0f;      // Average cache miss ratio of plain row-order 32-bit triangles
+    float acmrAfter = 0.0f;       // ACMR of the index stream actually uploaded
+    size_t indexBytesBefore = 0;
+    size_t indexBytesAfter = 0;
+};
+
+// A contiguous run of indices covering one rectangle of grid quads (a cluster).
+// Strip clusters are separated by one restart index that no range includes.
+struct IndexRange {
+    uint32_t first = 0; // In indices, not bytes
+    uint32_t count = 0;
+    int quadX0 = 0, quadZ0 = 0, quadX1 = 0, quadZ1 = 0; // Quads covered, end exclusive
+};
+
+// Packed index data ready for glBufferData / glDrawElements.
+struct IndexBuffer {
+    GLenum mode = GL_TRIANGLES;
+    GLenum type = GL_UNSIGNED_INT;
+    bool usesPrimitiveRestart = false;
+    GLuint restartIndex = 0;
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+    std::vector<IndexRange> clusterRanges; // Filled when built with IndexBuildOptions::clusterQuads, in stream order
+
+    size_t count() const { return type == GL_UNSIGNED_SHORT ? indices16.size() : indices32.size(); }
+    size_t sizeInBytes() const { return type == GL_UNSIGNED_SHORT ? indices16.size() * sizeof(uint16_t) : indices32.size() * sizeof(uint32_t); }
+    const void* data() const { return type == GL_UNSIGNED_SHORT ? static_cast<const void*>(indices16.data()) : static_cast<const void*>(indices32.data()); }
+    void clear();
+};
+
+namespace IndexOptimizer {
+    const uint32_t RESTART_INDEX_32 = 0xFFFFFFFFu;
+    const uint32_t RESTART_INDEX_16 = 0xFFFFu;
+
+    // Number of quads per vertical stripe that keeps the previous row resident in a FIFO cache of 'cacheSize'.
+    int gridStripeWidth(int cacheSize);
+
+    // Triangle-list indices for a width x depth vertex grid (row-major vertices).
+    // stripeQuads <= 0 emits plain row order; otherwise the grid is walked in vertical stripes of that many quads.
+    void buildGridTriangles(int width, int depth, int stripeQuads, std::vector<unsigned int>& out);
+
+    // Triangle strips for the same grid, one strip per stripe row, separated by 'restartIndex'.
+    // Winding matches buildGridTriangles.
+    void buildGridStrips(int width, int depth, int stripeQuads, uint32_t restartIndex, std::vector<uint32_t>& out);
+
+    // Both of the above, one square cluster of clusterQuads x clusterQuads quads after another (row-major over
+    // clusters), each walked in stripes of stripeQuads. Consecutive strip clusters are joined by a restart index,
+    // so a run of neighboring ranges can be drawn as one. 'ranges' receives one entry per cluster.
+    void buildGridClusters(int width, int depth, int clusterQuads, int stripeQuads, bool strips, uint32_t restartIndex,
+                           std::vector<uint32_t>& out, std::vector<IndexRange>& ranges);
+
+    // Reorders an arbitrary triangle list for the post-transform cache (Tipsify). Winding is preserved.
+    void optimizeTipsify(const std::vector<unsigned int>& in, size_t vertexCount, int cacheSize, std::vector<unsigned int>& out);
+
+    // Simulates a FIFO post-transform cache over an index stream and returns the number of misses.
+    // Indices equal to 'restartIndex' are skipped when 'hasRestart' is set.
+    size_t simulateFifoMisses(const uint32_t* indices, size_t count, size_t vertexCount, int cacheSize,
+                              bool hasRestart = false, uint32_t restartIndex = 0);
+
+    // Average cache miss ratio (misses per triangle) of a triangle list.
+    float computeACMR(const std::vector<unsigned int>& triangles, size_t vertexCount, int cacheSize);
+
+    // Builds the GPU index buffer for a mesh. 'triangles' is the canonical triangle list; if gridWidth/gridDepth
+    // are positive the mesh is known to be a regular grid and grid-specific orderings and strips are available.
+    // Strips are only produced for grids; arbitrary meshes fall back to triangle lists.
+    // 'out' keeps its capacity, so reusing one IndexBuffer across builds avoids reallocating it.
+    void buildIndexBuffer(const std::vector<unsigned int>& triangles, size_t vertexCount,
+                          int gridWidth, int gridDepth, const IndexBuildOptions& options,
+                          IndexBuffer& out, IndexBuildStats* stats = nullptr);
+}
+
+#endif // INDEX_OPTIMIZER_H
@@ -5,9 +5,13 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp> 
 #include <limits> 
+#include <cstdint>
+#include "IndexOptimizer.h"
+#include "MeshBufferPool.h"
 
 // Forward declare HeightMap if its full definition isn't needed in this header
 class HeightMap; 
+class RtinMesher;
 
 struct Vertex {
     glm::vec3 Position;     
@@ -29,6 +33,64 @@ struct BoundingBox {
     }
 };
 
+// Many boxes as structure-of-arrays, one stream per bound and axis, for Frustum::cullBatch to test 8 or 16 at a
+// time. planeHint holds, per box, the frustum plane that rejected it last; cullBatch tries that plane first.
+struct AABBBatch {
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    std::vector<uint8_t> planeHint;
+
+    size_t size() const { return minX.size(); }
+    void clear() { // Keeps the capacity
+        minX.clear(); minY.clear(); minZ.clear();
+        maxX.clear(); maxY.clear(); maxZ.clear();
+        planeHint.clear();
+    }
+    void reserve(size_t count) {
+        minX.reserve(count); minY.reserve(count); minZ.reserve(count);
+        maxX.reserve(count); maxY.reserve(count); maxZ.reserve(count);
+        planeHint.reserve(count);
+    }
+    void push_back(const BoundingBox& box) {
+        minX.push_back(box.min.x); minY.push_back(box.min.y); minZ.push_back(box.min.z);
+        maxX.push_back(box.max.x); maxY.push_back(box.max.y); maxZ.push_back(box.max.z);
+        planeHint.push_back(0);
+    }
+    // Appends every box of 'other' moved by 'offset', with its plane hint (e.g. a mesh's clusters into a
+    // world-space batch covering many meshes)
+    void append(const AABBBatch& other, const glm::vec3& offset) {
+        size_t count = other.size();
+        for (size_t i = 0; i < count; ++i) {
+            minX.push_back(other.minX[i] + offset.x); minY.push_back(other.minY[i] + offset.y); minZ.push_back(other.minZ[i] + offset.z);
+            maxX.push_back(other.maxX[i] + offset.x); maxY.push_back(other.maxY[i] + offset.y); maxZ.push_back(other.maxZ[i] + offset.z);
+        }
+        if (other.planeHint.size() == count) {
+            planeHint.insert(planeHint.end(), other.planeHint.begin(), other.planeHint.end());
+        } else {
+            planeHint.resize(planeHint.size() + count, 0);
+        }
+    }
+};
+
+// A rectangle of grid quads drawn as one index range (see IndexBuildOptions::clusterQuads), with what is needed
+// to cull it: mesh-space bounds and a cone containing every triangle normal. The cluster faces away from an
+// eye at E when dot(C - E, coneAxis) >= coneCutoff * |C - E| + r for its bounding sphere (C, r).
+struct MeshCluster {
+    BoundingBox bounds;
+    glm::vec3 coneAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+    float coneCutoff = 1.0f; // Sine of the cone half-angle; 1 when the normals span a hemisphere or more (never backfacing)
+    uint32_t firstIndex = 0; // Into the uploaded index buffer
+    uint32_t indexCount = 0;
+    uint32_t triangleCount = 0;
+};
+
+// Where a mesh's data lives once it has been built. Counts and bounds are kept as metadata in every case.
+enum class MeshResidency {
+    GpuOnly,   // Upload, then free the CPU vectors (normal for drawn chunks)
+    CpuAndGpu, // Keep both (needed to re-upload or edit the mesh later)
+    CpuOnly    // Keep the CPU vectors but no GPU buffers (cached, not drawn)
+};
+
 class Mesh {
 public:
     std::vector<Vertex> vertices;
@@ -39,17 +101,85 @@ public:
     ~Mesh(); // <<< ADD THIS LINE (declare the destructor)
 
     void generateFromHeightMap(const HeightMap& heightMap, float horizontalScale, float verticalScale);
+    // Adaptive alternative: an RTIN triangulation that stays within maxError (world units, after verticalScale)
+    // of the full grid, keeping only the vertices it uses. Same placement and texture coordinates as the grid
+    // mesh; boundary edges stay at full resolution so neighbors match. The result is not a grid (no geomipmaps).
+    void generateAdaptiveFromHeightMap(const HeightMap& heightMap, float horizontalScale, float verticalScale,
+                                       const RtinMesher& mesher, float maxError);
+
+    // Controls how setupMesh() lays out the GPU index buffer (16-bit, strips, cache ordering).
+    // 'indices' always stays a plain GL_TRIANGLES list; only the uploaded copy is transformed.
+    void setIndexBuildOptions(const IndexBuildOptions& options) { indexOptions_ = options; }
+    const IndexBuildStats& getIndexBuildStats() const { return indexStats_; }
+
+    // CPU half of setupMesh(): builds the GPU index layout and the clusters. Touches no GL state, so a worker
+    // thread can run it and leave the main thread only the upload. setupMesh() runs it if nobody did.
+    void prepareGpuData();
     void setupMesh();
+
+    // Applies a residency policy, uploading first if the policy needs GPU data that is not there yet (before
+    // any data exists it is only recorded for setupMesh). Re-uploading needs the CPU copy, so a GpuOnly mesh
+    // cannot move to CpuOnly/CpuAndGpu (the chunk must be regenerated instead).
+    void setResidency(MeshResidency residency);
+    MeshResidency getResidency() const { return residency_; }
+    bool hasCpuData() const { return !vertices.empty() && !indices.empty(); }
+    bool hasGpuData() const { return buffers_.vao != 0; }
+    size_t getCpuBytes() const; // Capacity of the CPU vectors
+    size_t getBookkeepingBytes() const; // Capacity of the cluster, cluster bound and prepared index vectors
+    size_t getGpuBytes() const { return gpuBytes_; }
+    // Bytes setupMesh() would send to the GPU now (vertices plus the prepared index layout, if any)
+    size_t getPendingUploadBytes() const { return vertices.size() * sizeof(Vertex) + (gpuDataPrepared_ ? pendingIndices_.sizeInBytes() : 0); }
     void draw() const; 
+    // Draws several ranges of this mesh's own index buffer with one glMultiDrawElements call.
+    // Offsets are in bytes, as glMultiDrawElements takes them.
+    void drawRanges(const GLsizei* counts, const void* const* byteOffsets, GLsizei rangeCount) const;
+    // Clusters of the uploaded index buffer (empty unless the mesh is a grid built with clusterQuads)
+    const std::vector<MeshCluster>& getClusters() const { return clusters_; }
+    // The clusters' mesh-space bounds in the same order, for Frustum::cullBatch (filled when the mesh is uploaded)
+    AABBBatch& getClusterBounds() { return clusterBounds_; }
+    size_t getIndexSize() const { return indexType_ == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t); }
+    // Draws GL_TRIANGLES from an external index buffer (e.g. a shared LOD index set) over this mesh's vertices
+    void drawWithIndexBuffer(GLuint ebo, GLenum indexType, size_t byteOffset, GLsizei count) const;
+    // Hands the GL objects back to the MeshBufferPool (which deletes them when pooling is off)
     void clearGPUData(); 
+    // Drops all data (GPU buffers, CPU vectors, clusters, prepared index layout) so the mesh can be built again
+    // from scratch, e.g. by a recycled chunk. Storage goes back to the pools.
+    void clear();
 
+    // Metadata: still valid after the CPU vectors have been released
     size_t getVerticesCount() const;
     size_t getIndicesCount() const;
+    int getGridWidth() const { return gridWidth_; }  // 0 if the mesh is not a heightmap grid
+    int getGridDepth() const { return gridDepth_; }
 
 private:
-    unsigned int VAO, VBO, EBO;
+    MeshBufferSet buffers_; // VAO, VBO and EBO, from the MeshBufferPool
+
+    // Grid dimensions when the mesh came from a heightmap (0 for arbitrary meshes)
+    int gridWidth_, gridDepth_;
+    IndexBuildOptions indexOptions_;
+    IndexBuildStats indexStats_;
+
+    // What draw() needs to replay the uploaded index buffer
+    GLenum drawMode_, indexType_;
+    GLsizei drawCount_;
+    bool primitiveRestart_;
+    GLuint restartIndex_;
+
+    std::vector<MeshCluster> clusters_; // Describes the GPU index buffer, so it lives as long as the buffers
+    AABBBatch clusterBounds_;           // Kept with its capacity by clear(), so a recycled chunk refills it in place
+    IndexBuffer pendingIndices_;        // Built by prepareGpuData(), freed by the upload
+    bool gpuDataPrepared_;
+
+    MeshResidency residency_;
+    size_t vertexCount_, indexCount_; // Triangle-list counts from the last build
+    size_t gpuBytes_;                 // VBO + uploaded index buffer (pooled storage may be larger)
+
+    void releaseCpuData();
+
     void calculateNormals();
     void calculateBoundingBox(); 
+    void buildClusters(const std::vector<IndexRange>& ranges); // Needs the CPU vertices
 };
 
 #endif // MESH_H
\ No newline at end of file
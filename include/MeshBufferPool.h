@@ -0,0 +1,87 @@
+#ifndef MESH_BUFFER_POOL_H
+#define MESH_BUFFER_POOL_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// One mesh's GL objects: a VAO with its vertex and element buffers, and the storage size of each buffer
+struct MeshBufferSet {
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    size_t vertexCapacity = 0; // Bytes
+    size_t indexCapacity = 0;
+};
+
+// Driver work done through the pool since the last resetStats()
+struct MeshBufferPoolStats {
+    uint64_t setsCreated = 0;       // glGenVertexArrays + 2 glGenBuffers each
+    uint64_t setsDeleted = 0;
+    uint64_t setsReused = 0;        // acquire() answered from the idle sets
+    uint64_t storageAllocations = 0; // glBufferData calls (new or regrown storage)
+    uint64_t storageUpdates = 0;     // glBufferSubData calls into existing storage
+    size_t idleSets = 0;
+    size_t idleBytes = 0;
+};
+
+// Recycles mesh GL objects so streaming chunks in and out does not create and delete buffers all the time.
+// A released set waits reuseDelayFrames frames (see advanceFrame) before it is handed out again, so refilling
+// it never has to wait for the GPU to finish the last draws from it. acquire() picks the smallest idle set
+// that fits; storage is rounded up to whole pages so equal-sized meshes (every grid chunk) share sets, and
+// fill() then only needs glBufferSubData. Idle sets beyond maxIdleBytes are deleted, oldest first.
+// Disabled, it behaves like plain glGen/glDelete with exactly sized storage. GL thread only.
+class MeshBufferPool {
+public:
+    static MeshBufferPool& instance();
+
+    MeshBufferPool();
+    // Leaks the idle sets on purpose: the GL context is gone by the time statics are destroyed
+    ~MeshBufferPool() = default;
+    MeshBufferPool(const MeshBufferPool&) = delete;
+    MeshBufferPool& operator=(const MeshBufferPool&) = delete;
+
+    void setEnabled(bool enabled);   // Disabling deletes the idle sets
+    bool isEnabled() const { return enabled_; }
+    void setMaxIdleBytes(size_t maxIdleBytes);
+    void setReuseDelayFrames(int frames) { reuseDelayFrames_ = frames < 0 ? 0 : frames; }
+    // Call once per frame; released sets become reusable reuseDelayFrames calls later
+    void advanceFrame() { frame_++; }
+
+    // A set whose storage can take the given sizes (the VAO is not bound and its attributes may be unset)
+    MeshBufferSet acquire(size_t vertexBytes, size_t indexBytes);
+    // Uploads into the set's buffers, growing their storage if needed. Binds the VAO and leaves it bound, with
+    // the vertex buffer bound to GL_ARRAY_BUFFER, so the caller can set the attributes next.
+    void fill(MeshBufferSet& set, const void* vertices, size_t vertexBytes, const void* indices, size_t indexBytes);
+    // Takes the set back (or deletes it when disabled) and clears 'set'
+    void release(MeshBufferSet& set);
+    // Creates idle sets sized like the largest one handed out so far, ready for immediate use; a no-op before
+    // the first acquire(). Moves the creation cost of a streaming session's first moves to a loading frame.
+    void reserve(size_t count);
+    void clear(); // Deletes every idle set
+
+    const MeshBufferPoolStats& getStats() const { return stats_; }
+    void resetStats();
+
+private:
+    struct IdleSet {
+        MeshBufferSet set;
+        uint64_t readyFrame; // First frame it may be handed out again
+    };
+    std::vector<IdleSet> idle_; // Oldest release first
+    bool enabled_;
+    size_t maxIdleBytes_;
+    int reuseDelayFrames_;
+    uint64_t frame_;
+    size_t largestVertexCapacity_;
+    size_t largestIndexCapacity_;
+    MeshBufferPoolStats stats_;
+
+    size_t roundCapacity(size_t bytes) const;
+    MeshBufferSet createSet();
+    void deleteSet(MeshBufferSet& set);
+    void trimIdle(); // Deletes the oldest idle sets beyond maxIdleBytes_
+};
+
+#endif // MESH_BUFFER_POOL_H
@@ -18,9 +18,14 @@ public:
     // Fractional Brownian Motion (fBm) for more detailed noise
     double octaveNoise(double x, double y, int octaves, double persistence) const;
 
+    unsigned int getSeed() const { return seed_; }
+    // The shuffled table the seed produced (512 entries). Caches key on this rather than the seed, since
+    // std::shuffle may order differently with another standard library.
+    const std::vector<int>& getPermutation() const { return p; }
 
 private:
     std::vector<int> p; // Permutation vector
+    unsigned int seed_;
 
     // Helper functions
     double fade(double t) const;
@@ -0,0 +1,36 @@
+#ifndef RTIN_MESHER_H
+#define RTIN_MESHER_H
+
+#include <vector>
+#include "ScratchArena.h"
+
+class HeightMap;
+
+// Right-triangulated irregular network (RTIN) mesher, after Mapbox's "Martini".
+// A (2^n + 1)^2 grid is treated as a binary tree of right triangles, each split along its hypotenuse.
+// Per-vertex errors are precomputed once per heightmap; extracting a mesh for any tolerance then only
+// walks the tree, splitting a triangle while the error at its hypotenuse midpoint exceeds the tolerance.
+// Boundary vertices are always kept, so adjacent chunks meet on identical full-resolution edges.
+class RtinMesher {
+public:
+    explicit RtinMesher(int gridSize); // Vertices per side, must be 2^n + 1
+
+    bool isValid() const { return gridSize_ > 0; }
+    int getGridSize() const { return gridSize_; }
+
+    // Error at each grid vertex (row-major, gridSize^2): the largest vertical distance, in world units, between
+    // the full grid and either triangle split at that vertex, or any of their descendants. Extracting with
+    // maxError therefore bounds the error of the whole mesh, not just at the split points.
+    void computeErrors(const HeightMap& heightMap, float verticalScale, ScratchVector<float>& outErrors) const;
+
+    // Triangle list (indices into the full row-major grid) meeting maxError. Winding matches
+    // Mesh::generateFromHeightMap (counter-clockwise seen from +Y). The traversal stack lives in the thread's ScratchArena.
+    void extractTriangles(const ScratchVector<float>& errors, float maxError, ScratchVector<unsigned int>& outTriangles) const;
+
+private:
+    int gridSize_;
+    std::vector<unsigned short> triangleCoords_; // ax, ay, bx, by per triangle of the implicit tree
+    int parentTriangleCount_;                    // Triangles that still have children
+};
+
+#endif // RTIN_MESHER_H
@@ -0,0 +1,141 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+// Bump allocator for per-job scratch memory (chunk heights, RTIN errors, index optimizer temporaries).
+// Allocating is a pointer increment and freeing is a no-op; everything is rewound when the job's Scope ends.
+// Blocks are kept across jobs, and when a job overflowed into extra blocks the next reset merges them into one
+// block of the combined size, so once the arena has warmed up a job of the same shape never touches the heap.
+// Each thread has its own arena (forThread()), so chunk generation on several threads never contends in malloc.
+class ScratchArena {
+public:
+    explicit ScratchArena(size_t initialBytes = 256 * 1024);
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment);
+    // Only gives memory back if it is the most recent allocation (lets a vector that grows in place reuse it)
+    void deallocate(void* pointer, size_t bytes);
+
+    // Rewinds the arena to where it was when the scope opened. Scopes nest; allocations must only be made
+    // inside one, and nothing allocated inside may be used after it closes. A vector from an outer scope must
+    // not grow while an inner scope is open (reserve it first), or its new storage would be rewound too.
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ScratchArena& arena() const { return arena_; }
+
+    private:
+        ScratchArena& arena_;
+        size_t block_;
+        size_t offset_;
+    };
+
+    size_t getBytesInUse() const;
+    size_t getHighWaterBytes() const { return highWaterBytes_; }
+    size_t getCapacity() const;
+    uint64_t getBlockAllocations() const { return blockAllocations_; } // Heap allocations made by the arena itself
+
+    // The calling thread's arena, created on first use
+    static ScratchArena& forThread();
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+    std::vector<Block> blocks_;
+    size_t currentBlock_;
+    size_t offset_;             // Into blocks_[currentBlock_]
+    size_t bytesBeforeCurrent_; // Sizes of the blocks before the current one
+    size_t highWaterBytes_;
+    uint64_t blockAllocations_;
+
+    void rewind(size_t block, size_t offset);
+    void moveToNextBlock(size_t bytes, size_t alignment);
+};
+
+// STL allocator over a ScratchArena. A null arena allocates from the heap, so a container type can be
+// arena-backed in hot paths and still be used normally elsewhere.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena_(nullptr) {}
+    explicit ArenaAllocator(ScratchArena* arena) noexcept : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.getArena()) {}
+
+    T* allocate(size_t count) {
+        if (!arena_) return static_cast<T*>(::operator new(count * sizeof(T)));
+        return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* pointer, size_t count) noexcept {
+        if (!arena_) ::operator delete(pointer);
+        else arena_->deallocate(pointer, count * sizeof(T));
+    }
+
+    ScratchArena* getArena() const noexcept { return arena_; }
+
+private:
+    ScratchArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept { return a.getArena() == b.getArena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept { return a.getArena() != b.getArena(); }
+
+// Vector for scratch data: pass ArenaAllocator<T>(&arena) to put it in an arena, or nothing for the heap
+template <typename T>
+using ScratchVector = std::vector<T, ArenaAllocator<T>>;
+
+// Thread-safe free list of std::vectors, for buffers that outlive one job (a chunk's CPU mesh lives until it is
+// uploaded, possibly on another thread). A recycled vector keeps its capacity, so the next user fills it
+// without allocating. At most maxPooled vectors are kept; any more are freed.
+template <typename T>
+class VectorPool {
+public:
+    explicit VectorPool(size_t maxPooled) : maxPooled_(maxPooled) { pooled_.reserve(maxPooled); }
+
+    // Gives 'out' the storage of a pooled vector if it has none of its own
+    void acquire(std::vector<T>& out) {
+        if (out.capacity() > 0) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pooled_.empty()) {
+            out.swap(pooled_.back());
+            pooled_.pop_back();
+        }
+    }
+
+    // Takes the storage of 'buffer', leaving it empty with no capacity
+    void recycle(std::vector<T>& buffer) {
+        if (buffer.capacity() == 0) return;
+        buffer.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pooled_.size() < maxPooled_) {
+                pooled_.push_back(std::move(buffer));
+                buffer = std::vector<T>();
+                return;
+            }
+        }
+        std::vector<T>().swap(buffer);
+    }
+
+private:
+    size_t maxPooled_;
+    std::vector<std::vector<T>> pooled_;
+    std::mutex mutex_;
+};
+
+#endif // SCRATCH_ARENA_H
@@ -2,6 +2,10 @@
 #define SHADER_H
 
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
 #include <glm/glm.hpp> // For glm::mat4
 // Make sure these are present if your Shader.cpp uses them and they aren't pulled by Shader.h itself
 #include <fstream> 
@@ -9,7 +13,19 @@
 #include <iostream>
 #include <glad/glad.h>
 
+template <typename T> class UniformHandle;
 
+// Uniform uploads of one Shader since the last resetUniformStats()
+struct ShaderUniformStats {
+    uint64_t uploads = 0;          // glUniform* calls made
+    uint64_t redundantSkipped = 0; // Sets that passed the value the uniform already held
+    uint64_t unknownNames = 0;     // Sets by name of a uniform the program does not have (or optimized out)
+};
+
+// A program with its active uniforms reflected at link time into a location table, so setting a uniform never
+// calls glGetUniformLocation. The by-name setters look the name up in that table; UniformHandle skips even that.
+// Every uniform remembers the last value uploaded through this Shader and identical values are not sent again.
+// That relies on all uploads to the program going through its Shader, which they do in this project.
 class Shader {
 public:
     // Constructor generates the shader on the fly
@@ -31,12 +47,97 @@ public:
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
     void setVec3(const std::string &name, const glm::vec3 &value) const; // Added
     void setVec3(const std::string &name, float x, float y, float z) const; // Overload
+    void setVec2(const std::string &name, const glm::vec2 &value) const;
+    void setVec4(const std::string &name, const glm::vec4 &value) const;
+
+    // Slot of an active uniform in the location table; -1 if the program has no such uniform. Array elements
+    // are listed as "name[i]", element 0 also as "name".
+    int findUniform(const std::string& name) const;
+    // A handle to set the named uniform without any lookup. Logs a mismatch between T and the uniform's GLSL
+    // type; an inactive uniform gives a handle whose set() does nothing.
+    template <typename T>
+    UniformHandle<T> uniform(const std::string& name) const;
+    // Upload to the uniform in a slot from findUniform, unless it already holds the value. The program must be
+    // in use, as for the by-name setters.
+    void setUniform(int slot, bool value) const;
+    void setUniform(int slot, int value) const;
+    void setUniform(int slot, float value) const;
+    void setUniform(int slot, const glm::vec2& value) const;
+    void setUniform(int slot, const glm::vec3& value) const;
+    void setUniform(int slot, const glm::vec4& value) const;
+    void setUniform(int slot, const glm::mat4& value) const;
+
+    // Points the named uniform block at a binding point, where a UniformBuffer supplies its contents. False if the
+    // program has no such block; a block whose linked size differs from expectedSize (if given) is logged.
+    bool bindUniformBlock(const std::string& blockName, GLuint bindingPoint, size_t expectedSize = 0) const;
+
+    const ShaderUniformStats& getUniformStats() const { return uniformStats_; }
+    void resetUniformStats() { uniformStats_ = ShaderUniformStats(); }
+    size_t getActiveUniformCount() const { return uniforms_.size(); }
     
     unsigned int getID() const; // <<< ADD OR ENSURE THIS LINE IS PRESENT AND PUBLIC
 
 private:
+    // One active uniform (or array element) and the last value uploaded to it
+    struct UniformSlot {
+        GLint location = -1;
+        GLenum type = 0;
+        bool hasValue = false;
+        unsigned char value[sizeof(float) * 16]; // Raw bytes of the last value, up to a mat4
+    };
+
     unsigned int ID; // ID should be private if using a getter
+    // Mutable: the setters are const, and the cached values are not part of the program's observable state
+    mutable std::vector<UniformSlot> uniforms_;
+    std::unordered_map<std::string, int> uniformSlots_;
+    mutable ShaderUniformStats uniformStats_;
+
     void checkCompileErrors(unsigned int shader, std::string type);
+    // Fills the location table from the linked program
+    void reflectUniforms();
+    // Records 'bytes' as the slot's value; false (and counted as redundant) if it already held exactly that
+    bool storeValue(int slot, const void* value, size_t bytes) const;
+    // Whether the GLSL type can be set with values of type 'expected' (samplers and bools take ints)
+    static bool typeAccepts(GLenum glslType, GLenum expected);
+    bool checkUniformType(int slot, GLenum expected, const std::string& name) const;
+
+    template <typename T> struct UniformType;
 };
 
+// GL type of the values each setUniform overload uploads, for the check in Shader::uniform
+template <> struct Shader::UniformType<bool> { static const GLenum value = GL_BOOL; };
+template <> struct Shader::UniformType<int> { static const GLenum value = GL_INT; };
+template <> struct Shader::UniformType<float> { static const GLenum value = GL_FLOAT; };
+template <> struct Shader::UniformType<glm::vec2> { static const GLenum value = GL_FLOAT_VEC2; };
+template <> struct Shader::UniformType<glm::vec3> { static const GLenum value = GL_FLOAT_VEC3; };
+template <> struct Shader::UniformType<glm::vec4> { static const GLenum value = GL_FLOAT_VEC4; };
+template <> struct Shader::UniformType<glm::mat4> { static const GLenum value = GL_FLOAT_MAT4; };
+
+// A uniform of one Shader resolved to its table slot. Cheap to copy; it must not outlive the Shader. Setting it
+// costs no string handling and, when the value is unchanged, no GL call.
+template <typename T>
+class UniformHandle {
+public:
+    UniformHandle() : shader_(nullptr), slot_(-1) {}
+    UniformHandle(const Shader* shader, int slot) : shader_(shader), slot_(slot) {}
+
+    bool isActive() const { return shader_ && slot_ >= 0; }
+    void set(const T& value) const {
+        if (isActive()) shader_->setUniform(slot_, value);
+    }
+
+private:
+    const Shader* shader_;
+    int slot_;
+};
+
+template <typename T>
+UniformHandle<T> Shader::uniform(const std::string& name) const {
+    int slot = findUniform(name);
+    if (slot < 0 || !checkUniformType(slot, UniformType<T>::value, name)) {
+        return UniformHandle<T>();
+    }
+    return UniformHandle<T>(this, slot);
+}
+
 #endif // SHADER_H
\ No newline at end of file
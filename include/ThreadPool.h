@@ -0,0 +1,40 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+// Fixed set of worker threads running jobs in submission order. Used for chunk generation, so the render
+// thread only uploads finished chunks. Jobs must not touch GL: there is no context on the workers.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount);
+    // Jobs that have not started are dropped; running ones finish before the threads are joined
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    int getThreadCount() const { return static_cast<int>(threads_.size()); }
+    size_t getQueuedJobs() const;
+
+    // Threads worth using for background work: all hardware threads but the render thread's, at least one
+    static int defaultThreadCount();
+
+private:
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> jobs_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+
+    void workerLoop();
+};
+
+#endif // THREAD_POOL_H
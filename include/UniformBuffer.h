@@ -0,0 +1,41 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// GL uniform buffer holding one std140 block, attached to a fixed binding point. Every program whose block was
+// pointed at the same binding point (Shader::bindUniformBlock) reads it, so data shared by several shaders is
+// uploaded once rather than set on each program. A copy of the last contents is kept and identical updates
+// upload nothing.
+class UniformBuffer {
+public:
+    UniformBuffer();
+    ~UniformBuffer();
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // Allocates 'size' bytes and attaches the buffer to 'bindingPoint' (needs a GL context)
+    void create(GLuint bindingPoint, size_t size);
+    // Replaces the whole block; false if it already held exactly these bytes and nothing was uploaded
+    bool update(const void* data, size_t size);
+    template <typename Block>
+    bool update(const Block& block) { return update(&block, sizeof(Block)); }
+    // Attaches the buffer to its binding point again
+    void bind() const;
+
+    bool isCreated() const { return buffer_ != 0; }
+    GLuint getBindingPoint() const { return bindingPoint_; }
+    uint64_t getUploadCount() const { return uploads_; }
+
+private:
+    GLuint buffer_;
+    GLuint bindingPoint_;
+    std::vector<unsigned char> shadow_; // Contents last uploaded
+    bool hasContents_;
+    uint64_t uploads_;
+};
+
+#endif // UNIFORM_BUFFER_H
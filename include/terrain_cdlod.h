@@ -0,0 +1,101 @@
+#ifndef TERRAIN_CDLOD_H
+#define TERRAIN_CDLOD_H
+
+#include "PerlinNoise.h"
+#include "Frustum.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+class Shader;
+
+// Continuous distance-dependent LOD (Strugar, "Continuous Distance-Dependent Level of Detail for Rendering
+// Heightmaps"). The world is covered by a quadtree whose roots are tiled around the camera; every frame a
+// set of nodes is selected by distance, each drawn with one shared grid patch. Heights come from small
+// per-node tiles in a texture array, and the vertex shader morphs each level into the next coarser one
+// towards the end of its range, so LOD transitions do not pop.
+struct CdlodSettings {
+    float viewDistance = 16000.0f;  // Nothing is drawn beyond this distance
+    float leafNodeSize = 64.0f;     // World size of the finest nodes (matches a terrain chunk)
+    float leafRange = 160.0f;       // LOD 0 range; every coarser level doubles it
+    float morphStartRatio = 0.66f;  // Fraction of a level's range band after which morphing starts
+    int patchResolution = 33;       // Vertices per side of the shared grid patch (2^n + 1)
+    int tileCapacity = 1024;        // Height tiles resident in the texture array
+    int maxTileBuildsPerFrame = 16; // Tiles generated from noise per frame; missing tiles borrow an ancestor's
+};
+
+struct CdlodStats {
+    double selectionMs = 0.0;  // CPU time of the last quadtree selection
+    size_t nodesSelected = 0;
+    size_t trianglesDrawn = 0;
+    int tilesBuilt = 0;        // Tiles generated during the last render
+    int tilesResident = 0;
+};
+
+class CdlodTerrain {
+public:
+    CdlodTerrain(const PerlinNoise* noiseGenerator, const CdlodSettings& settings = CdlodSettings());
+    ~CdlodTerrain();
+
+    // Quadtree selection for this frame (CPU only), culled against the frustum
+    void select(const glm::vec3& cameraPosition, const Frustum& frustum);
+    // Draws the last selection. The shader is expected to be the CDLOD shader, already in use,
+    // with view/projection and lighting uniforms set; patches are placed relative to
+    // renderOriginFor(cameraPosition), like the view matrix.
+    void render(Shader& shader, const glm::dvec3& cameraPosition);
+
+    const CdlodSettings& getSettings() const { return settings_; }
+    const CdlodStats& getStats() const { return stats_; }
+    int getLevelCount() const { return levelCount_; }
+
+private:
+    struct SelectedNode {
+        float x, z;       // Node origin (min corner)
+        float size;
+        int level;
+        int quadrantMask; // Quadrants drawn at this node's level (15 = whole node)
+    };
+
+    struct Tile {
+        int layer = -1;
+        float minHeight = 0.0f;
+        float maxHeight = 0.0f;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    const PerlinNoise* noise_;
+    CdlodSettings settings_;
+    CdlodStats stats_;
+    int levelCount_;
+    float rootNodeSize_;
+    std::vector<float> levelRanges_;    // Visibility range per level
+    std::vector<glm::vec2> morphRanges_; // Morph start/end distance per level
+
+    std::vector<SelectedNode> selection_;
+    glm::vec3 selectionCamera_;
+    const Frustum* selectionFrustum_;
+
+    // GPU resources, created on first render
+    bool gpuReady_;
+    GLuint patchVAO_, patchVBO_, patchEBO_;
+    GLuint tileTexture_;
+    int tileTexels_;                     // patchResolution + 2 (one border texel each side for normals)
+    GLsizei quadrantIndexCount_;
+    std::unordered_map<uint64_t, Tile> tiles_;
+    std::vector<int> freeLayers_;
+    std::vector<float> tileScratch_;
+    uint64_t frameCounter_;
+
+    bool selectNode(float x, float z, int level);
+    bool nodeInRange(float x, float z, float size, int level, float range) const;
+    void nodeHeightBounds(float x, float z, int level, float& minHeight, float& maxHeight) const;
+
+    void setupGPU();
+    static uint64_t tileKey(int level, float x, float z, float size);
+    const Tile* findTile(uint64_t key) const;
+    Tile* buildTile(int level, float x, float z, float size); // Generates and uploads a tile, evicting LRU if full
+};
+
+#endif // TERRAIN_CDLOD_H
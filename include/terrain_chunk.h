@@ -5,20 +5,62 @@
 #include "Mesh.h"          // We will need this later
 #include "PerlinNoise.h"   // Add this
 #include "HeightMap.h"     // Add this
+#include "Shader.h"        // For UniformHandle
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp> // For glm::translate
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <atomic>
 #include <iostream>        // For debugging output
 
-// Forward declaration of Shader, if Chunk's render method will take it
-class Shader; 
+class GeoMipmapIndexSet;
+class HeightTextureArray;
+
+// The chunk shader's per-draw uniforms, resolved once per frame (see TerrainManager::renderActiveChunks), so
+// drawing a chunk sets them without any name lookup
+struct ChunkUniforms {
+    UniformHandle<glm::mat4> model;
+    UniformHandle<float> heightLayer;         // chunkHeightLayer: the displaced chunk's layer in the height array
+    UniformHandle<bool> displaceFromTexture;
+
+    ChunkUniforms() = default;
+    explicit ChunkUniforms(const Shader& shader)
+        : model(shader.uniform<glm::mat4>("model")), heightLayer(shader.uniform<float>("chunkHeightLayer")),
+          displaceFromTexture(shader.uniform<bool>("displaceFromTexture")) {}
+};
+
+// What Chunk::renderClusters skipped and drew, summed over the chunks of a frame
+struct ClusterCullStats {
+    size_t clustersTested = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;  // Every triangle normal faces away from the viewer
+    size_t trianglesDrawn = 0;
+};
+
+// How Chunk::load turns its heightmap into a mesh.
+enum class ChunkMeshBuilder {
+    Grid, // Full-resolution grid (Mesh::generateFromHeightMap), supports geomipmapping
+    Rtin, // Error-driven adaptive triangulation (Mesh::generateAdaptiveFromHeightMap)
+    Displaced // No chunk mesh: heights go to a texture array layer and a shared flat grid is displaced in basic.vert
+};
+
+// Where a chunk is in TerrainManager's streaming pipeline.
+enum class ChunkState {
+    Queued,        // Waiting for a worker thread
+    Generating,    // Heights and CPU mesh being built on a worker (Chunk::prepare)
+    ReadyToUpload, // CPU data done, waiting for the main thread (Chunk::uploadToGpu)
+    Resident       // Uploaded and drawable
+};
 
 class Chunk {
 public:
-    const Vec2i gridCoords; // The (X, Z) coordinate of this chunk in the world grid
+    Vec2i gridCoords; // The (X, Z) coordinate of this chunk in the world grid; only reset() changes it
     
     // World position of the chunk's origin (e.g., bottom-left corner)
-    // This will be calculated based on gridCoords and CHUNK_WORLD_SIZE
-    glm::vec3 worldPosition; 
+    // This will be calculated based on gridCoords and CHUNK_WORLD_SIZE. Double, so it stays exact however far
+    // the chunk is from the world origin (a float has a 1-unit step beyond 1.6e7).
+    glm::dvec3 worldPosition; 
 
     // Dimensions of the chunk in world units
     // These will likely be constants defined in TerrainManager or globally
@@ -41,6 +83,17 @@ public:
     static float MESH_VERTICAL_SCALE;    // Vertical scaling factor for the mesh
     static float MESH_HORIZONTAL_SCALE;  // Calculated from world size and resolution
 
+    // GPU index layout used for every chunk mesh (16-bit indices, strips, vertex-cache ordering, clusters)
+    static IndexBuildOptions MESH_INDEX_OPTIONS;
+
+    // Mesh construction; RTIN_MAX_ERROR is the allowed vertical error in world units
+    static ChunkMeshBuilder MESH_BUILDER;
+    static float RTIN_MAX_ERROR;
+
+    // Where a freshly loaded chunk keeps its mesh. GpuOnly drops the CPU vertices/indices after upload;
+    // counts and bounds survive as metadata, so culling, LOD and stats work the same either way.
+    static MeshResidency MESH_RESIDENCY;
+
 private:
     // Mesh object for this chunk's terrain.
     // Will be default-constructed initially, then generated in load().
@@ -48,10 +101,31 @@ private:
     bool isLoaded_;
     bool isActive_; // Could be used to mark for rendering vs. just loaded
 
-    glm::mat4 modelMatrix_; // To position this chunk in the world
+    // Vertical error (world units) of drawing this chunk at each geomipmap level, level 0 is exact.
+    // Inline so loading a chunk needs no heap allocation for it (16 levels covers 32769^2 grids).
+    static const int MAX_LOD_LEVELS = 16;
+    float lodErrors_[MAX_LOD_LEVELS];
+    int lodLevelCount_;
+    double meshBuildMs_; // CPU time of the last mesh build (heights excluded)
+    uint64_t loadAllocations_; // Heap allocations during the last load() (needs TERRAIN_COUNT_ALLOCATIONS)
+
+    // Displaced chunks: normalized heights with a one-texel border (for normals), kept until uploaded
+    std::vector<uint16_t> displacementTexels_;
+    int heightLayer_;           // Layer in the shared HeightTextureArray, -1 if none
+    BoundingBox localBounds_;   // Mesh-space bounds (centred on the chunk), for both mesh and displaced chunks
+    BoundingBox worldBounds_;   // localBounds_ moved to the chunk's place, set once the chunk is prepared
 
     const PerlinNoise* perlinGenerator_; // Pointer to a PerlinNoise instance
 
+    // Bordered heights this chunk is built from or keeps after prepare() (see setKeepHeights), so an evicted
+    // chunk can be rebuilt without the noise or the disk cache
+    std::vector<float> heights_;
+    bool keepHeights_;
+
+    // Written by the worker building the chunk and read by the main thread
+    std::atomic<ChunkState> state_;
+    std::atomic<bool> cancelled_;
+
 public:
     // Constructor now takes a PerlinNoise generator
     Chunk(Vec2i pGridCoords, const PerlinNoise* pNoiseGenerator);
@@ -59,16 +133,105 @@ public:
 
     // Core methods (to be implemented in later steps)
     void load();    // Generate or load heightmap, create mesh, setup GPU buffers
-    void unload();  // Free GPU buffers and potentially other mesh data
+    // Same, from heights produced by generateHeights() (possibly read back from the ChunkCache)
+    void load(const float* borderedHeights);
+    // The two halves of load(). prepare() builds the heightmap, CPU mesh, LOD errors and GPU index layout;
+    // it reads only the noise and static parameters and touches no GL state, so it may run on a worker thread.
+    // uploadToGpu() then creates the buffers on the thread that owns the GL context.
+    void prepare(const float* borderedHeights);
+    void uploadToGpu();
+    // Samples the chunk's heights (before MESH_VERTICAL_SCALE) with a one-vertex border on every side,
+    // row-major, getBorderedHeightCount() floats. Only reads the noise and static parameters.
+    bool generateHeights(float* outBorderedHeights) const;
+    static size_t getBorderedHeightCount();
+    // prepare() copies its input heights into the chunk when set (call before the build starts)
+    void setKeepHeights(bool keep) { keepHeights_ = keep; }
+    // Heights to build from instead of the cache or the noise, e.g. from TerrainManager's evicted chunk cache
+    void setHeights(std::vector<float> borderedHeights) { heights_ = std::move(borderedHeights); }
+    bool hasHeights() const { return !heights_.empty(); }
+    const float* getHeights() const { return heights_.data(); }
+    std::vector<float> takeHeights() { return std::move(heights_); }
+    void unload();  // Frees the mesh (GPU buffers back to the MeshBufferPool) and pending displacement texels
+    // Turns an unused chunk (not queued, not being built, height layer released) into a fresh one at
+    // newGridCoords, so TerrainManager can recycle chunk objects instead of allocating new ones
+    void reset(Vec2i newGridCoords);
     
-    // Render this chunk (implementation in a later step)
-    void render(Shader& shader); 
+    // Render this chunk. Every render call draws relative to renderOrigin (Camera::GetRenderOrigin), which
+    // must be the origin the view matrix was built for.
+    void render(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin);
+    // Render this chunk at full resolution, drawing the clusters in visibleClusters (increasing indices, the ones
+    // that passed the frustum test of TerrainManager's frame-wide batch) unless they face away from viewPosition;
+    // they go out in one glMultiDrawElements call. Without clusters it draws the whole mesh.
+    void renderClusters(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin, const uint32_t* visibleClusters, size_t visibleCount,
+                        const glm::vec3& viewPosition, ClusterCullStats& stats);
+    bool hasClusters() const { return !mesh_.getClusters().empty(); }
+    size_t getClusterCount() const { return mesh_.getClusters().size(); }
+    // Appends the clusters' world-space bounds to a batch of many chunks, each with the plane that rejected it last
+    void appendClusterBounds(AABBBatch& batch);
+    // Takes back the plane hints the batch was culled with, for this chunk's clusters appended at 'first'
+    void storeClusterHints(const AABBBatch& batch, size_t first);
+    // Render this chunk at a geomipmap level using the shared index set; stitchMask is a GeoMipmapEdge combination
+    void render(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin, const GeoMipmapIndexSet& lodIndexSet, int level, int stitchMask);
 
     bool isLoaded() const { return isLoaded_; }
+    ChunkState getState() const { return state_.load(); }
+    void setState(ChunkState state) { state_.store(state); }
+    // Asks a queued build to skip this chunk (a build already running finishes first)
+    void cancel() { cancelled_.store(true); }
+    bool isCancelled() const { return cancelled_.load(); }
+
+    // Residency of the chunk mesh (displaced chunks have no mesh and are always GPU-only once uploaded).
+    // CpuOnly keeps a cached chunk's mesh without GPU buffers; it is not drawn until moved back.
+    void setResidency(MeshResidency residency);
+    MeshResidency getResidency() const;
+    bool isGpuResident() const { return usesDisplacement() ? heightLayer_ >= 0 : mesh_.hasGpuData(); }
+    size_t getCpuBytes() const; // Mesh vectors, pending displacement texels and kept heights
+    size_t getGpuBytes() const; // Mesh buffers; a displaced chunk's layer is accounted by its HeightTextureArray
+    size_t getObjectBytes() const; // The Chunk object itself and its mesh's bookkeeping vectors
+    size_t getUploadBytes() const; // What uploadToGpu() plus uploadDisplacement() will transfer, after prepare()
+
+    // Texture-displaced chunks (MESH_BUILDER == Displaced at load time)
+    bool usesDisplacement() const { return heightLayer_ >= 0 || !displacementTexels_.empty(); }
+    void uploadDisplacement(HeightTextureArray& heightTextures);  // Takes a layer and frees the CPU copy
+    void releaseDisplacement(HeightTextureArray& heightTextures);
+    // Draws the shared flat grid displaced by this chunk's layer; lodIndexSet may be null for full resolution
+    void renderDisplaced(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin, const Mesh& sharedGrid, const GeoMipmapIndexSet* lodIndexSet,
+                         int level, int stitchMask);
+    // Height range the normalized displacement texels map to (world units)
+    static float displacementMinHeight() { return TERRAIN_MIN_HEIGHT * MESH_VERTICAL_SCALE; }
+    static float displacementMaxHeight() { return TERRAIN_MAX_HEIGHT * MESH_VERTICAL_SCALE; }
+
+    // True if the chunk mesh matches the grid layout of the shared LOD index set
+    bool supportsLod(const GeoMipmapIndexSet& lodIndexSet) const;
+    float getLodError(int level) const;
+    size_t getTriangleCount() const;
+    double getMeshBuildMs() const { return meshBuildMs_; }
+    const IndexBuildStats& getIndexBuildStats() const { return mesh_.getIndexBuildStats(); }
+    uint64_t getLoadAllocations() const { return loadAllocations_; }
+    // Chunk bounds in world space (the mesh is centred on the chunk, see getModelMatrix); empty before prepare().
+    // Float: at 1e7 units from the origin they are off by at most a unit, which only loosens culling slightly.
+    const BoundingBox& getWorldBounds() const { return worldBounds_; }
+    glm::vec3 getWorldBoundsMin() const { return worldBounds_.min; }
+    glm::vec3 getWorldBoundsMax() const { return worldBounds_.max; }
     // const Mesh& getMesh() const { return mesh_; } // If needed for external access
 
-    // Method to calculate and set the model matrix
-    void calculateModelMatrix();
+    // World position of the chunk's center, where its mesh is centred
+    glm::dvec3 getWorldCenter() const {
+        return worldPosition + glm::dvec3(CHUNK_WORLD_SIZE_X / 2.0, 0.0, CHUNK_WORLD_SIZE_Z / 2.0);
+    }
+    // Translation to the chunk's center as seen from renderOrigin. The difference is taken in double before it
+    // is narrowed to float, so the matrix is as precise 1e7 units from the world origin as next to it. It must
+    // stay a pure translation: basic.vert passes normals through without a normal matrix.
+    glm::mat4 getModelMatrix(const glm::dvec3& renderOrigin) const {
+        return glm::translate(glm::mat4(1.0f), glm::vec3(getWorldCenter() - renderOrigin));
+    }
+
+    // Terrain height (before MESH_VERTICAL_SCALE) at a world position, using the static TERRAIN_* parameters.
+    // Shared by chunk loading and the other terrain renderers so they all produce the same surface.
+    static float sampleTerrainHeight(const PerlinNoise& noise, double worldX, double worldZ);
+    // Same surface from only the first 'octaves' octaves, with the finer ones replaced by their mean: cheaper,
+    // smoother, and on average at the same height (for distant terrain, e.g. FarFieldTerrain)
+    static float sampleTerrainHeight(const PerlinNoise& noise, double worldX, double worldZ, int octaves);
 };
 
 #endif // TERRAIN_CHUNK_H
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef TERRAIN_CLIPMAP_H
+#define TERRAIN_CLIPMAP_H
+
+#include "PerlinNoise.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+class Shader;
+
+// Geometry clipmap (Losasso & Hoppe, "Geometry Clipmaps"). Nested square grids centered on the viewer,
+// each level twice as coarse as the previous one. Every level's heights live in a layer of a texture
+// array that is addressed toroidally (world texel mod size), so when the viewer moves only the L-shaped
+// strips of texels that scroll into view are generated and uploaded; nothing else is rebuilt.
+struct ClipmapSettings {
+    int levels = 7;                 // Level 0 uses the chunk vertex spacing, each further level doubles it
+    int gridQuads = 128;            // Quads per level side (multiple of 4)
+    float transitionRatio = 0.1f;   // Fraction of a level's half-width over which it blends into the next level
+};
+
+struct ClipmapStats {
+    double updateMs = 0.0;     // CPU time of the last update (height generation + texture upload)
+    int texelsUpdated = 0;     // Heights generated during the last update
+    int levelsUpdated = 0;
+    size_t trianglesDrawn = 0;
+};
+
+class ClipmapTerrain {
+public:
+    ClipmapTerrain(const PerlinNoise* noiseGenerator, const ClipmapSettings& settings = ClipmapSettings());
+    ~ClipmapTerrain();
+
+    // Recenters the levels on the viewer and refreshes the texels that scrolled in (needs a GL context)
+    void update(const glm::dvec3& viewerPosition);
+    // The shader is expected to be the clipmap shader, already in use, with view/projection and lighting set.
+    // Levels are placed relative to renderOrigin, the origin the view matrix was built for.
+    void render(Shader& shader, const glm::dvec3& renderOrigin);
+
+    const ClipmapSettings& getSettings() const { return settings_; }
+    const ClipmapStats& getStats() const { return stats_; }
+    float getLevelSpacing(int level) const { return baseSpacing_ * static_cast<float>(1 << level); }
+    // Half-width of the outermost level in world units
+    float getExtent() const { return getLevelSpacing(settings_.levels - 1) * settings_.gridQuads * 0.5f; }
+    // Same, before a clipmap exists (e.g. to size the projection); uses the chunk vertex spacing
+    static float computeExtent(const ClipmapSettings& settings);
+
+private:
+    struct Level {
+        int originX = 0, originZ = 0;   // Grid min corner in this level's texel units
+        bool valid = false;             // False until the whole window has been filled once
+    };
+
+    const PerlinNoise* noise_;
+    ClipmapSettings settings_;
+    ClipmapStats stats_;
+    float baseSpacing_;
+    int textureSize_;     // Texels per side of each level; the valid window is gridQuads + 3 (one border for normals)
+    std::vector<Level> levels_;
+
+    bool gpuReady_;
+    GLuint gridVAO_, gridVBO_, gridEBO_;
+    GLuint heightTexture_;
+    // Index ranges into gridEBO_: 0-3 are rings whose hole is offset by (variant & 1, variant >> 1), 4 is the full grid
+    static const int RING_VARIANTS = 5;
+    GLsizei variantOffsets_[RING_VARIANTS];
+    GLsizei variantCounts_[RING_VARIANTS];
+    std::vector<float> scratch_;
+
+    void setupGPU();
+    // Generates heights for the texel rectangle [x0, x0 + width) x [z0, z0 + depth) of a level and uploads it,
+    // splitting the rectangle where it wraps around the toroidal texture.
+    void updateRegion(int level, int x0, int z0, int width, int depth);
+    static int wrap(int value, int size) { int m = value % size; return m < 0 ? m + size : m; }
+};
+
+#endif // TERRAIN_CLIPMAP_H
@@ -0,0 +1,133 @@
+#ifndef TERRAIN_FAR_FIELD_H
+#define TERRAIN_FAR_FIELD_H
+
+#include "terrain_types.h" // For Vec2i
+#include "PerlinNoise.h"
+#include "Mesh.h"
+#include "Frustum.h"
+#include "ChunkWindow.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+class Shader;
+
+// Coarse terrain beyond the chunk load radius. The ground is split into tiles of tileChunks x tileChunks chunks,
+// each one small grid mesh built from a few noise octaves (the missing ones are replaced by their mean, so the
+// far surface sits where the full one does on average). Tiles are kept in rings around the camera's tile out to
+// radiusTiles and built by the chunk workers only when no chunk or prefetch is waiting, so the far field never
+// delays the near field. Each tile is indexed cell by cell, one cell per chunk, and a cell is not drawn while its
+// chunk is: the far field fills exactly the ground the loaded chunks leave uncovered, including chunks that are
+// still loading. Every cell has skirts hanging from its edges to hide the seams against the finer chunks.
+struct FarFieldSettings {
+    bool enabled = true;
+    int tileChunks = 4;          // Chunks per tile side
+    int tileResolution = 9;      // Vertices per tile side; (tileResolution - 1) must be a multiple of tileChunks
+    int octaves = 2;             // Noise octaves sampled per vertex (the chunks use Chunk::TERRAIN_OCTAVES)
+    int radiusTiles = 12;        // Rings of tiles around the camera's tile (12 tiles of 256 units: ~3 km)
+    size_t maxQueued = 8;        // Tiles waiting for a worker at once, nearest rings first
+    int maxBuildsPerFrame = 2;   // Without worker threads: tiles built inside update() per frame
+    float skirtDepth = 0.0f;     // World units; 0 = the whole terrain height range
+};
+
+struct FarFieldStats {
+    size_t tilesResident = 0;   // Uploaded and drawable
+    size_t tilesPending = 0;    // Queued, generating or waiting to upload
+    size_t tilesBuilt = 0;      // Since the last resetBuildStats()
+    double buildMs = 0.0;       // Worker time of those builds, summed
+    size_t tilesDrawn = 0;      // Last render
+    size_t cellsDrawn = 0;
+    size_t cellsReplaced = 0;   // Cells of drawn tiles skipped because their chunk was drawable
+    size_t trianglesDrawn = 0;
+};
+
+class FarFieldTerrain {
+public:
+    // Whether the chunk at these grid coordinates is drawable; its far-field cell is then not drawn
+    using ChunkCoverageFn = std::function<bool(Vec2i chunkCoords)>;
+
+    FarFieldTerrain(const PerlinNoise* noiseGenerator, const FarFieldSettings& settings = FarFieldSettings());
+    ~FarFieldTerrain();
+    FarFieldTerrain(const FarFieldTerrain&) = delete;
+    FarFieldTerrain& operator=(const FarFieldTerrain&) = delete;
+
+    // Main thread: uploads finished tiles, recenters the rings on the camera's chunk (releasing the tiles that
+    // left them) and requests the missing ones. Tiles lying entirely within loadRadius chunks of the camera's chunk
+    // are not requested, the chunks will cover them (-1: no such square). Returns how many tiles it queued; the
+    // caller schedules one buildNext() per queued tile on its workers, or calls it directly without workers.
+    size_t update(Vec2i cameraChunkCoords, int loadRadius);
+    // Worker side: builds the queued tile nearest the camera; false if none was waiting
+    bool buildNext();
+    bool hasQueuedTiles();
+
+    // The shader is expected to be the chunk shader, in use, with the global uniforms set and texture
+    // displacement off. Tiles are placed relative to renderOrigin, the origin the view matrix was built for.
+    void render(Shader& shader, const Frustum& frustum, const glm::dvec3& renderOrigin, const ChunkCoverageFn& chunkDrawable);
+
+    const FarFieldSettings& getSettings() const { return settings_; }
+    const FarFieldStats& getStats() const { return stats_; }
+    void resetBuildStats() { stats_.tilesBuilt = 0; stats_.buildMs = 0.0; }
+    // Distance from the camera's tile to the edge of the outermost ring, in world units (e.g. to size the projection)
+    static float computeExtent(const FarFieldSettings& settings);
+
+private:
+    enum class TileState { Queued, Generating }; // Changes under queueMutex_; Generating lasts until the upload
+    struct Tile {
+        Vec2i coords;             // Tile grid coordinates (chunk coordinates / tileChunks, rounded down)
+        Mesh mesh;                // Vertices relative to the tile's center, indices cell by cell
+        TileState state = TileState::Queued;
+        bool resident = false;    // Uploaded and drawable; main thread only
+        std::atomic<bool> cancelled{ false }; // Left the rings while a worker had it
+        BoundingBox worldBounds;
+        std::vector<GLsizei> cellCounts;      // Per cell (row-major), indices in the cell's range
+        std::vector<uint32_t> cellFirst;      // Per cell, first index of the cell's range
+    };
+    struct TileSlot {
+        std::unique_ptr<Tile> tile;
+    };
+    struct QueuedTile {
+        Tile* tile;
+        int ring;                 // Chebyshev distance in tiles from the camera's tile when queued
+    };
+
+    const PerlinNoise* noise_;
+    FarFieldSettings settings_;
+    FarFieldStats stats_;
+    float tileWorldSize_;
+    float vertexSpacing_;
+    float skirtDepth_;
+
+    ChunkWindow<TileSlot> tiles_;
+    bool tilesInitialized_ = false;
+    Vec2i lastCameraChunk_;
+    int lastLoadRadius_ = -1;
+    bool refillPending_ = false; // The last pass stopped at maxQueued with tiles still missing
+
+    std::mutex queueMutex_;
+    std::vector<QueuedTile> queue_;
+    std::mutex completedMutex_;
+    std::vector<Tile*> completed_;       // Built by workers, uploaded by the next update()
+    std::vector<double> completedMs_;    // Build time of each, same order
+    std::vector<std::unique_ptr<Tile>> cancelled_; // Released while generating; freed once their build reports back
+
+    // render() scratch: merged cell ranges of one tile
+    std::vector<GLsizei> drawCounts_;
+    std::vector<const void*> drawOffsets_;
+
+    Vec2i tileOfChunk(Vec2i chunkCoords) const;
+    glm::dvec3 tileOrigin(Vec2i tileCoords) const; // Minimum corner in world space
+    // Whether every chunk of the tile lies within loadRadius chunks of the camera's chunk on both axes
+    bool tileInsideLoadSquare(Vec2i tileCoords, Vec2i cameraChunkCoords, int loadRadius) const;
+    void releaseTile(TileSlot& slot);
+    void uploadCompletedTiles();
+    // Heights, normals and cell-ordered indices of one tile; touches no GL state
+    void buildTile(Tile& tile) const;
+};
+
+#endif // TERRAIN_FAR_FIELD_H
@@ -5,16 +5,248 @@
 #include "terrain_chunk.h" // For Chunk class
 #include "Camera.h"        
 #include "PerlinNoise.h"   // Add this
+#include "GeoMipmap.h"     // Shared LOD index set
+#include "HeightTextureArray.h" // Heights of texture-displaced chunks
+#include "terrain_cdlod.h" // Quadtree render path
+#include "terrain_clipmap.h" // Nested-ring render path
+#include "terrain_far_field.h" // Coarse tiles beyond the load radius
+#include "Frustum.h"
+#include "ChunkCullTree.h" // Hierarchical chunk culling
+#include "ChunkCache.h"    // Persistent chunk heights
+#include "ThreadPool.h"    // Chunk generation workers
+#include "ChunkWindow.h"   // Toroidal storage of the loaded chunks
+#include "EvictedChunkCache.h" // Recently unloaded chunks
+#include "MeshBufferPool.h" // Recycled chunk GL buffers
 #include <glm/glm.hpp>
 #include <vector>
-#include <unordered_map>
 #include <memory>          // For std::unique_ptr
+#include <mutex>
+#include <chrono>
 #include <cmath>           // For std::floor
 #include <iostream>        // For debugging
 
 // Forward declaration
 class Shader;
 
+// How renderActiveChunks picks a geomipmap level per chunk.
+enum class LodSelectionMode {
+    Distance,        // Level l beyond lodBaseDistance * 2^(l-1)
+    ScreenSpaceError // Coarsest level whose projected vertical error stays under pixelTolerance
+};
+
+struct LodSettings {
+    bool enabled = true;
+    LodSelectionMode mode = LodSelectionMode::ScreenSpaceError;
+    float baseDistance = 96.0f;            // Distance mode: full resolution closer than this
+    float pixelTolerance = 2.0f;           // Screen-space error mode: allowed error in pixels
+    float viewportHeight = 720.0f;         // Screen-space error mode: set from the framebuffer each frame
+    float fovYRadians = 0.785398f;         // Screen-space error mode: vertical field of view (45 degrees)
+};
+
+// Which terrain representation is streamed and drawn.
+enum class TerrainRenderMode {
+    Chunks, // Loaded chunk meshes around the camera (renderActiveChunks)
+    Cdlod,  // Quadtree of shared patches over the whole view distance (renderCdlod); no chunks are loaded
+    Clipmap // Nested grids around the viewer with toroidally updated height textures (renderClipmap)
+};
+
+// Visibility tests of renderActiveChunks.
+struct CullingSettings {
+    bool frustum = true;  // Skip chunks whose bounds are outside the view frustum
+    bool hierarchical = true; // Test blocks of chunks through a quadtree (ChunkCullTree) instead of every chunk
+    bool clusters = true; // Draw full-resolution chunk meshes cluster by cluster, skipping hidden clusters
+};
+
+// Per-frame numbers from renderActiveChunks, for comparing LOD settings and load radii.
+struct TerrainRenderStats {
+    size_t chunksDrawn = 0;
+    size_t chunksCulled = 0; // Outside the frustum
+    size_t blocksCulled = 0; // Quadtree blocks of several chunks culled with one test
+    size_t boundsTested = 0; // Frustum tests spent on chunks and blocks
+    size_t trianglesDrawn = 0;
+    std::vector<int> chunksPerLevel; // Index = geomipmap level
+    ClusterCullStats clusters;       // Chunks drawn through Chunk::renderClusters
+};
+
+// Chunk loads since the last resetLoadStats(). Allocation counts need TERRAIN_COUNT_ALLOCATIONS (AllocationCounter.h).
+struct TerrainLoadStats {
+    size_t chunksLoaded = 0;
+    uint64_t heapAllocations = 0;    // Summed over the loads
+    uint64_t maxHeapAllocations = 0; // Worst single load
+
+    // Where the heights came from: the disk cache, or the noise (then written to the cache if it is open)
+    size_t cacheHits = 0;
+    size_t heightsGenerated = 0;
+    double cacheReadMs = 0.0;
+    double generateMs = 0.0;
+    double cacheWriteMs = 0.0;
+
+    // Main-thread side of the loads (GL uploads), and chunks dropped because they were unloaded mid-build
+    double uploadMs = 0.0;
+    double maxUploadMs = 0.0;
+    size_t chunksCancelled = 0;
+    size_t cancelledBeforeBuild = 0; // Of chunksCancelled: taken out of the build queue before a worker started them
+
+    // Requests answered by the evicted chunk cache (see EvictedChunkSettings); misses only count while it is enabled
+    size_t evictedCacheHits = 0;
+    size_t evictedCacheMisses = 0;
+
+    // Upload scheduling: per-frame totals against UploadBudget, and request-to-drawable latency per chunk
+    size_t uploadedBytes = 0;
+    size_t maxFrameUploadBytes = 0;
+    double maxFrameUploadMs = 0.0;
+    size_t framesBudgetLimited = 0; // Frames that left ready chunks queued because the budget ran out
+    double timeToVisibleMs = 0.0;   // Summed over chunksLoaded
+    double maxTimeToVisibleMs = 0.0;
+
+    // Index buffers of the uploaded chunk meshes (see IndexOptimizer): bytes and ACMR (post-transform cache misses
+    // per triangle) of plain row-order 32-bit triangles and of what was uploaded, summed over indexedChunks
+    size_t indexedChunks = 0;
+    size_t indexBytesBefore = 0;
+    size_t indexBytesAfter = 0;
+    double acmrBefore = 0.0;
+    double acmrAfter = 0.0;
+
+    // Chunk objects behind the requests: newly allocated, or recycled from unloaded ones (see PoolingSettings)
+    size_t chunksCreated = 0;
+    size_t chunksRecycled = 0;
+
+    // Trajectory prefetch (see PrefetchSettings) and how often chunks arrived late
+    size_t prefetchesQueued = 0;
+    size_t prefetchesUsed = 0;   // Requests that took over a prefetch (built ones are uploaded in the same frame)
+    size_t prefetchesWasted = 0; // Built prefetches dropped unused because the camera's path changed
+    size_t popIns = 0;           // Requested chunks that were in view, still missing, for at least one frame
+};
+
+// Per-frame limits on uploading finished chunks. The nearest ready chunks go first, and at least one chunk is
+// uploaded every frame so the queue always drains.
+struct UploadBudget {
+    size_t maxBytesPerFrame = 4 * 1024 * 1024; // Vertex, index and height texel bytes
+    double maxMsPerFrame = 2.0;                // Main-thread time spent in uploads
+};
+
+// Chunks that leave the unload radius go to a least-recently-used cache instead of being freed, so coming back
+// (e.g. moving to and fro across a chunk boundary) does not regenerate them.
+struct EvictedChunkSettings {
+    size_t maxBytes = 64 * 1024 * 1024; // Budget for the cached chunks; 0 frees chunks on unload
+    bool keepGpuBuffers = true;         // Keep whole uploaded chunks (drawable again at once); false keeps only
+                                        // their bordered heights (35x35 floats, ~4.8 KB, for 33x33 chunks) and
+                                        // rebuilds the mesh on a worker. Displaced chunks always keep only heights,
+                                        // so evicted chunks hold no layers of the height texture array
+};
+
+// Recycling of chunk objects and of their meshes' GL objects (MeshBufferPool), so streaming in steady state
+// refills existing buffers with glBufferSubData instead of creating and deleting driver objects.
+struct PoolingSettings {
+    bool enabled = true;                          // False: every chunk and buffer set is allocated and freed
+    size_t maxSpareChunks = 64;                   // Unused chunk objects kept for reuse
+    size_t maxIdleBufferBytes = 32 * 1024 * 1024; // Unused GPU buffer storage kept for reuse
+    int bufferReuseDelayFrames = 2;               // Frames a released buffer set rests before it is refilled
+    int reservedBufferSets = -1;                  // Created after the first chunk upload; -1 = two window edges
+};
+
+// Order in which requested chunks are generated and uploaded (see TerrainManager::computeChunkPriority).
+// A chunk's score is its distance from the camera, scaled up for chunks away from the direction of travel and
+// for chunks outside the last rendered frustum; lower scores go first.
+struct ChunkPrioritySettings {
+    bool enabled = true;              // False: plain distance from the camera
+    float headingWeight = 1.0f;       // A chunk straight behind the camera counts as (1 + headingWeight) times farther
+    float outsideFrustumScale = 2.0f; // Chunks the camera cannot see count as this much farther
+    float lookAheadSeconds = 0.5f;    // Distances are measured from where the camera will be, at its current velocity
+};
+
+// Chunk generation ahead of the camera. The camera's motion is extrapolated over horizonSeconds, and the chunks
+// its load region would take in along the way are built (heights and CPU mesh) by the workers whenever no
+// requested chunk is waiting. A built prefetch waits until its chunk is requested and is then uploaded in the
+// same frame, so fast flight does not leave holes at the edge of the view. Needs worker threads.
+struct PrefetchSettings {
+    bool enabled = true;
+    float horizonSeconds = 2.0f;  // How far ahead the trajectory is followed
+    float minSpeed = 8.0f;        // World units per second; slower cameras are served well by normal requests
+    size_t maxQueued = 16;        // Prefetches waiting for a worker at once
+    size_t maxReady = 32;         // Prefetches (queued, generating or built) held at once, nearest along the path first
+    bool followTurns = true;      // Bend the extrapolation by the turn rate of the camera's recent path
+    float replanSeconds = 0.25f;  // The plan is also redone on every chunk change
+};
+
+// Feedback control of loadRadius from the frame times passed to reportFrameTime() and the streaming backlog. Over
+// the target it first coarsens the LOD (raising the LOD bias toward maxLodBias), then steps the radius down; under
+// the target by the headroom, with the backlog drained, it refines the LOD back and then steps the radius up.
+// Frame times are smoothed (starting from targetFrameMs, with single hitches clipped), every change is followed by
+// holdSeconds without another, and a radius that overran the target is only tried again after a cooldown that
+// doubles each time it overruns again, so the radius settles instead of swinging between two values.
+struct AdaptiveRadiusSettings {
+    bool enabled = false;
+    int minRadius = 2;
+    int maxRadius = 16;
+    float targetFrameMs = 16.7f;
+    float headroom = 0.2f;        // Grow only below targetFrameMs * (1 - headroom)
+    float smoothing = 0.05f;      // Weight of each new frame time in the running average
+    float maxSampleFactor = 4.0f; // Single frame times are clamped to targetFrameMs * this before averaging
+    float holdSeconds = 1.0f;     // No further change for this long after one
+    float retrySeconds = 10.0f;   // First cooldown before growing back to a radius that overran the target
+    size_t maxBacklog = 0;        // Requested chunks not yet uploaded above which the radius does not grow; 0 = 8 * (r + 1)
+    float maxLodBias = 4.0f;      // Largest multiple of LodSettings::pixelTolerance (divisor of baseDistance)
+    float lodBiasStep = 1.25f;    // Factor per LOD change
+};
+
+// Where the adaptive radius controller stands (see TerrainManager::getAdaptiveRadiusStatus)
+struct AdaptiveRadiusStatus {
+    int radius = 0;
+    float lodBias = 1.0f;         // 1 unless the controller coarsened the LOD
+    float smoothedFrameMs = 0.0f;
+    size_t backlog = 0;           // Chunks queued for a worker or waiting to upload
+    size_t radiusIncreases = 0;
+    size_t radiusDecreases = 0;
+};
+
+// Which positions around the camera's chunk are requested. The window of loaded chunks stays a square of
+// unloadRadius; the shape picks the positions in it that are wanted.
+enum class LoadRegionShape {
+    Square,      // Every chunk within loadRadius on both axes: (2r+1)^2 chunks, corners sqrt(2) farther than edges
+    Circle,      // Chunks whose centers are within loadRadius chunks of the camera's chunk
+    ViewEllipse, // Ellipse pushed ahead along the view: loadRadius ahead and across the view cone, less behind
+    Budget       // The budgetChunks best chunks by computeChunkPriority (distance, heading, frustum)
+};
+
+struct LoadRegionSettings {
+    LoadRegionShape shape = LoadRegionShape::Square;
+    float backScale = 0.5f;          // ViewEllipse: reach behind the camera, as a fraction of loadRadius
+    float viewHalfAngleDegrees = 40.0f; // ViewEllipse: directions this close to the view still reach loadRadius
+    size_t budgetChunks = 0;         // Budget: chunks to keep requested; 0 = as many as the circle of loadRadius
+    float refreshAngleDegrees = 15.0f; // ViewEllipse and Budget: re-evaluate after the view turns this far
+};
+
+// Chunks in the streaming pipeline right now, by ChunkState (see getStreamingStats).
+struct TerrainStreamingStats {
+    size_t queued = 0;
+    size_t generating = 0;
+    size_t readyToUpload = 0;     // Upload queue depth
+    size_t resident = 0;
+    size_t cancelledInFlight = 0; // Unloaded while a worker still had them
+    int workerThreads = 0;        // 0 = chunks are built on the render thread
+    size_t evicted = 0;           // Entries in the evicted chunk cache
+    size_t evictedBytes = 0;
+    size_t regionChunks = 0;      // Positions in the load region (see LoadRegionSettings)
+    size_t farTilesResident = 0;  // Far-field tiles (see FarFieldSettings), drawable
+    size_t farTilesPending = 0;   // Far-field tiles queued, generating or waiting to upload
+};
+
+// Memory held by loaded chunks, grouped by mesh residency (see Chunk::MESH_RESIDENCY).
+struct TerrainMemoryStats {
+    struct PolicyTotals {
+        size_t chunks = 0;
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+    };
+    PolicyTotals perPolicy[3];  // Index = static_cast<int>(MeshResidency)
+    size_t sharedCpuBytes = 0;  // Displacement height array shadow copy and shared grid
+    size_t sharedGpuBytes = 0;
+
+    size_t totalCpuBytes() const { return sharedCpuBytes + perPolicy[0].cpuBytes + perPolicy[1].cpuBytes + perPolicy[2].cpuBytes; }
+    size_t totalGpuBytes() const { return sharedGpuBytes + perPolicy[0].gpuBytes + perPolicy[1].gpuBytes + perPolicy[2].gpuBytes; }
+};
+
 class TerrainManager {
 public:
     // The radius of chunks to load around the camera's current chunk.
@@ -22,11 +254,122 @@ public:
     // A radius of 1 means a 3x3 grid of chunks.
     // A radius of 2 means a 5x5 grid of chunks.
     int loadRadius;
+    // Chunks stay loaded until they are farther than this (in chunks), so moving to and fro across a chunk boundary
+    // does not unload and reload a row each time. -1 means loadRadius + 1; never less than loadRadius.
+    int unloadRadius = -1;
+    // Shape of the requested area within loadRadius. Outside the square, the hysteresis band is
+    // unloadRadius - loadRadius chunks of region distance (or of priority score, for Budget).
+    LoadRegionSettings loadRegion;
+    EvictedChunkSettings evictedChunkSettings;
+    PrefetchSettings prefetch;
+    // When enabled, loadRadius is set by the controller (within its bounds) from reportFrameTime()
+    AdaptiveRadiusSettings adaptiveRadius;
+    // Coarse terrain around the loaded chunks (chunk mode only). Read when the first update() creates it;
+    // clearing 'enabled' later only stops updating and drawing it.
+    FarFieldSettings farField;
+
+    // Geomipmapping settings used by renderActiveChunks
+    LodSettings lodSettings;
+    CullingSettings cullingSettings;
+
+    // Set before the first update(); CDLOD settings are read when the CDLOD terrain is first created
+    TerrainRenderMode renderMode = TerrainRenderMode::Chunks;
+    CdlodSettings cdlodSettings;
+    ClipmapSettings clipmapSettings;
+
+    // Chunk heights are cached on disk under this directory (one subdirectory per generator key); empty, the
+    // default, disables it. Nothing is evicted, so every seed used with the same directory adds to it.
+    std::string chunkCacheDirectory;
+
+    // Threads generating chunks, read when the first chunk is requested: -1 picks one less than the hardware
+    // threads, 0 builds chunks synchronously inside update()
+    int workerThreads = -1;
+    UploadBudget uploadBudget;
+    ChunkPrioritySettings chunkPriority;
+    PoolingSettings pooling;
 
 private:
-    // Stores currently active/loaded chunks, keyed by their grid coordinates.
+    // One position of the load window: empty, or a requested chunk that is pending (queued, generating or
+    // waiting to upload) or resident (uploaded and drawable).
     // Using unique_ptr to manage the lifetime of Chunk objects.
-    std::unordered_map<Vec2i, std::unique_ptr<Chunk>> activeChunks_;
+    struct ChunkSlot {
+        std::unique_ptr<Chunk> chunk;
+        bool resident = false;
+        std::chrono::steady_clock::time_point requestedAt;
+        bool waitingForUpload = false; // Build result consumed, listed in uploadQueue_
+        int lodLevel = -1;             // renderActiveChunks scratch: geomipmap level, -1 when not drawn
+        bool visible = false;          // renderActiveChunks scratch: drawable and not frustum-culled
+        bool missingInView = false;    // Requested, and inside a rendered frustum before it was drawable
+    };
+    // The (2 * unloadRadius + 1)^2 chunks around the camera's chunk; chunks leaving it are unloaded (evicted)
+    ChunkWindow<ChunkSlot> chunkWindow_;
+    int windowLoadRadius_ = -1;         // loadRadius the window's contents were requested for
+    LoadRegionShape windowShape_ = LoadRegionShape::Square; // Shape they were requested with
+    glm::vec2 regionViewDirection_ = glm::vec2(0.0f); // XZ view direction when the region was last evaluated
+    size_t loadRegionChunks_ = 0;
+    std::vector<float> regionScores_;   // updateLoadRegion scratch (Budget): priority per window slot
+    std::vector<float> regionRanked_;   // Copy of regionScores_ partially sorted for the budget cut
+    EvictedChunkCache evictedChunks_;
+    // Bounds of the drawable chunks in the window, rebuilt when the window moves and patched at the positions
+    // listed in cullTreeUpdates_ (chunks that became drawable or were unloaded since the last frame)
+    ChunkCullTree cullTree_;
+    std::vector<Vec2i> cullTreeUpdates_;
+    std::vector<EvictedChunk> droppedChunks_; // Scratch for entries leaving evictedChunks_
+    std::vector<Vec2i> enteringChunks_; // updateDesiredChunks scratch: positions to request
+    std::vector<Vec2i> retryChunks_;    // Height generation failed; requested again on the next move
+    std::vector<Vec2i> uploadQueue_;    // Pending chunks whose build is done, in no particular order until sorted
+    // Queued chunks no worker has started yet. Each request submits one job, and a job builds whichever queued
+    // chunk has the lowest priority score at the time it runs, so late requests for chunks ahead of the camera
+    // overtake older ones. Unloading a queued chunk just removes it here (its job then finds nothing to do).
+    struct QueuedBuild {
+        Chunk* chunk;
+        float priority;
+    };
+    std::mutex buildQueueMutex_;
+    std::vector<QueuedBuild> buildQueue_;
+    // Prefetches waiting for a worker, soonest needed first; workers take them only when buildQueue_ is empty.
+    // Their chunk objects (waiting or generating) are owned by prefetchChunks_; built ones move to
+    // prefetchedChunks_ (oldest first) until requested.
+    std::vector<Chunk*> prefetchQueue_;
+    std::vector<std::unique_ptr<Chunk>> prefetchChunks_;
+    std::vector<std::unique_ptr<Chunk>> prefetchedChunks_;
+    std::vector<Vec2i> prefetchCandidates_; // planPrefetch scratch
+    std::chrono::steady_clock::time_point lastPrefetchPlan_;
+
+    // Camera motion for computeChunkPriority, updated every update()
+    glm::dvec3 lastCameraPosition_ = glm::dvec3(0.0);
+    glm::vec3 cameraVelocity_ = glm::vec3(0.0f); // Smoothed, world units per second
+    glm::vec2 cameraHeading_ = glm::vec2(0.0f);  // Unit XZ direction of travel (or view when still), zero if none
+    glm::vec2 cameraViewDirection_ = glm::vec2(0.0f); // Unit XZ view direction, zero when looking straight up or down
+    glm::vec2 travelDirection_ = glm::vec2(0.0f); // Unit XZ direction of the smoothed velocity, zero when still
+    float turnRate_ = 0.0f;                        // Of travelDirection_, radians per second (counterclockwise from +X toward +Z)
+    std::chrono::steady_clock::time_point lastUpdateTime_;
+    bool cameraMotionValid_ = false;
+    Frustum lastFrustum_; // From the last renderActiveChunks
+    bool lastFrustumValid_ = false;
+    // Chunks unloaded while a worker could still be using them; freed once their build reports back
+    std::vector<std::unique_ptr<Chunk>> cancelledChunks_;
+    // Unloaded chunk objects (data freed) waiting to be reset for a new request
+    std::vector<std::unique_ptr<Chunk>> spareChunks_;
+    bool bufferSetsReserved_ = false;
+
+    // What a worker reports for one chunk; timings are folded into loadStats_ on the main thread
+    struct ChunkBuildResult {
+        Chunk* chunk = nullptr;
+        bool built = false;    // False if skipped (cancelled) or height generation failed
+        bool heightsKept = false; // Rebuilt from heights kept by the evicted chunk cache
+        bool prefetch = false;    // Built for prefetchChunks_, not for a window slot
+        bool cacheHit = false;
+        bool cacheWritten = false;
+        double cacheReadMs = 0.0;
+        double generateMs = 0.0;
+        double cacheWriteMs = 0.0;
+    };
+    std::mutex completedMutex_;
+    std::vector<ChunkBuildResult> completedBuilds_; // Filled by workers under completedMutex_
+    std::vector<ChunkBuildResult> drainedBuilds_;   // Swapped with completedBuilds_, so uploads run unlocked
+    std::unique_ptr<ThreadPool> workers_;           // Null when chunks are built synchronously
+    bool workersStarted_ = false;
 
     // Keep track of the camera's last known chunk coordinates to avoid unnecessary updates
     Vec2i lastCameraChunkCoords_;
@@ -34,28 +377,170 @@ private:
 
     PerlinNoise perlinGenerator_; // Owns a PerlinNoise instance
 
+    // Geomipmap index variants shared by all chunks, built on first render (needs a GL context)
+    GeoMipmapIndexSet lodIndexSet_;
+    bool lodIndexSetBuilt_ = false;
+    TerrainRenderStats lastRenderStats_;
+    TerrainLoadStats loadStats_;
+    ChunkCache chunkCache_;
+    bool chunkCacheTried_ = false; // open() is attempted once, on the first chunk load
+
+    // Texture-displaced chunks (Chunk::MESH_BUILDER == Displaced): one flat grid shared by every chunk,
+    // displaced in basic.vert by each chunk's layer of chunkHeightTextures_
+    HeightTextureArray chunkHeightTextures_;
+    Mesh displacedGrid_;
+    bool displacementReady_ = false;
+    bool displacingShader_ = false; // Current value of the displaceFromTexture uniform during renderActiveChunks
+
+    // Chunks drawn through their clusters are gathered during renderActiveChunks and their clusters frustum-culled
+    // together: one cullBatch over every such chunk (a few boxes each) keeps the 8- and 16-wide kernels busy,
+    // where one call per chunk left them all to the scalar tail loop
+    struct ClusterBatchChunk {
+        Chunk* chunk;
+        uint32_t firstBox;  // Of its clusters in frameClusterBounds_
+        uint32_t boxCount;
+    };
+    AABBBatch frameClusterBounds_;                    // World space; capacity kept across frames
+    std::vector<ClusterBatchChunk> frameClusterChunks_;
+    std::vector<uint32_t> frameVisibleClusters_;
+
+    // Adaptive radius controller state; its clock is the sum of the reported frame times
+    AdaptiveRadiusStatus adaptiveStatus_;
+    double adaptiveClockSeconds_ = 0.0;
+    double adaptiveHoldUntil_ = 0.0;
+    int overrunRadius_ = -1;             // Last radius that overran the target frame time
+    double overrunRetryAt_ = 0.0;        // Growing back to overrunRadius_ waits until then
+    double overrunCooldownSeconds_ = 0.0;
+
+    std::unique_ptr<CdlodTerrain> cdlodTerrain_; // Created on first renderCdlod
+    std::unique_ptr<ClipmapTerrain> clipmapTerrain_; // Created on first update in clipmap mode
+    // Created on the first update in chunk mode, before any worker starts, and kept until destruction, so
+    // workers can read the pointer without a lock
+    std::unique_ptr<FarFieldTerrain> farField_;
+
 public:
     // Constructor
-    TerrainManager(int pLoadRadius);
+    TerrainManager(int pLoadRadius);                     // Random terrain seed
+    TerrainManager(int pLoadRadius, unsigned int seed);  // Same seed, same terrain (and chunk cache hits across runs)
     ~TerrainManager();
 
     // Main update function, called every frame.
     // Determines which chunks to load/unload based on camera position.
+    // In clipmap mode it recenters the clipmap levels instead (needs a GL context).
     void update(const Camera& camera);
 
-    // Renders all currently active and loaded chunks.
-    // (Implementation will be more detailed in a later step)
-    void renderActiveChunks(Shader& terrainShader);
+    // The last frame's duration, for the adaptive radius controller; call once per frame before update().
+    // Changes it makes to loadRadius take effect in that update().
+    void reportFrameTime(float frameMs);
+    const AdaptiveRadiusStatus& getAdaptiveRadiusStatus() const { return adaptiveStatus_; }
+
+    // Renders all currently active and loaded chunks that pass cullingSettings against the frustum.
+    // With lodSettings.enabled each chunk is drawn at a geomipmap level chosen from viewPosition,
+    // with neighbors kept within one level of each other and stitched so no cracks appear.
+    // Full-resolution unstitched chunks are drawn by cluster (Chunk::renderClusters). The far field (see
+    // FarFieldSettings) is drawn after them, on the ground no drawable chunk covers.
+    // Every render path draws relative to renderOriginFor(viewPosition), which the view matrix must use too
+    // (Camera::GetViewMatrix does); the frustum is in absolute world space.
+    void renderActiveChunks(Shader& terrainShader, const Frustum& frustum, const glm::dvec3& viewPosition);
+
+    // CDLOD render path: selects quadtree nodes against the frustum and draws them.
+    // cdlodShader must be the CDLOD shader, in use, with the same global uniforms as the chunk shader.
+    void renderCdlod(Shader& cdlodShader, const Frustum& frustum, const glm::dvec3& viewPosition);
+
+    // Clipmap render path: draws every level updated by the last update().
+    // clipmapShader must be the clipmap shader, in use, with the same global uniforms as the chunk shader.
+    void renderClipmap(Shader& clipmapShader, const glm::dvec3& viewPosition);
+
+    const TerrainRenderStats& getLastRenderStats() const { return lastRenderStats_; }
+    const TerrainLoadStats& getLoadStats() const { return loadStats_; }
+    unsigned int getSeed() const { return perlinGenerator_.getSeed(); }
+    void resetLoadStats() { loadStats_ = TerrainLoadStats(); }
+    TerrainStreamingStats getStreamingStats() const;
+    // Walks the loaded chunks; cheap enough for a periodic stats print, not meant for every frame
+    TerrainMemoryStats computeMemoryStats() const;
+    const CdlodTerrain* getCdlodTerrain() const { return cdlodTerrain_.get(); }
+    const ClipmapTerrain* getClipmapTerrain() const { return clipmapTerrain_.get(); }
+    const FarFieldTerrain* getFarFieldTerrain() const { return farField_.get(); }
+    void resetFarFieldBuildStats() { if (farField_) farField_->resetBuildStats(); }
 
 private:
     // Calculates the grid coordinates of the chunk the camera is currently in.
     Vec2i getCameraChunkCoordinates(const Camera& camera) const;
 
-    // Manages loading a specific chunk.
+    // Recenters the load window on the camera's chunk, unloading and requesting chunks along its edges
+    void updateDesiredChunks(Vec2i cameraChunkCoords);
+    // Rebuilds the window for a new unload radius, keeping the chunks that still fit
+    void resizeChunkWindow(Vec2i center, int radius);
+    int getUnloadRadius() const;
+    // Circle, ViewEllipse and Budget: requests the window positions inside the region and unloads chunks past
+    // its hysteresis band. Visits the whole window, so it runs on chunk changes and view turns only.
+    void updateLoadRegion(Vec2i center);
+    // Circle and ViewEllipse: distance in chunks from the camera's chunk, stretched by the ellipse's axes
+    float regionDistance(Vec2i chunkCoords, Vec2i center) const;
+    bool loadRegionNeedsRefresh() const; // The view turned past refreshAngleDegrees (view-dependent shapes)
+
+    // Requests a chunk: it is queued for a worker (or built right away without workers) and becomes
+    // drawable once processCompletedBuilds() has uploaded it.
     void loadChunk(Vec2i chunkCoords);
+    // Worker side: takes the best chunk from buildQueue_ (or, with none left, the next prefetch) and builds it.
+    // With neither waiting it builds a far-field tile instead, so far tiles only use otherwise idle workers.
+    void buildNextChunk();
+    void startWorkers(); // Once, on the first chunk or far-field request (see workerThreads)
+    // Heights from the cache or the noise, then Chunk::prepare; posts a ChunkBuildResult
+    void buildChunk(Chunk* chunk, bool prefetch = false);
+    // Extrapolates the camera's path and queues prefetches for the chunks its load region will take in; queued
+    // prefetches still on the path are kept, the others dropped
+    void planPrefetch(Vec2i cameraChunkCoords);
+    // Recenters the far field and schedules its new tiles (on the workers, or a few per frame without them)
+    void updateFarField(Vec2i cameraChunkCoords);
+    void renderFarField(Shader& terrainShader, const Frustum& frustum, const glm::dvec3& renderOrigin);
+    bool isChunkDrawable(Vec2i chunkCoords) const; // A resident, uploaded chunk is loaded at these coordinates
+    void cancelQueuedPrefetches();
+    // Main thread: moves a finished prefetch to prefetchedChunks_; false if a request adopted it meanwhile
+    bool completePrefetch(const ChunkBuildResult& result);
+    // Hands the prefetch for these coordinates (built, queued or generating) to the requesting slot; false if none
+    bool adoptPrefetchedChunk(Vec2i chunkCoords, ChunkSlot& slot);
+    // Whether the load region around 'center' includes chunkCoords (Budget is treated as a circle)
+    bool isInLoadRegion(Vec2i chunkCoords, Vec2i center) const;
+    // Main thread: collects finished builds, frees cancelled chunks and uploads ready ones within uploadBudget
+    void processCompletedBuilds();
+    // Tracks camera velocity and heading between updates
+    void updateCameraMotion(const Camera& camera);
+    // Rescores the chunks still waiting for a worker against the current camera
+    void reprioritizeBuildQueue();
+    // Generation and upload order (see ChunkPrioritySettings): lower goes first
+    float computeChunkPriority(Vec2i chunkCoords) const;
+
+    // Manages unloading a specific chunk, leaving its slot empty. Resident chunks go to evictedChunks_.
+    void unloadChunk(ChunkSlot& slot);
+    void evictChunk(std::unique_ptr<Chunk> chunk);
+    // Chunks keep their heights after prepare() for evictChunk: in heights-only mode, and always for displaced chunks
+    bool keepsHeightsForEviction() const;
+    // New chunk objects come from spareChunks_ when pooling is enabled; freed ones go back there (or are deleted)
+    std::unique_ptr<Chunk> acquireChunk(Vec2i chunkCoords);
+    void recycleChunk(std::unique_ptr<Chunk> chunk);
+    // Pending chunks that are freed before upload still hand their heights to evictedChunks_ (heights-only mode)
+    void keepEvictedHeights(std::unique_ptr<Chunk>& chunk);
+
+    // Geomipmap level for one chunk before neighbor constraints are applied
+    int selectLodLevel(const Chunk& chunk, const glm::vec3& viewPosition) const;
+    // Limits neighboring chunks to at most one level of difference, so one stitch variant per edge suffices
+    void constrainLodLevels();
 
-    // Manages unloading a specific chunk.
-    void unloadChunk(Vec2i chunkCoords);
+    // Builds the shared grid and height texture array on the first displaced chunk (needs a GL context)
+    void setupDisplacementResources();
+    // Draws one chunk with whichever path it was loaded for and returns the triangles submitted. Chunks drawn
+    // through their clusters are only queued (returning 0); renderClusterBatch draws them.
+    size_t renderChunk(Chunk& chunk, const ChunkUniforms& uniforms, const GeoMipmapIndexSet* lodIndexSet, int level, int stitchMask,
+                       const glm::dvec3& renderOrigin);
+    // Culls the clusters of every queued chunk in one batch, draws the survivors and returns the triangles drawn
+    size_t renderClusterBatch(const ChunkUniforms& uniforms, const Frustum& frustum, const glm::dvec3& renderOrigin, const glm::vec3& viewPosition);
+    // Sets ChunkSlot::visible for every drawable chunk that passes cullingSettings, and the culling stats
+    void cullChunks(const Frustum& frustum);
+    static bool isSlotDrawable(const ChunkSlot& slot);
+    // A chunk's column over the whole terrain height range, for tests made before its heights are known
+    static BoundingBox chunkColumnBounds(Vec2i chunkCoords);
+    void markCullTreeChanged(Vec2i chunkCoords); // The chunk at these coordinates became drawable or went away
 };
 
 #endif // TERRAIN_MANAGER_H
\ No newline at end of file
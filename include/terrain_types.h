@@ -2,6 +2,7 @@
 #define TERRAIN_TYPES_H
 
 #include <functional> // For std::hash
+#include <cstdint>
 #include <glm/glm.hpp> // For potential future use or if you prefer glm::ivec2
 
 // Simple struct for 2D integer coordinates (e.g., for chunk grid)
@@ -28,10 +29,15 @@ namespace std {
     template <>
     struct hash<Vec2i> {
         size_t operator()(const Vec2i& v) const {
-            // A common way to combine hashes
-            size_t h1 = hash<int>()(v.x);
-            size_t h2 = hash<int>()(v.z);
-            return h1 ^ (h2 << 1); // Or use boost::hash_combine if available
+            // Both coordinates in one 64-bit word, then the MurmurHash3 finalizer so every input bit reaches
+            // every output bit (std::hash<int> is the identity, and x ^ (z << 1) collides along diagonals)
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(v.x)) << 32) | static_cast<uint32_t>(v.z);
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdull;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ull;
+            key ^= key >> 33;
+            return static_cast<size_t>(key);
         }
     };
 }
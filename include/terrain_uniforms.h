@@ -0,0 +1,47 @@
+#ifndef TERRAIN_UNIFORMS_H
+#define TERRAIN_UNIFORMS_H
+
+#include <glm/glm.hpp>
+#include <cstddef> // For offsetof
+
+// C++ mirrors of the std140 uniform blocks shared by the terrain shaders (basic.frag and the basic, CDLOD and
+// clipmap vertex shaders, which repeat the declarations). Every vec3 is followed by a scalar filling the rest of
+// its 16-byte slot, so the std140 layout is the plain packed C++ layout; the asserts below keep the two in step.
+// Shader::bindUniformBlock also compares the linked block size against sizeof.
+
+// Binding points the blocks are attached to (UniformBuffer::create) and read from (Shader::bindUniformBlock)
+const unsigned int FRAME_UNIFORM_BINDING = 0;
+const unsigned int MATERIAL_UNIFORM_BINDING = 1;
+
+// Camera, light and fog: uploaded once per frame
+struct FrameUniformBlock {
+    glm::mat4 viewProjection;  // projection * view, relative to the render origin
+    glm::vec3 lightDir_world;  // Direction OF the light rays
+    float ambientStrength;
+    glm::vec3 lightColor;
+    float fogDensity;          // Exponential squared fog
+    glm::vec3 viewPos_world;   // Relative to the render origin
+    float padding0;
+    glm::vec3 fogColor;
+    float padding1;
+};
+
+// Height-based texture blending and specular response: set once, unchanged afterwards
+struct MaterialUniformBlock {
+    float heightRockStart;
+    float heightRockFull;
+    float heightSnowStart;
+    float heightSnowFull;
+    float textureTilingFactor;
+    float specularStrength;
+    int shininess;
+    float padding0;
+};
+
+static_assert(sizeof(FrameUniformBlock) == 128, "FrameUniformBlock must match the std140 FrameUniforms block");
+static_assert(offsetof(FrameUniformBlock, lightDir_world) == 64 && offsetof(FrameUniformBlock, lightColor) == 80 &&
+              offsetof(FrameUniformBlock, viewPos_world) == 96 && offsetof(FrameUniformBlock, fogColor) == 112,
+              "FrameUniformBlock vec3 members must start on 16-byte boundaries");
+static_assert(sizeof(MaterialUniformBlock) == 32, "MaterialUniformBlock must match the std140 MaterialUniforms block");
+
+#endif // TERRAIN_UNIFORMS_H
@@ -11,25 +11,32 @@ uniform sampler2D textureGrass;
 uniform sampler2D textureRock;
 uniform sampler2D textureSnow;
 
-// Height thresholds
-uniform float heightRockStart;
-uniform float heightRockFull;
-uniform float heightSnowStart;
-uniform float heightSnowFull;
-uniform float textureTilingFactor;
+// Shared with the other terrain shaders; must match FrameUniformBlock (include/terrain_uniforms.h)
+layout (std140) uniform FrameUniforms {
+    mat4 viewProjection;
+    vec3 lightDir_world; // Direction OF the light rays (e.g., from sun)
+    float ambientStrength;
+    vec3 lightColor;
+    float fogDensity;    // For exponential fog
+    vec3 viewPos_world;  // Camera's position, relative to the render origin like FragPos_world
+    float padding0;
+    vec3 fogColor;
+    float padding1;
+};
 
-// Lighting uniforms
-uniform vec3 lightDir_world; // Direction OF the light rays (e.g., from sun)
-uniform vec3 lightColor;
-uniform float ambientStrength;
-uniform vec3 viewPos_world;   // Camera's position in world space
-uniform float specularStrength;
-uniform int shininess;        // Shininess factor (e.g., 32, 64, 128)
+// Height thresholds and specular response; must match MaterialUniformBlock (include/terrain_uniforms.h)
+layout (std140) uniform MaterialUniforms {
+    float heightRockStart;
+    float heightRockFull;
+    float heightSnowStart;
+    float heightSnowFull;
+    float textureTilingFactor;
+    float specularStrength;
+    int shininess;       // Shininess factor (e.g., 32, 64, 128)
+    float padding0;
+};
 
-// Fog uniforms
-uniform vec3 fogColor;
-uniform float fogDensity; // For exponential fog
-// OR, for linear fog:
+// For linear fog instead:
 // uniform float fogStart;
 // uniform float fogEnd;
 
@@ -3,22 +3,61 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
 layout (location = 2) in vec3 aNormal;
 
+// Places the chunk relative to the render origin (the camera's x/z), not the world origin. Always a pure
+// translation (Chunk::getModelMatrix, far-field tiles), so normals need no normal matrix.
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Shared with the other terrain shaders; must match FrameUniformBlock (include/terrain_uniforms.h)
+layout (std140) uniform FrameUniforms {
+    mat4 viewProjection;
+    vec3 lightDir_world; // Direction OF the light rays (e.g., from sun)
+    float ambientStrength;
+    vec3 lightColor;
+    float fogDensity;    // For exponential fog
+    vec3 viewPos_world;  // Camera's position, relative to the render origin like FragPos_world
+    float padding0;
+    vec3 fogColor;
+    float padding1;
+};
+
+// Texture-displaced chunks: aPos is a flat shared grid and the heights come from this chunk's layer.
+// Layers carry a one-texel border, so grid vertex (x, z) reads texel (x + 1, z + 1).
+uniform bool displaceFromTexture;
+uniform sampler2DArray chunkHeights;
+uniform float chunkHeightLayer;
+uniform vec2 chunkHeightRange;  // World heights of normalized 0 and 1
+uniform float gridSpacing;      // World distance between grid vertices
 
 out vec2 TexCoords;
 out float WorldPosY;
 out vec3 Normal_world;
 out vec3 FragPos_world;
 
+float fetchHeight(ivec2 texel) {
+    float normalized = texelFetch(chunkHeights, ivec3(texel, int(chunkHeightLayer)), 0).r;
+    return mix(chunkHeightRange.x, chunkHeightRange.y, normalized);
+}
+
 void main() {
-    vec4 worldPosVec4 = model * vec4(aPos, 1.0);
-    gl_Position = projection * view * worldPosVec4;
-    
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+    if (displaceFromTexture) {
+        ivec2 gridSegments = textureSize(chunkHeights, 0).xy - ivec2(3);
+        ivec2 texel = ivec2(round(aTexCoords * vec2(gridSegments))) + ivec2(1);
+        position.y = fetchHeight(texel);
+        float heightLeft  = fetchHeight(texel - ivec2(1, 0));
+        float heightRight = fetchHeight(texel + ivec2(1, 0));
+        float heightDown  = fetchHeight(texel - ivec2(0, 1));
+        float heightUp    = fetchHeight(texel + ivec2(0, 1));
+        normal = normalize(vec3(heightLeft - heightRight, 2.0 * gridSpacing, heightDown - heightUp));
+    }
+
+    vec4 worldPosVec4 = model * vec4(position, 1.0);
+    gl_Position = viewProjection * worldPosVec4;
+
     FragPos_world = vec3(worldPosVec4);
     TexCoords = aTexCoords;
     WorldPosY = FragPos_world.y;
-    
-    Normal_world = mat3(transpose(inverse(model))) * aNormal;
-}
\ No newline at end of file
+
+    Normal_world = normal;
+}
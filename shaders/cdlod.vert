@@ -0,0 +1,67 @@
+#version 330 core
+// CDLOD patch: one shared grid drawn once per selected quadtree node.
+// Outputs match basic.vert so basic.frag shades both render paths the same way.
+// Positions are relative to the render origin (the camera's x/z), see Camera::GetRenderOrigin.
+layout (location = 0) in vec2 aGridPos; // Integer grid coordinates, 0..patchSegments
+
+// Shared with the other terrain shaders; must match FrameUniformBlock (include/terrain_uniforms.h)
+layout (std140) uniform FrameUniforms {
+    mat4 viewProjection;
+    vec3 lightDir_world; // Direction OF the light rays (e.g., from sun)
+    float ambientStrength;
+    vec3 lightColor;
+    float fogDensity;    // For exponential fog
+    vec3 viewPos_world;  // Camera's position, relative to the render origin like FragPos_world
+    float padding0;
+    vec3 fogColor;
+    float padding1;
+};
+
+uniform vec4 nodeParams;          // xy = node min corner (relative to the render origin), z = node size, w = level
+uniform vec2 morphRange;          // Distances where morphing to the next coarser level starts and ends
+uniform float patchSegments;      // Grid quads per side
+uniform float textureWorldSize;   // World size covered by one material texture repeat (a chunk)
+uniform vec2 textureOrigin;       // Material texture coordinates of the render origin, wrapped to [0, 1)
+
+uniform sampler2DArray heightTiles;
+uniform vec4 tileTransform;       // Grid -> tile texel: texel = grid * z + xy; w = array layer
+uniform float tileTexelWorldSize; // World distance between two texels of the bound tile
+
+out vec2 TexCoords;
+out float WorldPosY;
+out vec3 Normal_world;
+out vec3 FragPos_world;
+
+float sampleHeight(vec2 texel) {
+    float tileTexels = patchSegments + 3.0; // One border texel on each side
+    return texture(heightTiles, vec3((texel + 0.5) / tileTexels, tileTransform.w)).r;
+}
+
+void main() {
+    float gridToWorld = nodeParams.z / patchSegments;
+    vec2 worldXZ = nodeParams.xy + aGridPos * gridToWorld;
+    float height = sampleHeight(aGridPos * tileTransform.z + tileTransform.xy);
+
+    // Slide odd vertices onto their even neighbors as the node approaches the end of its range,
+    // so at morphRange.y the patch matches the next coarser level exactly
+    float distanceToCamera = distance(viewPos_world, vec3(worldXZ.x, height, worldXZ.y));
+    float morphK = clamp((distanceToCamera - morphRange.x) / max(morphRange.y - morphRange.x, 0.0001), 0.0, 1.0);
+    vec2 oddOffset = fract(aGridPos * 0.5) * 2.0;
+    vec2 morphedGrid = aGridPos - oddOffset * morphK;
+
+    vec2 texel = morphedGrid * tileTransform.z + tileTransform.xy;
+    worldXZ = nodeParams.xy + morphedGrid * gridToWorld;
+    height = sampleHeight(texel);
+
+    // Central differences over the tile's own texel spacing
+    float heightLeft  = sampleHeight(texel - vec2(1.0, 0.0));
+    float heightRight = sampleHeight(texel + vec2(1.0, 0.0));
+    float heightDown  = sampleHeight(texel - vec2(0.0, 1.0));
+    float heightUp    = sampleHeight(texel + vec2(0.0, 1.0));
+    Normal_world = normalize(vec3(heightLeft - heightRight, 2.0 * tileTexelWorldSize, heightDown - heightUp));
+
+    FragPos_world = vec3(worldXZ.x, height, worldXZ.y);
+    WorldPosY = height;
+    TexCoords = worldXZ / textureWorldSize + textureOrigin;
+    gl_Position = viewProjection * vec4(FragPos_world, 1.0);
+}
@@ -0,0 +1,74 @@
+#version 330 core
+// Geometry clipmap level: the shared grid placed at one level's origin and spacing.
+// Outputs match basic.vert so basic.frag shades every render path the same way.
+// Positions are relative to the render origin (the camera's x/z), see Camera::GetRenderOrigin.
+layout (location = 0) in vec2 aGridPos; // Integer grid coordinates, 0..gridQuads
+
+// Shared with the other terrain shaders; must match FrameUniformBlock (include/terrain_uniforms.h)
+layout (std140) uniform FrameUniforms {
+    mat4 viewProjection;
+    vec3 lightDir_world; // Direction OF the light rays (e.g., from sun)
+    float ambientStrength;
+    vec3 lightColor;
+    float fogDensity;    // For exponential fog
+    vec3 viewPos_world;  // Camera's position, relative to the render origin like FragPos_world
+    float padding0;
+    vec3 fogColor;
+    float padding1;
+};
+
+uniform vec2 levelOrigin;        // Position of grid vertex (0, 0), relative to the render origin
+uniform vec2 levelTexelOrigin;   // Texel of grid vertex (0, 0), wrapped to twice levelTextureSize
+uniform float levelSpacing;      // World distance between grid vertices
+uniform float levelIndex;        // Texture array layer of this level
+uniform bool hasCoarserLevel;
+uniform float gridQuads;
+uniform float transitionWidth;   // Grid quads over which the outer border blends into the coarser level
+uniform float levelTextureSize;  // Texels per side of each toroidal level texture
+uniform float textureWorldSize;  // World size covered by one material texture repeat (a chunk)
+uniform vec2 textureOrigin;      // Material texture coordinates of the render origin, wrapped to [0, 1)
+
+uniform sampler2DArray heightLevels;
+
+out vec2 TexCoords;
+out float WorldPosY;
+out vec3 Normal_world;
+out vec3 FragPos_world;
+
+// Texel coordinates are world / spacing (kept small by levelTexelOrigin); GL_REPEAT wraps them into the toroidal texture
+float sampleLevel(vec2 texel, float layer) {
+    return texture(heightLevels, vec3((texel + 0.5) / levelTextureSize, layer)).r;
+}
+
+vec3 levelNormal(vec2 texel, float layer, float spacing) {
+    float heightLeft  = sampleLevel(texel - vec2(1.0, 0.0), layer);
+    float heightRight = sampleLevel(texel + vec2(1.0, 0.0), layer);
+    float heightDown  = sampleLevel(texel - vec2(0.0, 1.0), layer);
+    float heightUp    = sampleLevel(texel + vec2(0.0, 1.0), layer);
+    return normalize(vec3(heightLeft - heightRight, 2.0 * spacing, heightDown - heightUp));
+}
+
+void main() {
+    vec2 worldXZ = levelOrigin + aGridPos * levelSpacing;
+    vec2 texel = levelTexelOrigin + aGridPos;
+    float height = sampleLevel(texel, levelIndex);
+    vec3 normal = levelNormal(texel, levelIndex, levelSpacing);
+
+    if (hasCoarserLevel) {
+        // Blend towards the coarser level near the border so both agree exactly where they meet
+        vec2 fromCenter = abs(aGridPos - vec2(gridQuads * 0.5));
+        float alpha = clamp((max(fromCenter.x, fromCenter.y) - (gridQuads * 0.5 - transitionWidth)) / transitionWidth, 0.0, 1.0);
+        if (alpha > 0.0) {
+            float coarseSpacing = levelSpacing * 2.0;
+            vec2 coarseTexel = texel * 0.5;
+            height = mix(height, sampleLevel(coarseTexel, levelIndex + 1.0), alpha);
+            normal = normalize(mix(normal, levelNormal(coarseTexel, levelIndex + 1.0, coarseSpacing), alpha));
+        }
+    }
+
+    FragPos_world = vec3(worldXZ.x, height, worldXZ.y);
+    WorldPosY = height;
+    Normal_world = normal;
+    TexCoords = worldXZ / textureWorldSize + textureOrigin;
+    gl_Position = viewProjection * vec4(FragPos_world, 1.0);
+}
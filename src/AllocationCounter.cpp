@@ -0,0 +1,44 @@
+#include "AllocationCounter.h"
+
+#ifdef TERRAIN_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    thread_local uint64_t threadCount = 0;
+    std::atomic<uint64_t> totalCount(0);
+
+    void* countedAllocate(std::size_t bytes) {
+        ++threadCount;
+        totalCount.fetch_add(1, std::memory_order_relaxed);
+        void* pointer = std::malloc(bytes == 0 ? 1 : bytes);
+        if (!pointer) throw std::bad_alloc();
+        return pointer;
+    }
+}
+
+// Replacements for the global allocation functions; the nothrow and array forms forward to these by default.
+// Over-aligned allocations keep the library versions (nothing in the build path uses them).
+void* operator new(std::size_t bytes) { return countedAllocate(bytes); }
+void* operator new[](std::size_t bytes) { return countedAllocate(bytes); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace AllocationCounter {
+    bool isEnabled() { return true; }
+    uint64_t threadAllocations() { return threadCount; }
+    uint64_t totalAllocations() { return totalCount.load(std::memory_order_relaxed); }
+}
+
+#else
+
+namespace AllocationCounter {
+    bool isEnabled() { return false; }
+    uint64_t threadAllocations() { return 0; }
+    uint64_t totalAllocations() { return 0; }
+}
+
+#endif // TERRAIN_COUNT_ALLOCATIONS
@@ -1,7 +1,7 @@
 #include "Camera.h"
 #include <iostream> // For debugging
 
-Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch) 
+Camera::Camera(glm::dvec3 position, glm::vec3 up, float yaw, float pitch) 
     : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM) {
     Position = position;
     WorldUp = up;
@@ -12,7 +12,7 @@ Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
 
 Camera::Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) 
     : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM) {
-    Position = glm::vec3(posX, posY, posZ);
+    Position = glm::dvec3(posX, posY, posZ);
     WorldUp = glm::vec3(upX, upY, upZ);
     Yaw = yaw;
     Pitch = pitch;
@@ -20,23 +20,25 @@ Camera::Camera(float posX, float posY, float posZ, float upX, float upY, float u
 }
 
 glm::mat4 Camera::GetViewMatrix() {
-    return glm::lookAt(Position, Position + Front, Up);
+    glm::vec3 eye(Position - GetRenderOrigin());
+    return glm::lookAt(eye, eye + Front, Up);
 }
 
 void Camera::ProcessKeyboard(Camera_Movement direction, float deltaTime) {
     float velocity = MovementSpeed * deltaTime;
+    // Steps are accumulated in double, so small moves are not lost far from the world origin
     if (direction == FORWARD)
-        Position += Front * velocity;
+        Position += glm::dvec3(Front * velocity);
     if (direction == BACKWARD)
-        Position -= Front * velocity;
+        Position -= glm::dvec3(Front * velocity);
     if (direction == LEFT)
-        Position -= Right * velocity;
+        Position -= glm::dvec3(Right * velocity);
     if (direction == RIGHT)
-        Position += Right * velocity;
+        Position += glm::dvec3(Right * velocity);
     if (direction == UP)
-        Position += WorldUp * velocity; // Use WorldUp for consistent up/down movement
+        Position += glm::dvec3(WorldUp * velocity); // Use WorldUp for consistent up/down movement
     if (direction == DOWN)
-        Position -= WorldUp * velocity;
+        Position -= glm::dvec3(WorldUp * velocity);
 }
 
 void Camera::ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch) {
@@ -0,0 +1,215 @@
+#include "ChunkCache.h"
+#include "PerlinNoise.h"
+#include "terrain_chunk.h" // For the Chunk:: generation parameters
+#include <filesystem>
+#include <system_error>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char FILE_MAGIC[4] = { 'T', 'C', 'H', 'K' };
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        int32_t x;
+        int32_t z;
+        uint32_t heightCount; // Floats following the header
+        uint32_t reserved;
+    };
+
+    // 64-bit FNV-1a
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t hashValue(uint64_t hash, T value) {
+        return hashBytes(hash, &value, sizeof(value));
+    }
+
+    uint64_t hashNoise(const PerlinNoise& noise) {
+        const std::vector<int>& table = noise.getPermutation();
+        return hashBytes(FNV_OFFSET, table.data(), table.size() * sizeof(int));
+    }
+
+    // Bump ChunkCache::FORMAT_VERSION whenever Chunk::sampleTerrainHeight or the file layout changes
+    uint64_t hashParameters(uint64_t noiseHash) {
+        uint64_t hash = hashValue(FNV_OFFSET, static_cast<uint32_t>(ChunkCache::FORMAT_VERSION));
+        hash = hashValue(hash, noiseHash);
+        hash = hashValue(hash, Chunk::CHUNK_WORLD_SIZE_X);
+        hash = hashValue(hash, Chunk::CHUNK_WORLD_SIZE_Z);
+        hash = hashValue(hash, Chunk::CHUNK_VERTEX_RESOLUTION_X);
+        hash = hashValue(hash, Chunk::CHUNK_VERTEX_RESOLUTION_Z);
+        hash = hashValue(hash, Chunk::TERRAIN_SCALE);
+        hash = hashValue(hash, Chunk::TERRAIN_OCTAVES);
+        hash = hashValue(hash, Chunk::TERRAIN_PERSISTENCE);
+        hash = hashValue(hash, Chunk::TERRAIN_MIN_HEIGHT);
+        hash = hashValue(hash, Chunk::TERRAIN_MAX_HEIGHT);
+        hash = hashValue(hash, Chunk::TERRAIN_PEAK_EXPONENT);
+        return hash;
+    }
+
+    bool headerMatches(const FileHeader& header, uint64_t key, Vec2i coords, size_t count) {
+        return std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 &&
+               header.version == ChunkCache::FORMAT_VERSION && header.key == key &&
+               header.x == coords.x && header.z == coords.z && header.heightCount == count;
+    }
+}
+
+ChunkCache::ChunkCache() : open_(false), noiseHash_(0), key_(0) {}
+
+uint64_t ChunkCache::computeParameterKey(const PerlinNoise& noise) {
+    return hashParameters(hashNoise(noise));
+}
+
+bool ChunkCache::open(const std::string& rootDirectory, const PerlinNoise& noise) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    root_ = rootDirectory;
+    noiseHash_ = hashNoise(noise);
+    key_ = 0;
+    directory_.clear();
+    open_ = true;
+    if (!refreshKey()) {
+        open_ = false;
+        return false;
+    }
+    return true;
+}
+
+void ChunkCache::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_ = false;
+}
+
+bool ChunkCache::refreshKey() {
+    uint64_t key = hashParameters(noiseHash_);
+    if (key == key_ && !directory_.empty()) {
+        return true;
+    }
+    char keyName[17];
+    std::snprintf(keyName, sizeof(keyName), "%016llx", static_cast<unsigned long long>(key));
+    std::string directory = root_ + "/" + keyName;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "ChunkCache: cannot create " << directory << " (" << error.message() << "), cache disabled." << std::endl;
+        open_ = false;
+        return false;
+    }
+    directory_ = directory;
+    key_ = key;
+    std::cout << "ChunkCache: using " << directory_ << std::endl;
+    return true;
+}
+
+bool ChunkCache::locate(Vec2i coords, char* path, char* temporaryPath, size_t pathSize, uint64_t& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_ || !refreshKey()) {
+        return false;
+    }
+    std::snprintf(path, pathSize, "%s/%d_%d.bin", directory_.c_str(), coords.x, coords.z);
+    std::snprintf(temporaryPath, pathSize, "%s/%d_%d.tmp", directory_.c_str(), coords.x, coords.z);
+    key = key_;
+    return true;
+}
+
+bool ChunkCache::read(Vec2i coords, float* heights, size_t count) {
+    char path[1024];
+    char temporaryPath[1024];
+    uint64_t key = 0;
+    if (!locate(coords, path, temporaryPath, sizeof(path), key)) {
+        return false;
+    }
+    size_t fileBytes = sizeof(FileHeader) + count * sizeof(float);
+    bool ok = false;
+
+#ifndef _WIN32
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false; // Not cached yet
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == fileBytes) {
+        void* mapped = mmap(nullptr, fileBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            FileHeader header;
+            std::memcpy(&header, mapped, sizeof(header));
+            if (headerMatches(header, key, coords, count)) {
+                std::memcpy(heights, static_cast<const char*>(mapped) + sizeof(header), count * sizeof(float));
+                ok = true;
+            }
+            munmap(mapped, fileBytes);
+        }
+    }
+    ::close(fd);
+#else
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    FileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) == 1 && headerMatches(header, key, coords, count)) {
+        ok = std::fread(heights, sizeof(float), count, file) == count;
+    }
+    std::fclose(file);
+#endif
+
+    if (!ok) {
+        std::cerr << "ChunkCache: ignoring unusable file " << path << std::endl;
+    }
+    return ok;
+}
+
+bool ChunkCache::write(Vec2i coords, const float* heights, size_t count) {
+    char path[1024];
+    char temporaryPath[1024];
+    uint64_t key = 0;
+    if (!locate(coords, path, temporaryPath, sizeof(path), key)) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FORMAT_VERSION;
+    header.key = key;
+    header.x = coords.x;
+    header.z = coords.z;
+    header.heightCount = static_cast<uint32_t>(count);
+    header.reserved = 0;
+
+    // Write then rename, so a reader never sees a half-written file
+    FILE* file = std::fopen(temporaryPath, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(heights, sizeof(float), count, file) == count;
+    ok = std::fclose(file) == 0 && ok;
+    if (ok && std::rename(temporaryPath, path) != 0) {
+        std::remove(path); // Windows does not replace an existing file
+        ok = std::rename(temporaryPath, path) == 0;
+    }
+    if (!ok) {
+        std::remove(temporaryPath);
+        std::cerr << "ChunkCache: failed to write " << path << std::endl;
+    }
+    return ok;
+}
@@ -0,0 +1,136 @@
+#include "EvictedChunkCache.h"
+#include "terrain_chunk.h" // Complete type for the unique_ptr<Chunk> entries
+#include <functional>
+
+EvictedChunkCache::EvictedChunkCache()
+    : newest_(-1), oldest_(-1), count_(0), bytes_(0), maxBytes_(0) {}
+
+EvictedChunkCache::~EvictedChunkCache() = default;
+
+size_t EvictedChunkCache::bucketFor(Vec2i coords) const {
+    return std::hash<Vec2i>()(coords) & (table_.size() - 1);
+}
+
+int32_t EvictedChunkCache::findBucket(Vec2i coords) const {
+    if (table_.empty()) {
+        return -1;
+    }
+    for (size_t bucket = bucketFor(coords);; bucket = (bucket + 1) & (table_.size() - 1)) {
+        int32_t node = table_[bucket];
+        if (node < 0) {
+            return -1;
+        }
+        if (nodes_[node].coords == coords) {
+            return static_cast<int32_t>(bucket);
+        }
+    }
+}
+
+void EvictedChunkCache::eraseBucket(size_t bucket) {
+    // Pull later members of the probe chain back into the hole, so lookups never stop early at it
+    size_t mask = table_.size() - 1;
+    size_t hole = bucket;
+    for (size_t next = (hole + 1) & mask; table_[next] >= 0; next = (next + 1) & mask) {
+        size_t home = bucketFor(nodes_[table_[next]].coords);
+        // Movable unless its home lies cyclically in (hole, next]
+        bool homeBetween = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+        if (!homeBetween) {
+            table_[hole] = table_[next];
+            hole = next;
+        }
+    }
+    table_[hole] = -1;
+}
+
+void EvictedChunkCache::grow() {
+    size_t capacity = table_.empty() ? 64 : table_.size() * 2;
+    table_.assign(capacity, -1);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (!nodes_[i].entry.chunk && nodes_[i].entry.heights.empty()) {
+            continue; // Free node
+        }
+        size_t bucket = bucketFor(nodes_[i].coords);
+        while (table_[bucket] >= 0) {
+            bucket = (bucket + 1) & (capacity - 1);
+        }
+        table_[bucket] = static_cast<int32_t>(i);
+    }
+}
+
+void EvictedChunkCache::unlink(int32_t node) {
+    Node& n = nodes_[node];
+    if (n.newer >= 0) nodes_[n.newer].older = n.older; else newest_ = n.older;
+    if (n.older >= 0) nodes_[n.older].newer = n.newer; else oldest_ = n.newer;
+    n.newer = n.older = -1;
+}
+
+void EvictedChunkCache::removeNode(int32_t node, EvictedChunk& out) {
+    eraseBucket(static_cast<size_t>(findBucket(nodes_[node].coords)));
+    unlink(node);
+    Node& n = nodes_[node];
+    out = std::move(n.entry);
+    n.entry = EvictedChunk();
+    bytes_ -= n.bytes;
+    n.bytes = 0;
+    count_--;
+    freeNodes_.push_back(node);
+}
+
+void EvictedChunkCache::insert(Vec2i coords, EvictedChunk&& entry, size_t bytes, std::vector<EvictedChunk>& dropped) {
+    if (!entry.chunk && entry.heights.empty()) {
+        return; // Nothing worth keeping
+    }
+    int32_t existing = findBucket(coords);
+    if (existing >= 0) {
+        dropped.emplace_back();
+        removeNode(table_[existing], dropped.back());
+    }
+    if ((count_ + 1) * 2 > table_.size()) {
+        grow();
+    }
+
+    int32_t node;
+    if (!freeNodes_.empty()) {
+        node = freeNodes_.back();
+        freeNodes_.pop_back();
+    } else {
+        node = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& n = nodes_[node];
+    n.coords = coords;
+    n.entry = std::move(entry);
+    n.bytes = bytes;
+    n.older = newest_;
+    n.newer = -1;
+    if (newest_ >= 0) nodes_[newest_].newer = node; else oldest_ = node;
+    newest_ = node;
+    size_t bucket = bucketFor(coords);
+    while (table_[bucket] >= 0) {
+        bucket = (bucket + 1) & (table_.size() - 1);
+    }
+    table_[bucket] = node;
+    count_++;
+    bytes_ += bytes;
+
+    while (bytes_ > maxBytes_ && oldest_ >= 0) {
+        dropped.emplace_back();
+        removeNode(oldest_, dropped.back());
+    }
+}
+
+bool EvictedChunkCache::take(Vec2i coords, EvictedChunk& out) {
+    int32_t bucket = findBucket(coords);
+    if (bucket < 0) {
+        return false;
+    }
+    removeNode(table_[bucket], out);
+    return true;
+}
+
+void EvictedChunkCache::clear(std::vector<EvictedChunk>& dropped) {
+    while (oldest_ >= 0) {
+        dropped.emplace_back();
+        removeNode(oldest_, dropped.back());
+    }
+}
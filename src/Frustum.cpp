@@ -1,6 +1,13 @@
 #include "Frustum.h"
 #include <vector> // For AABB corners
 
+// The vector kernels are compiled for AVX2 / AVX-512 with function attributes and picked at run time, so the
+// build needs no -m flags and still runs on CPUs without them
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FRUSTUM_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 void Frustum::update(const glm::mat4& vpMatrix) {
     // Left Plane
     planes[0].normal.x = vpMatrix[0][3] + vpMatrix[0][0];
@@ -44,6 +51,14 @@ void Frustum::update(const glm::mat4& vpMatrix) {
     }
 }
 
+void Frustum::update(const glm::mat4& relativeViewProjectionMatrix, const glm::dvec3& renderOrigin) {
+    update(relativeViewProjectionMatrix);
+    // N.(X - origin) + D = 0  =>  N.X + (D - N.origin) = 0
+    for (int i = 0; i < 6; ++i) {
+        planes[i].distance = static_cast<float>(planes[i].distance - glm::dot(glm::dvec3(planes[i].normal), renderOrigin));
+    }
+}
+
 // Check if an AABB is visible (AABB vs Frustum intersection test)
 // This is a common conservative test: if all 8 corners of AABB are outside any single plane, it's culled.
 // A more accurate test (sphere vs frustum, or separating axis theorem for AABB) can be used.
@@ -67,4 +82,191 @@ bool Frustum::isAABBVisible(const BoundingBox& bbox) const {
         }
     }
     return true; // AABB is intersecting or inside all planes
-}
\ No newline at end of file
+}
+
+FrustumTest Frustum::classifyAABB(const BoundingBox& bbox, unsigned& planeMask) const {
+    for (int i = 0; i < 6; ++i) {
+        if (!(planeMask & (1u << i))) {
+            continue; // An enclosing box is already inside this plane
+        }
+        // p-vertex as in isAABBVisible; the n-vertex is the opposite corner, nearest the outside
+        glm::vec3 pVertex = bbox.min;
+        glm::vec3 nVertex = bbox.max;
+        if (planes[i].normal.x >= 0) { pVertex.x = bbox.max.x; nVertex.x = bbox.min.x; }
+        if (planes[i].normal.y >= 0) { pVertex.y = bbox.max.y; nVertex.y = bbox.min.y; }
+        if (planes[i].normal.z >= 0) { pVertex.z = bbox.max.z; nVertex.z = bbox.min.z; }
+
+        if (planes[i].getSignedDistanceToPoint(pVertex) < 0) {
+            return FrustumTest::Outside;
+        }
+        if (planes[i].getSignedDistanceToPoint(nVertex) >= 0) {
+            planeMask &= ~(1u << i); // Wholly on the inside of this plane
+        }
+    }
+    return planeMask == 0 ? FrustumTest::Inside : FrustumTest::Intersecting;
+}
+
+namespace {
+
+// A frustum plane as the batch kernels use it: the distance includes the batch offset, and per axis px/py/pz
+// point at the stream holding the p-vertex coordinate (the max bound where the normal is non-negative)
+struct BatchPlane {
+    float nx, ny, nz, d;
+    const float* px;
+    const float* py;
+    const float* pz;
+};
+
+inline int firstPlane(uint8_t hint) { return hint < 6 ? hint : 0; }
+inline int nextPlane(int start, int k) { return start + k < 6 ? start + k : start + k - 6; }
+
+// Boxes [begin, end) one at a time: the Scalar backend, and the tails the vector kernels leave
+size_t cullBatchScalar(const BatchPlane planes[6], uint8_t* hints, size_t begin, size_t end, uint32_t* visibleIndices) {
+    size_t visible = 0;
+    for (size_t i = begin; i < end; ++i) {
+        int start = firstPlane(hints[i]);
+        bool inside = true;
+        for (int k = 0; k < 6; ++k) {
+            int p = nextPlane(start, k);
+            const BatchPlane& plane = planes[p];
+            if (plane.nx * plane.px[i] + plane.ny * plane.py[i] + plane.nz * plane.pz[i] + plane.d < 0.0f) {
+                hints[i] = static_cast<uint8_t>(p);
+                inside = false;
+                break;
+            }
+        }
+        if (inside) {
+            visibleIndices[visible++] = static_cast<uint32_t>(i);
+        }
+    }
+    return visible;
+}
+
+#ifdef FRUSTUM_X86_SIMD
+// 8 boxes per step. A group starts with its first box's hint (neighbouring boxes are usually rejected by the
+// same plane) and stops as soon as every lane is outside.
+__attribute__((target("avx2")))
+size_t cullBatchAvx2(const BatchPlane planes[6], uint8_t* hints, size_t count, uint32_t* visibleIndices) {
+    size_t visible = 0;
+    size_t i = 0;
+    const __m256 zero = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        int start = firstPlane(hints[i]);
+        unsigned outside = 0;
+        for (int k = 0; k < 6 && outside != 0xFFu; ++k) {
+            int p = nextPlane(start, k);
+            const BatchPlane& plane = planes[p];
+            __m256 dist = _mm256_mul_ps(_mm256_set1_ps(plane.nx), _mm256_loadu_ps(plane.px + i));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_set1_ps(plane.ny), _mm256_loadu_ps(plane.py + i)));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_set1_ps(plane.nz), _mm256_loadu_ps(plane.pz + i)));
+            dist = _mm256_add_ps(dist, _mm256_set1_ps(plane.d));
+            unsigned rejected = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(dist, zero, _CMP_LT_OQ))) & ~outside;
+            outside |= rejected;
+            for (; rejected != 0; rejected &= rejected - 1) {
+                hints[i + __builtin_ctz(rejected)] = static_cast<uint8_t>(p);
+            }
+        }
+        for (unsigned inside = ~outside & 0xFFu; inside != 0; inside &= inside - 1) {
+            visibleIndices[visible++] = static_cast<uint32_t>(i + __builtin_ctz(inside));
+        }
+    }
+    return visible + cullBatchScalar(planes, hints, i, count, visibleIndices + visible);
+}
+
+// 16 boxes per step, as cullBatchAvx2; the visible indices are written with one compress-store
+__attribute__((target("avx512f")))
+size_t cullBatchAvx512(const BatchPlane planes[6], uint8_t* hints, size_t count, uint32_t* visibleIndices) {
+    size_t visible = 0;
+    size_t i = 0;
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    for (; i + 16 <= count; i += 16) {
+        int start = firstPlane(hints[i]);
+        unsigned outside = 0;
+        for (int k = 0; k < 6 && outside != 0xFFFFu; ++k) {
+            int p = nextPlane(start, k);
+            const BatchPlane& plane = planes[p];
+            __m512 dist = _mm512_mul_ps(_mm512_set1_ps(plane.nx), _mm512_loadu_ps(plane.px + i));
+            dist = _mm512_add_ps(dist, _mm512_mul_ps(_mm512_set1_ps(plane.ny), _mm512_loadu_ps(plane.py + i)));
+            dist = _mm512_add_ps(dist, _mm512_mul_ps(_mm512_set1_ps(plane.nz), _mm512_loadu_ps(plane.pz + i)));
+            dist = _mm512_add_ps(dist, _mm512_set1_ps(plane.d));
+            unsigned rejected = static_cast<unsigned>(_mm512_cmp_ps_mask(dist, zero, _CMP_LT_OQ)) & ~outside;
+            outside |= rejected;
+            for (; rejected != 0; rejected &= rejected - 1) {
+                hints[i + __builtin_ctz(rejected)] = static_cast<uint8_t>(p);
+            }
+        }
+        __mmask16 inside = static_cast<__mmask16>(~outside & 0xFFFFu);
+        __m512i indices = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(i)), lanes);
+        _mm512_mask_compressstoreu_epi32(visibleIndices + visible, inside, indices);
+        visible += static_cast<size_t>(__builtin_popcount(inside));
+    }
+    return visible + cullBatchScalar(planes, hints, i, count, visibleIndices + visible);
+}
+#endif // FRUSTUM_X86_SIMD
+
+CullBackend& activeCullBackend() {
+    static CullBackend backend = Frustum::bestCullBackend();
+    return backend;
+}
+
+} // namespace
+
+size_t Frustum::cullBatch(AABBBatch& boxes, uint32_t* visibleIndices, const glm::vec3& offset) const {
+    size_t count = boxes.size();
+    if (count == 0) {
+        return 0;
+    }
+    if (boxes.planeHint.size() != count) {
+        boxes.planeHint.assign(count, 0);
+    }
+    // Moving every box by offset is the same as moving the planes by -offset
+    BatchPlane batchPlanes[6];
+    for (int i = 0; i < 6; ++i) {
+        const glm::vec3& n = planes[i].normal;
+        batchPlanes[i].nx = n.x;
+        batchPlanes[i].ny = n.y;
+        batchPlanes[i].nz = n.z;
+        batchPlanes[i].d = planes[i].distance + glm::dot(n, offset);
+        batchPlanes[i].px = n.x >= 0 ? boxes.maxX.data() : boxes.minX.data();
+        batchPlanes[i].py = n.y >= 0 ? boxes.maxY.data() : boxes.minY.data();
+        batchPlanes[i].pz = n.z >= 0 ? boxes.maxZ.data() : boxes.minZ.data();
+    }
+    uint8_t* hints = boxes.planeHint.data();
+    switch (activeCullBackend()) {
+#ifdef FRUSTUM_X86_SIMD
+    case CullBackend::AVX512:
+        return cullBatchAvx512(batchPlanes, hints, count, visibleIndices);
+    case CullBackend::AVX2:
+        return cullBatchAvx2(batchPlanes, hints, count, visibleIndices);
+#endif
+    default:
+        return cullBatchScalar(batchPlanes, hints, 0, count, visibleIndices);
+    }
+}
+
+CullBackend Frustum::bestCullBackend() {
+#ifdef FRUSTUM_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return CullBackend::AVX512;
+    if (__builtin_cpu_supports("avx2")) return CullBackend::AVX2;
+#endif
+    return CullBackend::Scalar;
+}
+
+void Frustum::setCullBackend(CullBackend backend) {
+    CullBackend best = bestCullBackend();
+    activeCullBackend() = static_cast<int>(backend) > static_cast<int>(best) ? best : backend;
+}
+
+CullBackend Frustum::getCullBackend() {
+    return activeCullBackend();
+}
+
+const char* Frustum::cullBackendName(CullBackend backend) {
+    switch (backend) {
+    case CullBackend::AVX512: return "AVX-512";
+    case CullBackend::AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
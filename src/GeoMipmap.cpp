@@ -0,0 +1,173 @@
+#include "GeoMipmap.h"
+#include "HeightMap.h"
+#include <iostream>
+#include <algorithm> // For std::max
+#include <cmath>     // For std::abs
+
+GeoMipmapIndexSet::GeoMipmapIndexSet()
+    : width_(0), depth_(0), levelCount_(0), indexType_(GL_UNSIGNED_INT), EBO_(0) {}
+
+GeoMipmapIndexSet::~GeoMipmapIndexSet() {
+    clearGPUData();
+}
+
+void GeoMipmapIndexSet::buildLevelTriangles(int width, int depth, int level, int stitchMask, std::vector<unsigned int>& out) {
+    out.clear();
+    int step = 1 << level;
+    int last = width - 1;
+    int coarseStep = step * 2;
+
+    // On a stitched edge the neighbor only has every (2 * step)-th vertex. Odd vertices on that edge are
+    // snapped onto an adjacent even one, which collapses one triangle per pair of quads and turns the
+    // other two into a fan whose outer edge is exactly the neighbor's coarse edge. The +Z edge snaps
+    // forward so the +X/+Z corner does not fold across the TR-BL diagonal.
+    auto vertexIndex = [&](int x, int z) -> unsigned int {
+        if ((stitchMask & EDGE_NEG_Z) && z == 0 && (x % coarseStep) != 0) x -= step;
+        if ((stitchMask & EDGE_POS_Z) && z == last && (x % coarseStep) != 0) x += step;
+        if ((stitchMask & EDGE_NEG_X) && x == 0 && (z % coarseStep) != 0) z -= step;
+        if ((stitchMask & EDGE_POS_X) && x == last && (z % coarseStep) != 0) z -= step;
+        return static_cast<unsigned int>(z * width + x);
+    };
+    auto emit = [&](unsigned int a, unsigned int b, unsigned int c) {
+        if (a == b || b == c || a == c) return; // Collapsed by stitching
+        // Guard against zero-area triangles left by snapping
+        long ax = a % width, az = a / width;
+        long cross = (static_cast<long>(b % width) - ax) * (static_cast<long>(c / width) - az) -
+                     (static_cast<long>(b / width) - az) * (static_cast<long>(c % width) - ax);
+        if (cross == 0) return;
+        out.push_back(a);
+        out.push_back(b);
+        out.push_back(c);
+    };
+
+    for (int z_coord = 0; z_coord < depth - 1; z_coord += step) {
+        for (int x_coord = 0; x_coord < width - 1; x_coord += step) {
+            unsigned int topLeft = vertexIndex(x_coord, z_coord);
+            unsigned int topRight = vertexIndex(x_coord + step, z_coord);
+            unsigned int bottomLeft = vertexIndex(x_coord, z_coord + step);
+            unsigned int bottomRight = vertexIndex(x_coord + step, z_coord + step);
+
+            // Same diagonal and winding as the full-resolution mesh
+            emit(topLeft, bottomLeft, topRight);
+            emit(topRight, bottomLeft, bottomRight);
+        }
+    }
+}
+
+bool GeoMipmapIndexSet::build(int width, int depth, int cacheSize) {
+    clearGPUData();
+    ranges_.clear();
+    indices16_.clear();
+    indices32_.clear();
+    levelCount_ = 0;
+
+    int segments = width - 1;
+    if (width != depth || segments < 1 || (segments & (segments - 1)) != 0) {
+        std::cerr << "GeoMipmapIndexSet: grid " << width << "x" << depth
+                  << " is not (2^n + 1)^2, geomipmapping disabled." << std::endl;
+        return false;
+    }
+    width_ = width;
+    depth_ = depth;
+    int levels = 1;
+    while ((1 << (levels - 1)) < segments) ++levels;
+
+    size_t vertexCount = static_cast<size_t>(width) * depth;
+    bool use16Bit = vertexCount <= IndexOptimizer::RESTART_INDEX_16 + 1;
+    indexType_ = use16Bit ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    size_t indexSize = use16Bit ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    ranges_.resize(static_cast<size_t>(levels) * STITCH_VARIANTS);
+    std::vector<unsigned int> triangles;
+    std::vector<unsigned int> ordered;
+    for (int level = 0; level < levels; ++level) {
+        for (int mask = 0; mask < STITCH_VARIANTS; ++mask) {
+            // The coarsest level has no coarser neighbor to stitch to
+            int effectiveMask = (level == levels - 1) ? 0 : mask;
+            buildLevelTriangles(width, depth, level, effectiveMask, triangles);
+            IndexOptimizer::optimizeTipsify(triangles, vertexCount, cacheSize, ordered);
+
+            Range& range = ranges_[level * STITCH_VARIANTS + mask];
+            size_t first = use16Bit ? indices16_.size() : indices32_.size();
+            range.byteOffset = first * indexSize;
+            range.count = static_cast<GLsizei>(ordered.size());
+            range.triangleCount = ordered.size() / 3;
+            for (unsigned int index : ordered) {
+                if (use16Bit) indices16_.push_back(static_cast<uint16_t>(index));
+                else indices32_.push_back(index);
+            }
+        }
+    }
+    levelCount_ = levels;
+
+    std::cout << "GeoMipmapIndexSet built for " << width << "x" << depth << ": " << levels << " levels x "
+              << STITCH_VARIANTS << " stitch variants, "
+              << (use16Bit ? indices16_.size() * sizeof(uint16_t) : indices32_.size() * sizeof(uint32_t))
+              << " index bytes." << std::endl;
+    return true;
+}
+
+void GeoMipmapIndexSet::setupGPU() {
+    if (!isValid() || EBO_ != 0) return;
+    glGenBuffers(1, &EBO_);
+    // Bind outside of any VAO so no chunk's VAO state is disturbed
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_);
+    if (indexType_ == GL_UNSIGNED_SHORT) {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices16_.size() * sizeof(uint16_t), indices16_.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices32_.size() * sizeof(uint32_t), indices32_.data(), GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    indices16_.clear();
+    indices16_.shrink_to_fit();
+    indices32_.clear();
+    indices32_.shrink_to_fit();
+}
+
+void GeoMipmapIndexSet::clearGPUData() {
+    if (EBO_ != 0) {
+        glDeleteBuffers(1, &EBO_);
+        EBO_ = 0;
+    }
+}
+
+const GeoMipmapIndexSet::Range& GeoMipmapIndexSet::getRange(int level, int stitchMask) const {
+    level = std::max(0, std::min(level, levelCount_ - 1));
+    return ranges_[level * STITCH_VARIANTS + (stitchMask & (STITCH_VARIANTS - 1))];
+}
+
+void computeGeoMipmapLevelErrors(const HeightMap& heightMap, int levelCount, float* outErrors) {
+    if (levelCount <= 0) return;
+    outErrors[0] = 0.0f;
+    int width = heightMap.getWidth();
+    int depth = heightMap.getDepth();
+
+    for (int level = 1; level < levelCount; ++level) {
+        int step = 1 << level;
+        if (step > width - 1 || step > depth - 1) {
+            outErrors[level] = outErrors[level - 1];
+            continue;
+        }
+        float maxError = outErrors[level - 1];
+        for (int z = 0; z < depth; ++z) {
+            for (int x = 0; x < width; ++x) {
+                if (x % step == 0 && z % step == 0) continue;
+                int x0 = std::min((x / step) * step, width - 1 - step);
+                int z0 = std::min((z / step) * step, depth - 1 - step);
+                float u = static_cast<float>(x - x0) / step;
+                float v = static_cast<float>(z - z0) / step;
+                float hTL = heightMap.getHeight(x0, z0);
+                float hTR = heightMap.getHeight(x0 + step, z0);
+                float hBL = heightMap.getHeight(x0, z0 + step);
+                float hBR = heightMap.getHeight(x0 + step, z0 + step);
+                // Interpolate on the same triangle split the index set uses (diagonal TR-BL)
+                float approx = (u + v <= 1.0f)
+                    ? hTL + u * (hTR - hTL) + v * (hBL - hTL)
+                    : hBR + (1.0f - u) * (hBL - hBR) + (1.0f - v) * (hTR - hBR);
+                maxError = std::max(maxError, std::abs(approx - heightMap.getHeight(x, z)));
+            }
+        }
+        outErrors[level] = maxError;
+    }
+}
@@ -6,11 +6,12 @@
 #include <cmath> // For std::pow
 #include <iostream>  // For std::cerr (if using warning)
 
-HeightMap::HeightMap(int width, int depth) : width_(width), depth_(depth) {
+HeightMap::HeightMap(int width, int depth, ScratchArena* arena)
+    : width_(width), depth_(depth), heights_(ArenaAllocator<float>(arena)) {
     if (width <= 0 || depth <= 0) {
         throw std::invalid_argument("HeightMap dimensions must be positive.");
     }
-    heights_.resize(width, std::vector<float>(depth, 0.0f));
+    heights_.assign(static_cast<size_t>(width) * depth, 0.0f);
     srand(static_cast<unsigned int>(time(nullptr)));
 }
 
@@ -24,7 +25,7 @@ void HeightMap::generateRandomHeights(float minHeight, float maxHeight) {
     for (int x = 0; x < width_; ++x) {
         for (int z = 0; z < depth_; ++z) {
             float randomValue = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-            heights_[x][z] = minHeight + randomValue * (maxHeight - minHeight);
+            heights_[z * width_ + x] = minHeight + randomValue * (maxHeight - minHeight);
         }
     }
 }
@@ -54,7 +55,7 @@ void HeightMap::generatePerlinHeights(const PerlinNoise& pn,
             perlinValue = std::max(0.0, std::min(1.0, perlinValue));
 
 
-            heights_[x][z] = static_cast<float>(overallMinHeight + perlinValue * (overallMaxHeight - overallMinHeight));
+            heights_[z * width_ + x] = static_cast<float>(overallMinHeight + perlinValue * (overallMaxHeight - overallMinHeight));
         }
     }
 }
@@ -63,7 +64,7 @@ void HeightMap::smoothHeights(int iterations, int kernelSize) {
     if (width_ <= 0 || depth_ <= 0 || kernelSize < 0) return;
 
     for (int iter = 0; iter < iterations; ++iter) {
-        std::vector<std::vector<float>> smoothedHeights = heights_; 
+        ScratchVector<float> smoothedHeights = heights_; 
 
         for (int r = 0; r < width_; ++r) { // Renamed x to r to avoid conflict
             for (int c = 0; c < depth_; ++c) { // Renamed z to c to avoid conflict
@@ -74,13 +75,13 @@ void HeightMap::smoothHeights(int iterations, int kernelSize) {
                         int nx = r + i;
                         int nz = c + j;
                         if (nx >= 0 && nx < width_ && nz >= 0 && nz < depth_) {
-                            sum += heights_[nx][nz]; 
+                            sum += heights_[nz * width_ + nx]; 
                             count++;
                         }
                     }
                 }
                 if (count > 0) {
-                    smoothedHeights[r][c] = sum / count;
+                    smoothedHeights[c * width_ + r] = sum / count;
                 }
             }
         }
@@ -92,7 +93,7 @@ float HeightMap::getHeight(int x, int z) const {
     if (x < 0 || x >= width_ || z < 0 || z >= depth_) {
         throw std::out_of_range("HeightMap coordinates out of bounds in getHeight.");
     }
-    return heights_[x][z];
+    return heights_[z * width_ + x];
 }
 
 void HeightMap::setHeight(int x, int z, float height) {
@@ -105,13 +106,7 @@ void HeightMap::setHeight(int x, int z, float height) {
                   << x << ", " << z << "). Value not set." << std::endl;
         return;
     }
-    // Ensure internal vector structure is valid (it should be if constructor ran correctly)
-    if (static_cast<size_t>(x) >= heights_.size() || static_cast<size_t>(z) >= heights_[x].size()) {
-         std::cerr << "Warning: HeightMap internal structure not properly initialized for setHeight("
-                   << x << ", " << z << ")." << std::endl;
-        return;
-    }
-    heights_[x][z] = height;
+    heights_[z * width_ + x] = height;
 }
 
 int HeightMap::getWidth() const {
@@ -121,7 +116,3 @@ int HeightMap::getWidth() const {
 int HeightMap::getDepth() const {
     return depth_;
 }
-
-const std::vector<std::vector<float>>& HeightMap::getHeights() const {
-    return heights_;
-}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "HeightTextureArray.h"
+#include <iostream>
+#include <algorithm> // For std::copy, std::min, std::max
+
+HeightTextureArray::HeightTextureArray()
+    : texture_(0), width_(0), depth_(0), capacity_(0), maxLayers_(0), layersInUse_(0), reportedFull_(false) {}
+
+HeightTextureArray::~HeightTextureArray() {
+    if (texture_ != 0) {
+        glDeleteTextures(1, &texture_);
+    }
+}
+
+void HeightTextureArray::configure(int width, int depth, int initialCapacity) {
+    if (texture_ != 0) {
+        glDeleteTextures(1, &texture_);
+        texture_ = 0;
+    }
+    width_ = width;
+    depth_ = depth;
+    capacity_ = 0;
+    layersInUse_ = 0;
+    reportedFull_ = false;
+    freeLayers_.clear();
+    shadow_.clear();
+
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    maxLayers_ = maxLayers > 0 ? maxLayers : 256; // 256 is the least OpenGL 3.3 guarantees
+    if (initialCapacity > maxLayers_) {
+        std::cout << "HeightTextureArray: " << initialCapacity << " layers requested, the GPU allows " << maxLayers_
+                  << "; chunks beyond that are not drawn with --mesher displaced." << std::endl;
+    }
+    reallocate(std::min(std::max(1, initialCapacity), maxLayers_));
+}
+
+bool HeightTextureArray::reallocate(int newCapacity) {
+    if (texture_ == 0) {
+        glGenTextures(1, &texture_);
+    }
+
+    for (int i = 0; i < 16 && glGetError() != GL_NO_ERROR; ++i) {} // Only the allocation's own error below counts
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16, width_, depth_, newCapacity, 0, GL_RED, GL_UNSIGNED_SHORT, nullptr);
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        std::cerr << "HeightTextureArray: allocating " << newCapacity << " layers failed (GL error 0x" << std::hex << error << std::dec
+                  << "), keeping " << capacity_ << "." << std::endl;
+        if (capacity_ > 0) {
+            // The failed call may have dropped the old storage: specify it again and restore its layers
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16, width_, depth_, capacity_, 0, GL_RED, GL_UNSIGNED_SHORT, nullptr);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, width_, depth_, capacity_, GL_RED, GL_UNSIGNED_SHORT, shadow_.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return false;
+    }
+    shadow_.resize(static_cast<size_t>(newCapacity) * width_ * depth_, 0);
+    // Heights are fetched per texel, never filtered
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2); // Rows of 16-bit texels need not be 4-byte aligned
+    if (capacity_ > 0) {
+        // Restore the layers that existed before the resize
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, width_, depth_, capacity_, GL_RED, GL_UNSIGNED_SHORT, shadow_.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    for (int layer = newCapacity - 1; layer >= capacity_; --layer) {
+        freeLayers_.push_back(layer);
+    }
+    if (capacity_ > 0) {
+        std::cout << "HeightTextureArray grown from " << capacity_ << " to " << newCapacity << " layers." << std::endl;
+    }
+    capacity_ = newCapacity;
+    return true;
+}
+
+int HeightTextureArray::allocate() {
+    if (!isConfigured()) {
+        std::cerr << "HeightTextureArray::allocate() called before configure()." << std::endl;
+        return -1;
+    }
+    if (freeLayers_.empty()) {
+        int newCapacity = std::min(capacity_ * 2, maxLayers_);
+        if (newCapacity <= capacity_ || !reallocate(newCapacity)) {
+            if (!reportedFull_) {
+                std::cerr << "HeightTextureArray: all " << capacity_ << " layers are in use (GPU limit " << maxLayers_
+                          << "); further displaced chunks are not drawn." << std::endl;
+                reportedFull_ = true;
+            }
+            return -1;
+        }
+    }
+    int layer = freeLayers_.back();
+    freeLayers_.pop_back();
+    layersInUse_++;
+    return layer;
+}
+
+void HeightTextureArray::upload(int layer, const std::vector<uint16_t>& texels) {
+    size_t layerTexels = static_cast<size_t>(width_) * depth_;
+    if (layer < 0 || layer >= capacity_ || texels.size() != layerTexels) {
+        std::cerr << "HeightTextureArray::upload(): bad layer " << layer << " or texel count " << texels.size() << std::endl;
+        return;
+    }
+    std::copy(texels.begin(), texels.end(), shadow_.begin() + layer * layerTexels);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width_, depth_, 1, GL_RED, GL_UNSIGNED_SHORT, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void HeightTextureArray::release(int layer) {
+    if (layer < 0 || layer >= capacity_) {
+        return;
+    }
+    freeLayers_.push_back(layer);
+    layersInUse_--;
+}
+
+void HeightTextureArray::bind(int textureUnit) const {
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,329 @@
+#include "IndexOptimizer.h"
+#include "ScratchArena.h"
+#include <algorithm> // For std::min, std::max
+#include <type_traits>
+
+// buildIndexBuffer builds triangle lists straight into the 32-bit stream
+static_assert(std::is_same<unsigned int, uint32_t>::value, "IndexOptimizer assumes 32-bit unsigned int indices");
+
+void IndexBuffer::clear() {
+    indices16.clear();
+    indices16.shrink_to_fit();
+    indices32.clear();
+    indices32.shrink_to_fit();
+    clusterRanges.clear();
+    clusterRanges.shrink_to_fit();
+}
+
+namespace IndexOptimizer {
+
+int gridStripeWidth(int cacheSize) {
+    // A top vertex of a stripe row was loaded as a bottom vertex of the previous row. Between that load and
+    // its reuse, the rest of the previous row and the start of this row are loaded, and because the
+    // triangle order interleaves top and bottom vertices both rows of k+1 vertices must fit in the cache.
+    return std::max(1, cacheSize / 2 - 1);
+}
+
+// Triangles of the quads [quadX0, quadX1) x [quadZ0, quadZ1), walked in vertical stripes of stripeQuads
+static void appendGridTriangles(int width, int quadX0, int quadX1, int quadZ0, int quadZ1, int stripeQuads,
+                                std::vector<unsigned int>& out) {
+    int quadsX = quadX1 - quadX0;
+    if (stripeQuads <= 0 || stripeQuads > quadsX) stripeQuads = quadsX;
+    for (int stripeStart = quadX0; stripeStart < quadX1; stripeStart += stripeQuads) {
+        int stripeEnd = std::min(stripeStart + stripeQuads, quadX1);
+        for (int z_coord = quadZ0; z_coord < quadZ1; ++z_coord) {
+            for (int x_coord = stripeStart; x_coord < stripeEnd; ++x_coord) {
+                unsigned int topLeft = z_coord * width + x_coord;
+                unsigned int topRight = topLeft + 1;
+                unsigned int bottomLeft = (z_coord + 1) * width + x_coord;
+                unsigned int bottomRight = bottomLeft + 1;
+
+                out.push_back(topLeft);
+                out.push_back(bottomLeft);
+                out.push_back(topRight);
+
+                out.push_back(topRight);
+                out.push_back(bottomLeft);
+                out.push_back(bottomRight);
+            }
+        }
+    }
+}
+
+// Strips for the same quads, one per stripe row; a restart index separates them from whatever 'out' already holds
+static void appendGridStrips(int width, int quadX0, int quadX1, int quadZ0, int quadZ1, int stripeQuads,
+                             uint32_t restartIndex, std::vector<uint32_t>& out) {
+    int quadsX = quadX1 - quadX0;
+    if (stripeQuads <= 0 || stripeQuads > quadsX) stripeQuads = quadsX;
+    for (int stripeStart = quadX0; stripeStart < quadX1; stripeStart += stripeQuads) {
+        int stripeEnd = std::min(stripeStart + stripeQuads, quadX1);
+        for (int z_coord = quadZ0; z_coord < quadZ1; ++z_coord) {
+            if (!out.empty()) out.push_back(restartIndex);
+            // t0, b0, t1, b1, ... gives (t0,b0,t1), (t1,b0,b1), ... which is the triangle-list winding.
+            for (int x_coord = stripeStart; x_coord <= stripeEnd; ++x_coord) {
+                out.push_back(static_cast<uint32_t>(z_coord * width + x_coord));
+                out.push_back(static_cast<uint32_t>((z_coord + 1) * width + x_coord));
+            }
+        }
+    }
+}
+
+void buildGridTriangles(int width, int depth, int stripeQuads, std::vector<unsigned int>& out) {
+    out.clear();
+    if (width < 2 || depth < 2) return;
+    out.reserve(static_cast<size_t>(width - 1) * (depth - 1) * 6);
+    appendGridTriangles(width, 0, width - 1, 0, depth - 1, stripeQuads, out);
+}
+
+void buildGridStrips(int width, int depth, int stripeQuads, uint32_t restartIndex, std::vector<uint32_t>& out) {
+    out.clear();
+    if (width < 2 || depth < 2) return;
+    int quadsX = width - 1;
+    if (stripeQuads <= 0 || stripeQuads > quadsX) stripeQuads = quadsX;
+    int stripeCount = (quadsX + stripeQuads - 1) / stripeQuads;
+    out.reserve(static_cast<size_t>(depth - 1) * (2 * (quadsX + stripeCount) + stripeCount));
+    appendGridStrips(width, 0, quadsX, 0, depth - 1, stripeQuads, restartIndex, out);
+}
+
+void buildGridClusters(int width, int depth, int clusterQuads, int stripeQuads, bool strips, uint32_t restartIndex,
+                       std::vector<uint32_t>& out, std::vector<IndexRange>& ranges) {
+    out.clear();
+    ranges.clear();
+    if (width < 2 || depth < 2) return;
+    int quadsX = width - 1;
+    int quadsZ = depth - 1;
+    if (clusterQuads <= 0) clusterQuads = std::max(quadsX, quadsZ);
+    // Upper bounds: every quad as 6 list indices, or 2 strip indices plus one restart per stripe row
+    out.reserve(static_cast<size_t>(quadsX) * quadsZ * 6);
+    ranges.reserve(static_cast<size_t>((quadsX + clusterQuads - 1) / clusterQuads) * ((quadsZ + clusterQuads - 1) / clusterQuads));
+
+    for (int clusterZ = 0; clusterZ < quadsZ; clusterZ += clusterQuads) {
+        for (int clusterX = 0; clusterX < quadsX; clusterX += clusterQuads) {
+            int endX = std::min(clusterX + clusterQuads, quadsX);
+            int endZ = std::min(clusterZ + clusterQuads, quadsZ);
+            if (strips) {
+                appendGridStrips(width, clusterX, endX, clusterZ, endZ, stripeQuads, restartIndex, out);
+            } else {
+                appendGridTriangles(width, clusterX, endX, clusterZ, endZ, stripeQuads, out);
+            }
+            // A cluster's strips start after the restart that separates it from the previous cluster
+            IndexRange range;
+            range.first = ranges.empty() ? 0 : ranges.back().first + ranges.back().count + (strips ? 1 : 0);
+            range.count = static_cast<uint32_t>(out.size()) - range.first;
+            range.quadX0 = clusterX;
+            range.quadZ0 = clusterZ;
+            range.quadX1 = endX;
+            range.quadZ1 = endZ;
+            ranges.push_back(range);
+        }
+    }
+}
+
+void optimizeTipsify(const std::vector<unsigned int>& in, size_t vertexCount, int cacheSize, std::vector<unsigned int>& out) {
+    out.clear();
+    size_t triangleCount = in.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return;
+    out.reserve(triangleCount * 3);
+
+    // Vertex -> triangle adjacency in CSR form. All working arrays are scratch memory of this thread.
+    ScratchArena::Scope scratch(ScratchArena::forThread());
+    ArenaAllocator<unsigned int> uintAllocator(&scratch.arena());
+    ScratchVector<unsigned int> liveTriangles(vertexCount, 0, uintAllocator);
+    for (size_t i = 0; i < triangleCount * 3; ++i) liveTriangles[in[i]]++;
+    ScratchVector<unsigned int> adjacencyOffset(vertexCount + 1, 0, uintAllocator);
+    for (size_t v = 0; v < vertexCount; ++v) adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+    ScratchVector<unsigned int> adjacency(adjacencyOffset[vertexCount], 0, uintAllocator);
+    ScratchVector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1, uintAllocator);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) adjacency[fill[in[t * 3 + k]]++] = static_cast<unsigned int>(t);
+    }
+
+    ScratchVector<int> cacheTime(vertexCount, 0, ArenaAllocator<int>(&scratch.arena()));
+    ScratchVector<char> emitted(triangleCount, 0, ArenaAllocator<char>(&scratch.arena()));
+    // Each emitted vertex is pushed once, and a fan never yields more candidates than it emits
+    ScratchVector<unsigned int> deadEnd(uintAllocator);
+    deadEnd.reserve(triangleCount * 3);
+    ScratchVector<unsigned int> candidates(uintAllocator);
+    candidates.reserve(triangleCount * 3);
+    int timeStamp = cacheSize + 1;
+    size_t cursor = 1;
+    long fanVertex = 0;
+
+    while (fanVertex >= 0) {
+        candidates.clear();
+        for (unsigned int a = adjacencyOffset[fanVertex]; a < adjacencyOffset[fanVertex + 1]; ++a) {
+            unsigned int t = adjacency[a];
+            if (emitted[t]) continue;
+            for (int k = 0; k < 3; ++k) {
+                unsigned int v = in[t * 3 + k];
+                out.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (timeStamp - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = timeStamp++;
+                }
+            }
+            emitted[t] = 1;
+        }
+
+        // Next fanning vertex: the candidate that will still be in the cache after its remaining
+        // triangles are emitted, preferring the oldest one.
+        long best = -1;
+        int bestPriority = -1;
+        for (unsigned int v : candidates) {
+            if (liveTriangles[v] == 0) continue;
+            int priority = 0;
+            if (timeStamp - cacheTime[v] + 2 * static_cast<int>(liveTriangles[v]) <= cacheSize) {
+                priority = timeStamp - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+        if (best == -1) {
+            // Dead end: back-track through recently used vertices, then scan forward.
+            while (!deadEnd.empty()) {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v] > 0) {
+                    best = v;
+                    break;
+                }
+            }
+            while (best == -1 && cursor < vertexCount) {
+                if (liveTriangles[cursor] > 0) best = static_cast<long>(cursor);
+                ++cursor;
+            }
+        }
+        fanVertex = best;
+    }
+}
+
+size_t simulateFifoMisses(const uint32_t* indices, size_t count, size_t vertexCount, int cacheSize,
+                          bool hasRestart, uint32_t restartIndex) {
+    // A FIFO cache evicts in insertion order, so a vertex is resident iff fewer than
+    // cacheSize misses happened since it was inserted.
+    ScratchArena::Scope scratch(ScratchArena::forThread());
+    ScratchVector<long long> insertedAt(vertexCount, -1, ArenaAllocator<long long>(&scratch.arena()));
+    long long misses = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t v = indices[i];
+        if (hasRestart && v == restartIndex) continue;
+        if (v >= vertexCount) continue;
+        if (insertedAt[v] < 0 || misses - insertedAt[v] >= cacheSize) {
+            insertedAt[v] = misses;
+            ++misses;
+        }
+    }
+    return static_cast<size_t>(misses);
+}
+
+float computeACMR(const std::vector<unsigned int>& triangles, size_t vertexCount, int cacheSize) {
+    size_t triangleCount = triangles.size() / 3;
+    if (triangleCount == 0) return 0.0f;
+    size_t misses = simulateFifoMisses(triangles.data(), triangles.size(), vertexCount, cacheSize);
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+static size_t countStripTriangles(const std::vector<uint32_t>& strips, uint32_t restartIndex) {
+    size_t triangles = 0;
+    size_t run = 0;
+    for (uint32_t index : strips) {
+        if (index == restartIndex) {
+            if (run >= 3) triangles += run - 2;
+            run = 0;
+        } else {
+            ++run;
+        }
+    }
+    if (run >= 3) triangles += run - 2;
+    return triangles;
+}
+
+void buildIndexBuffer(const std::vector<unsigned int>& triangles, size_t vertexCount,
+                      int gridWidth, int gridDepth, const IndexBuildOptions& options,
+                      IndexBuffer& out, IndexBuildStats* stats) {
+    // Sizes only: a reused IndexBuffer keeps its capacity and rebuilds without allocating
+    out.indices16.clear();
+    out.indices32.clear();
+    out.mode = GL_TRIANGLES;
+    out.type = GL_UNSIGNED_INT;
+    out.usesPrimitiveRestart = false;
+    out.restartIndex = 0;
+    out.clusterRanges.clear();
+
+    bool isGrid = gridWidth > 1 && gridDepth > 1 &&
+                  static_cast<size_t>(gridWidth) * static_cast<size_t>(gridDepth) == vertexCount;
+    int cacheSize = std::max(3, options.cacheSize);
+    int stripeQuads = gridStripeWidth(cacheSize);
+
+    std::vector<uint32_t>& stream = out.indices32;
+    size_t triangleCount = triangles.size() / 3;
+
+    if (stats) {
+        if (isGrid) {
+            buildGridTriangles(gridWidth, gridDepth, 0, stream); // Row order, measured then overwritten below
+            stats->acmrBefore = computeACMR(stream, vertexCount, cacheSize);
+        } else {
+            stats->acmrBefore = computeACMR(triangles, vertexCount, cacheSize);
+        }
+        stats->indexBytesBefore = triangles.size() * sizeof(unsigned int);
+    }
+
+    if (options.clusterQuads > 0 && isGrid) {
+        // Cluster-major layout so each cluster can be drawn (or skipped) on its own; the cache ordering
+        // applies inside each cluster, Tipsify falls back to the stripe walk like strips do
+        bool strips = options.topology == IndexTopology::TriangleStrip;
+        int clusterStripe = options.ordering == VertexCacheOrdering::None ? 0 : stripeQuads;
+        buildGridClusters(gridWidth, gridDepth, options.clusterQuads, clusterStripe, strips, RESTART_INDEX_32,
+                          stream, out.clusterRanges);
+        if (strips) {
+            out.mode = GL_TRIANGLE_STRIP;
+            out.usesPrimitiveRestart = true;
+            out.restartIndex = RESTART_INDEX_32;
+            triangleCount = countStripTriangles(stream, RESTART_INDEX_32);
+        }
+    } else if (options.topology == IndexTopology::TriangleStrip && isGrid) {
+        // Strips are only generated for grids; Tipsify has no strip form so it uses the stripe walk too.
+        int stripStripe = options.ordering == VertexCacheOrdering::None ? 0 : stripeQuads;
+        buildGridStrips(gridWidth, gridDepth, stripStripe, RESTART_INDEX_32, stream);
+        out.mode = GL_TRIANGLE_STRIP;
+        out.usesPrimitiveRestart = true;
+        out.restartIndex = RESTART_INDEX_32;
+        triangleCount = countStripTriangles(stream, RESTART_INDEX_32);
+    } else if (options.ordering == VertexCacheOrdering::Grid && isGrid) {
+        buildGridTriangles(gridWidth, gridDepth, stripeQuads, stream);
+    } else if (options.ordering != VertexCacheOrdering::None) {
+        optimizeTipsify(triangles, vertexCount, cacheSize, stream);
+    } else {
+        stream.assign(triangles.begin(), triangles.end());
+    }
+
+    if (stats) {
+        size_t misses = simulateFifoMisses(stream.data(), stream.size(), vertexCount, cacheSize,
+                                           out.usesPrimitiveRestart, out.restartIndex);
+        stats->acmrAfter = triangleCount > 0 ? static_cast<float>(misses) / static_cast<float>(triangleCount) : 0.0f;
+    }
+
+    // 16-bit indices when every vertex index fits and, for strips, 0xFFFF is free for the restart marker.
+    size_t maxVertices16 = out.usesPrimitiveRestart ? RESTART_INDEX_16 : RESTART_INDEX_16 + 1;
+    if (options.allow16BitIndices && vertexCount <= maxVertices16) {
+        out.indices16.resize(stream.size());
+        for (size_t i = 0; i < stream.size(); ++i) {
+            out.indices16[i] = stream[i] == RESTART_INDEX_32 && out.usesPrimitiveRestart
+                                   ? static_cast<uint16_t>(RESTART_INDEX_16)
+                                   : static_cast<uint16_t>(stream[i]);
+        }
+        stream.clear();
+        out.type = GL_UNSIGNED_SHORT;
+        if (out.usesPrimitiveRestart) out.restartIndex = RESTART_INDEX_16;
+    }
+
+    if (stats) {
+        stats->indexBytesAfter = out.sizeInBytes();
+    }
+}
+
+} // namespace IndexOptimizer
@@ -1,19 +1,62 @@
 #include "Mesh.h"
 #include "HeightMap.h" // <<< ADD THIS LINE
+#include "RtinMesher.h"
 #include <glad/glad.h> // For OpenGL functions
 #include <iostream>
 #include <glm/geometric.hpp>
 #include <limits> // For std::numeric_limits
+#include <algorithm> // For std::min, std::max
+#include <cmath>
+#include "ScratchArena.h"
 
-Mesh::Mesh() : VAO(0), VBO(0), EBO(0) {}
+// CPU mesh buffers are handed from one mesh to the next instead of being freed, so chunk meshes built in a
+// steady stream (GPU-only meshes give theirs back right after upload) never allocate
+static VectorPool<Vertex>& vertexBufferPool() {
+    static VectorPool<Vertex> pool(16);
+    return pool;
+}
+
+static VectorPool<unsigned int>& indexBufferPool() {
+    static VectorPool<unsigned int> pool(16);
+    return pool;
+}
+
+// Index layouts wait in their mesh between prepareGpuData() and the upload; the 32-bit stream shares indexBufferPool
+static VectorPool<uint16_t>& index16BufferPool() {
+    static VectorPool<uint16_t> pool(16);
+    return pool;
+}
+
+static VectorPool<IndexRange>& clusterRangePool() {
+    static VectorPool<IndexRange> pool(16);
+    return pool;
+}
+
+static VectorPool<MeshCluster>& clusterPool() {
+    static VectorPool<MeshCluster> pool(16);
+    return pool;
+}
+
+Mesh::Mesh()
+    : gridWidth_(0), gridDepth_(0),
+      drawMode_(GL_TRIANGLES), indexType_(GL_UNSIGNED_INT), drawCount_(0),
+      primitiveRestart_(false), restartIndex_(0),
+      gpuDataPrepared_(false), residency_(MeshResidency::CpuAndGpu), vertexCount_(0), indexCount_(0), gpuBytes_(0) {}
 
 Mesh::~Mesh() {
     clearGPUData();
+    releaseCpuData();
+    clusterPool().recycle(clusters_);
+    index16BufferPool().recycle(pendingIndices_.indices16); // Prepared but never uploaded
+    indexBufferPool().recycle(pendingIndices_.indices32);
 }
 
 void Mesh::generateFromHeightMap(const HeightMap& heightMap, float horizontalScale, float verticalScale) {
     vertices.clear();
     indices.clear();
+    vertexBufferPool().acquire(vertices);
+    indexBufferPool().acquire(indices);
+    gpuDataPrepared_ = false;
 
     // Now the compiler will know what heightMap.getWidth(), .getDepth(), .getHeight() are
     int mapWidth = heightMap.getWidth();
@@ -24,6 +67,7 @@ void Mesh::generateFromHeightMap(const HeightMap& heightMap, float horizontalSca
         return;
     }
 
+    vertices.reserve(static_cast<size_t>(mapWidth) * mapDepth);
     for (int z_coord = 0; z_coord < mapDepth; ++z_coord) {
         for (int x_coord = 0; x_coord < mapWidth; ++x_coord) {
             Vertex vertex;
@@ -39,22 +83,12 @@ void Mesh::generateFromHeightMap(const HeightMap& heightMap, float horizontalSca
         }
     }
 
-    for (int z_coord = 0; z_coord < mapDepth - 1; ++z_coord) { 
-        for (int x_coord = 0; x_coord < mapWidth - 1; ++x_coord) { 
-            unsigned int topLeft = z_coord * mapWidth + x_coord;
-            unsigned int topRight = topLeft + 1;
-            unsigned int bottomLeft = (z_coord + 1) * mapWidth + x_coord;
-            unsigned int bottomRight = bottomLeft + 1;
-
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
-        }
-    }
+    // Canonical triangle list in row order; setupMesh() derives the GPU layout from it.
+    IndexOptimizer::buildGridTriangles(mapWidth, mapDepth, 0, indices);
+    gridWidth_ = mapWidth;
+    gridDepth_ = mapDepth;
+    vertexCount_ = vertices.size();
+    indexCount_ = indices.size();
     
     calculateNormals();
     calculateBoundingBox(); // Call after vertices are generated
@@ -64,6 +98,68 @@ void Mesh::generateFromHeightMap(const HeightMap& heightMap, float horizontalSca
     std::cout << "Mesh AABB Max: (" << boundingBox.max.x << ", " << boundingBox.max.y << ", " << boundingBox.max.z << ")" << std::endl;
 }
 
+void Mesh::generateAdaptiveFromHeightMap(const HeightMap& heightMap, float horizontalScale, float verticalScale,
+                                         const RtinMesher& mesher, float maxError) {
+    int mapWidth = heightMap.getWidth();
+    int mapDepth = heightMap.getDepth();
+    if (!mesher.isValid() || mapWidth != mesher.getGridSize() || mapDepth != mesher.getGridSize()) {
+        std::cerr << "Mesh: heightmap " << mapWidth << "x" << mapDepth << " does not fit the RTIN mesher, using the full grid." << std::endl;
+        generateFromHeightMap(heightMap, horizontalScale, verticalScale);
+        return;
+    }
+    vertices.clear();
+    indices.clear();
+    vertexBufferPool().acquire(vertices);
+    indexBufferPool().acquire(indices);
+    gpuDataPrepared_ = false;
+    gridWidth_ = 0; // Not a regular grid: the index optimizer falls back to Tipsify, geomipmapping is skipped
+    gridDepth_ = 0;
+
+    ScratchArena::Scope scratch(ScratchArena::forThread());
+    ScratchVector<float> errors{ ArenaAllocator<float>(&scratch.arena()) };
+    ScratchVector<unsigned int> gridTriangles{ ArenaAllocator<unsigned int>(&scratch.arena()) };
+    mesher.computeErrors(heightMap, verticalScale, errors);
+    mesher.extractTriangles(errors, maxError, gridTriangles);
+
+    // Only create the grid vertices the triangulation references
+    ScratchVector<int> remap(static_cast<size_t>(mapWidth) * mapDepth, -1, ArenaAllocator<int>(&scratch.arena()));
+    vertices.reserve(static_cast<size_t>(mapWidth) * mapDepth);
+    indices.reserve(gridTriangles.size());
+    for (unsigned int gridIndex : gridTriangles) {
+        if (remap[gridIndex] < 0) {
+            int x_coord = static_cast<int>(gridIndex) % mapWidth;
+            int z_coord = static_cast<int>(gridIndex) / mapWidth;
+            Vertex vertex;
+            vertex.Position.x = static_cast<float>(x_coord) * horizontalScale - (static_cast<float>(mapWidth) * horizontalScale / 2.0f);
+            vertex.Position.y = heightMap.getHeight(x_coord, z_coord) * verticalScale;
+            vertex.Position.z = static_cast<float>(z_coord) * horizontalScale - (static_cast<float>(mapDepth) * horizontalScale / 2.0f);
+            vertex.TexCoords.x = static_cast<float>(x_coord) / static_cast<float>(mapWidth - 1);
+            vertex.TexCoords.y = static_cast<float>(z_coord) / static_cast<float>(mapDepth - 1);
+
+            // Normals come from the full-resolution heights, so large flat triangles still shade smoothly
+            int xLeft = std::max(x_coord - 1, 0), xRight = std::min(x_coord + 1, mapWidth - 1);
+            int zDown = std::max(z_coord - 1, 0), zUp = std::min(z_coord + 1, mapDepth - 1);
+            float slopeX = (heightMap.getHeight(xRight, z_coord) - heightMap.getHeight(xLeft, z_coord)) * verticalScale /
+                           (static_cast<float>(xRight - xLeft) * horizontalScale);
+            float slopeZ = (heightMap.getHeight(x_coord, zUp) - heightMap.getHeight(x_coord, zDown)) * verticalScale /
+                           (static_cast<float>(zUp - zDown) * horizontalScale);
+            vertex.Normal = glm::normalize(glm::vec3(-slopeX, 1.0f, -slopeZ));
+
+            remap[gridIndex] = static_cast<int>(vertices.size());
+            vertices.push_back(vertex);
+        }
+        indices.push_back(static_cast<unsigned int>(remap[gridIndex]));
+    }
+
+    vertexCount_ = vertices.size();
+    indexCount_ = indices.size();
+    calculateBoundingBox();
+
+    size_t fullTriangles = static_cast<size_t>(mapWidth - 1) * (mapDepth - 1) * 2;
+    std::cout << "Adaptive mesh generated: " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles ("
+              << (100.0f * indices.size() / 3) / fullTriangles << "% of the full grid) at max error " << maxError << std::endl;
+}
+
 void Mesh::calculateBoundingBox() {
     if (vertices.empty()) return;
 
@@ -101,19 +197,48 @@ void Mesh::calculateNormals() {
     }
 }
 
+void Mesh::prepareGpuData() {
+    if (vertices.empty() || indices.empty()) {
+        std::cerr << "Mesh::prepareGpuData() called with no vertex or index data." << std::endl;
+        return;
+    }
+    // Derive the GPU index layout (16-bit / strips / cache-friendly order) from the triangle list.
+    // The buffers are recycled after upload, so building the layout does not allocate in steady state.
+    index16BufferPool().acquire(pendingIndices_.indices16);
+    indexBufferPool().acquire(pendingIndices_.indices32);
+    clusterRangePool().acquire(pendingIndices_.clusterRanges);
+    IndexOptimizer::buildIndexBuffer(indices, vertices.size(), gridWidth_, gridDepth_, indexOptions_, pendingIndices_, &indexStats_);
+    buildClusters(pendingIndices_.clusterRanges);
+    clusterRangePool().recycle(pendingIndices_.clusterRanges);
+    gpuDataPrepared_ = true;
+    // Index bytes and ACMR before/after are kept in indexStats_ (getIndexBuildStats); the terrain sums them
+    // over uploaded chunks for the [Stats] line instead of logging every mesh from the worker threads
+}
+
 void Mesh::setupMesh() {
     if (vertices.empty() || indices.empty()) {
         std::cerr << "Mesh::setupMesh() called with no vertex or index data." << std::endl;
         return;
     }
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    if (!gpuDataPrepared_) {
+        prepareGpuData();
+    }
+    const IndexBuffer& gpuIndices = pendingIndices_;
+    vertexCount_ = vertices.size();
+    indexCount_ = indices.size();
+    size_t vertexBytes = vertices.size() * sizeof(Vertex);
+    // A re-upload refills the mesh's own buffers; otherwise the pool hands out a recycled set when it can
+    MeshBufferPool& pool = MeshBufferPool::instance();
+    if (buffers_.vao == 0) {
+        buffers_ = pool.acquire(vertexBytes, gpuIndices.sizeInBytes());
+    }
+    pool.fill(buffers_, &vertices[0], vertexBytes, gpuIndices.data(), gpuIndices.sizeInBytes()); // Leaves the VAO and VBO bound
+    drawMode_ = gpuIndices.mode;
+    indexType_ = gpuIndices.type;
+    drawCount_ = static_cast<GLsizei>(gpuIndices.count());
+    primitiveRestart_ = gpuIndices.usesPrimitiveRestart;
+    restartIndex_ = gpuIndices.restartIndex;
+
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
     glEnableVertexAttribArray(1);
@@ -121,39 +246,178 @@ void Mesh::setupMesh() {
     glEnableVertexAttribArray(2); 
     glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
     glBindVertexArray(0);
+
+    gpuBytes_ = vertexBytes + gpuIndices.sizeInBytes();
+    clusterBounds_.clear();
+    clusterBounds_.reserve(clusters_.size());
+    for (const MeshCluster& cluster : clusters_) {
+        clusterBounds_.push_back(cluster.bounds);
+    }
+    index16BufferPool().recycle(pendingIndices_.indices16);
+    indexBufferPool().recycle(pendingIndices_.indices32);
+    gpuDataPrepared_ = false;
+
+    if (residency_ == MeshResidency::GpuOnly) {
+        releaseCpuData();
+    } else if (residency_ == MeshResidency::CpuOnly) {
+        clearGPUData();
+    }
+}
+
+void Mesh::buildClusters(const std::vector<IndexRange>& ranges) {
+    clusters_.clear();
+    if (ranges.empty() || gridWidth_ <= 1) {
+        return;
+    }
+    clusterPool().acquire(clusters_);
+    clusters_.reserve(ranges.size());
+    for (const IndexRange& range : ranges) {
+        MeshCluster cluster;
+        cluster.firstIndex = range.first;
+        cluster.indexCount = range.count;
+        // Strips cover the same quads, so the triangle count does not depend on the topology
+        cluster.triangleCount = static_cast<uint32_t>((range.quadX1 - range.quadX0) * (range.quadZ1 - range.quadZ0) * 2);
+
+        for (int z_coord = range.quadZ0; z_coord <= range.quadZ1; ++z_coord) {
+            for (int x_coord = range.quadX0; x_coord <= range.quadX1; ++x_coord) {
+                const glm::vec3& position = vertices[z_coord * gridWidth_ + x_coord].Position;
+                cluster.bounds.min = glm::min(cluster.bounds.min, position);
+                cluster.bounds.max = glm::max(cluster.bounds.max, position);
+            }
+        }
+
+        // Face normals with the winding of IndexOptimizer::buildGridTriangles: (tl, bl, tr) and (tr, bl, br)
+        glm::vec3 normalSum(0.0f);
+        for (int pass = 0; pass < 2; ++pass) {
+            float minDot = 1.0f;
+            for (int z_coord = range.quadZ0; z_coord < range.quadZ1; ++z_coord) {
+                for (int x_coord = range.quadX0; x_coord < range.quadX1; ++x_coord) {
+                    const glm::vec3& topLeft = vertices[z_coord * gridWidth_ + x_coord].Position;
+                    const glm::vec3& topRight = vertices[z_coord * gridWidth_ + x_coord + 1].Position;
+                    const glm::vec3& bottomLeft = vertices[(z_coord + 1) * gridWidth_ + x_coord].Position;
+                    const glm::vec3& bottomRight = vertices[(z_coord + 1) * gridWidth_ + x_coord + 1].Position;
+                    glm::vec3 faces[2] = { glm::cross(bottomLeft - topLeft, topRight - topLeft),
+                                           glm::cross(bottomLeft - topRight, bottomRight - topRight) };
+                    for (const glm::vec3& face : faces) {
+                        float length = glm::length(face);
+                        if (length <= 0.0f) continue; // Degenerate triangle
+                        if (pass == 0) normalSum += face / length;
+                        else minDot = std::min(minDot, glm::dot(face / length, cluster.coneAxis));
+                    }
+                }
+            }
+            if (pass == 0) {
+                float length = glm::length(normalSum);
+                if (length <= 0.0f) break; // Keeps the never-culled default
+                cluster.coneAxis = normalSum / length;
+            } else {
+                // A cone of half-angle acos(minDot) holds every normal; beyond a hemisphere nothing can be culled
+                cluster.coneCutoff = minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+            }
+        }
+        clusters_.push_back(cluster);
+    }
+}
+
+void Mesh::setResidency(MeshResidency residency) {
+    if (!hasCpuData() && !hasGpuData()) {
+        residency_ = residency; // Nothing built yet; applied by setupMesh()
+        return;
+    }
+    if (residency != MeshResidency::GpuOnly && !hasCpuData()) {
+        std::cerr << "Mesh::setResidency(): CPU data was already released, staying GPU-only." << std::endl;
+        return;
+    }
+    residency_ = residency;
+    switch (residency) {
+    case MeshResidency::GpuOnly:
+        if (!hasGpuData()) setupMesh(); // Uploads, then releases the CPU copy
+        else releaseCpuData();
+        break;
+    case MeshResidency::CpuAndGpu:
+        if (!hasGpuData()) setupMesh();
+        break;
+    case MeshResidency::CpuOnly:
+        clearGPUData();
+        break;
+    }
+}
+
+void Mesh::releaseCpuData() {
+    // Leaves both vectors without storage; the pools hand it to the next mesh (or free it when full)
+    vertexBufferPool().recycle(vertices);
+    indexBufferPool().recycle(indices);
+}
+
+size_t Mesh::getCpuBytes() const {
+    return vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(unsigned int);
+}
+
+size_t Mesh::getBookkeepingBytes() const {
+    size_t boundsBytes = (clusterBounds_.minX.capacity() + clusterBounds_.minY.capacity() + clusterBounds_.minZ.capacity() +
+                          clusterBounds_.maxX.capacity() + clusterBounds_.maxY.capacity() + clusterBounds_.maxZ.capacity()) * sizeof(float) +
+                         clusterBounds_.planeHint.capacity() * sizeof(uint8_t);
+    return clusters_.capacity() * sizeof(MeshCluster) + boundsBytes +
+           pendingIndices_.indices16.capacity() * sizeof(uint16_t) + pendingIndices_.indices32.capacity() * sizeof(uint32_t) +
+           pendingIndices_.clusterRanges.capacity() * sizeof(IndexRange);
 }
 
 void Mesh::draw() const {
-    if (VAO == 0) {
+    if (buffers_.vao == 0) {
         // std::cerr << "Mesh::draw() called but VAO is not set up." << std::endl; // Optional debug
         return;
     }
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+    glBindVertexArray(buffers_.vao);
+    if (primitiveRestart_) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(restartIndex_);
+    }
+    glDrawElements(drawMode_, drawCount_, indexType_, 0);
+    if (primitiveRestart_) {
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
+    glBindVertexArray(0);
+}
+
+void Mesh::drawRanges(const GLsizei* counts, const void* const* byteOffsets, GLsizei rangeCount) const {
+    if (buffers_.vao == 0 || rangeCount <= 0) {
+        return;
+    }
+    glBindVertexArray(buffers_.vao);
+    if (primitiveRestart_) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(restartIndex_);
+    }
+    glMultiDrawElements(drawMode_, counts, indexType_, byteOffsets, rangeCount);
+    if (primitiveRestart_) {
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
+    glBindVertexArray(0);
+}
+
+void Mesh::drawWithIndexBuffer(GLuint ebo, GLenum indexType, size_t byteOffset, GLsizei count) const {
+    if (buffers_.vao == 0 || ebo == 0 || count <= 0) {
+        return;
+    }
+    glBindVertexArray(buffers_.vao);
+    // The element buffer binding is VAO state, so point it back at our own EBO afterwards
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glDrawElements(GL_TRIANGLES, count, indexType, reinterpret_cast<const void*>(byteOffset));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers_.ebo);
     glBindVertexArray(0);
 }
 
 size_t Mesh::getVerticesCount() const {
-    return vertices.size();
+    return vertexCount_;
 }
 
 size_t Mesh::getIndicesCount() const {
-    return indices.size();
+    return indexCount_;
 }
 
 void Mesh::clearGPUData() {
-    if (VAO != 0) {
-        glDeleteVertexArrays(1, &VAO);
-        VAO = 0; // Reset to 0 to indicate it's no longer valid
-    }
-    if (VBO != 0) {
-        glDeleteBuffers(1, &VBO);
-        VBO = 0;
-    }
-    if (EBO != 0) {
-        glDeleteBuffers(1, &EBO);
-        EBO = 0;
-    }
+    MeshBufferPool::instance().release(buffers_); // Resets buffers_ to 0 to indicate it's no longer valid
+    gpuBytes_ = 0;
     // Optionally clear CPU-side data if desired
     // vertices.clear();
     // vertices.shrink_to_fit();
@@ -162,6 +426,22 @@ void Mesh::clearGPUData() {
     // std::cout << "Mesh GPU data cleared." << std::endl; // Optional debug
 }
 
+void Mesh::clear() {
+    clearGPUData();
+    releaseCpuData();
+    clusterPool().recycle(clusters_);
+    clusterBounds_.clear();
+    index16BufferPool().recycle(pendingIndices_.indices16);
+    indexBufferPool().recycle(pendingIndices_.indices32);
+    pendingIndices_ = IndexBuffer();
+    gpuDataPrepared_ = false;
+    boundingBox = BoundingBox();
+    gridWidth_ = gridDepth_ = 0;
+    vertexCount_ = indexCount_ = 0;
+    drawCount_ = 0;
+    indexStats_ = IndexBuildStats();
+}
+
 // Ensure calculateNormals and calculateBoundingBox are implemented if generateFromHeightMap calls them.
 // void Mesh::calculateNormals() { /* ... your implementation ... */ }
 // void Mesh::calculateBoundingBox() { /* ... your implementation ... */ }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "MeshBufferPool.h"
+#include <algorithm> // For std::max
+#include <iostream>
+
+// Storage is handed out in whole pages, so meshes that differ by a few bytes still fit each other's sets
+static const size_t CAPACITY_GRANULARITY = 4096;
+
+MeshBufferPool& MeshBufferPool::instance() {
+    static MeshBufferPool pool;
+    return pool;
+}
+
+MeshBufferPool::MeshBufferPool()
+    : enabled_(true), maxIdleBytes_(32 * 1024 * 1024), reuseDelayFrames_(2), frame_(0),
+      largestVertexCapacity_(0), largestIndexCapacity_(0) {}
+
+void MeshBufferPool::setEnabled(bool enabled) {
+    if (enabled_ && !enabled) {
+        clear();
+    }
+    enabled_ = enabled;
+}
+
+void MeshBufferPool::setMaxIdleBytes(size_t maxIdleBytes) {
+    maxIdleBytes_ = maxIdleBytes;
+    trimIdle();
+}
+
+size_t MeshBufferPool::roundCapacity(size_t bytes) const {
+    if (!enabled_) {
+        return bytes; // Exact sizes, as without a pool
+    }
+    return (bytes + CAPACITY_GRANULARITY - 1) / CAPACITY_GRANULARITY * CAPACITY_GRANULARITY;
+}
+
+MeshBufferSet MeshBufferPool::createSet() {
+    MeshBufferSet set;
+    glGenVertexArrays(1, &set.vao);
+    glGenBuffers(1, &set.vbo);
+    glGenBuffers(1, &set.ebo);
+    stats_.setsCreated++;
+    return set;
+}
+
+void MeshBufferPool::deleteSet(MeshBufferSet& set) {
+    if (set.vao != 0) glDeleteVertexArrays(1, &set.vao);
+    if (set.vbo != 0) glDeleteBuffers(1, &set.vbo);
+    if (set.ebo != 0) glDeleteBuffers(1, &set.ebo);
+    stats_.setsDeleted++;
+    set = MeshBufferSet();
+}
+
+MeshBufferSet MeshBufferPool::acquire(size_t vertexBytes, size_t indexBytes) {
+    if (enabled_) {
+        largestVertexCapacity_ = std::max(largestVertexCapacity_, roundCapacity(vertexBytes));
+        largestIndexCapacity_ = std::max(largestIndexCapacity_, roundCapacity(indexBytes));
+
+        // Smallest ready set that fits; failing that the oldest ready one, whose storage fill() regrows
+        size_t best = idle_.size();
+        size_t oldestReady = idle_.size();
+        for (size_t i = 0; i < idle_.size(); ++i) {
+            const IdleSet& candidate = idle_[i];
+            if (candidate.readyFrame > frame_) {
+                continue; // The GPU may still be drawing from it
+            }
+            if (oldestReady == idle_.size()) {
+                oldestReady = i;
+            }
+            if (candidate.set.vertexCapacity >= vertexBytes && candidate.set.indexCapacity >= indexBytes &&
+                (best == idle_.size() || candidate.set.vertexCapacity + candidate.set.indexCapacity <
+                                         idle_[best].set.vertexCapacity + idle_[best].set.indexCapacity)) {
+                best = i;
+            }
+        }
+        size_t chosen = best < idle_.size() ? best : oldestReady;
+        if (chosen < idle_.size()) {
+            MeshBufferSet set = idle_[chosen].set;
+            idle_.erase(idle_.begin() + chosen);
+            stats_.idleSets--;
+            stats_.idleBytes -= set.vertexCapacity + set.indexCapacity;
+            stats_.setsReused++;
+            return set;
+        }
+    }
+    return createSet();
+}
+
+void MeshBufferPool::fill(MeshBufferSet& set, const void* vertices, size_t vertexBytes, const void* indices, size_t indexBytes) {
+    glBindVertexArray(set.vao);
+    // The element buffer binding is VAO state, so it is bound with the VAO current
+    const GLenum targets[2] = { GL_ELEMENT_ARRAY_BUFFER, GL_ARRAY_BUFFER };
+    const GLuint buffers[2] = { set.ebo, set.vbo };
+    const void* data[2] = { indices, vertices };
+    const size_t bytes[2] = { indexBytes, vertexBytes };
+    size_t* capacities[2] = { &set.indexCapacity, &set.vertexCapacity };
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(targets[i], buffers[i]);
+        if (bytes[i] > *capacities[i]) {
+            *capacities[i] = roundCapacity(bytes[i]);
+            bool exact = *capacities[i] == bytes[i];
+            glBufferData(targets[i], static_cast<GLsizeiptr>(*capacities[i]), exact ? data[i] : nullptr, GL_STATIC_DRAW);
+            stats_.storageAllocations++;
+            if (exact) {
+                continue;
+            }
+        }
+        glBufferSubData(targets[i], 0, static_cast<GLsizeiptr>(bytes[i]), data[i]);
+        stats_.storageUpdates++;
+    }
+}
+
+void MeshBufferPool::release(MeshBufferSet& set) {
+    if (set.vao == 0 && set.vbo == 0 && set.ebo == 0) {
+        return;
+    }
+    if (!enabled_ || set.vao == 0 || set.vbo == 0 || set.ebo == 0) {
+        deleteSet(set);
+        return;
+    }
+    idle_.push_back({ set, frame_ + static_cast<uint64_t>(reuseDelayFrames_) });
+    stats_.idleSets++;
+    stats_.idleBytes += set.vertexCapacity + set.indexCapacity;
+    set = MeshBufferSet();
+    trimIdle();
+}
+
+void MeshBufferPool::reserve(size_t count) {
+    if (!enabled_ || largestVertexCapacity_ == 0 || largestIndexCapacity_ == 0) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        MeshBufferSet set = createSet();
+        glBindVertexArray(set.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, set.vbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(largestVertexCapacity_), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, set.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(largestIndexCapacity_), nullptr, GL_STATIC_DRAW);
+        stats_.storageAllocations += 2;
+        set.vertexCapacity = largestVertexCapacity_;
+        set.indexCapacity = largestIndexCapacity_;
+        idle_.push_back({ set, frame_ }); // Never drawn from, so ready at once
+        stats_.idleSets++;
+        stats_.idleBytes += set.vertexCapacity + set.indexCapacity;
+    }
+    glBindVertexArray(0);
+    trimIdle();
+    std::cout << "MeshBufferPool: reserved " << count << " buffer sets of " << largestVertexCapacity_ / 1024 << " + "
+              << largestIndexCapacity_ / 1024 << " KB" << std::endl;
+}
+
+void MeshBufferPool::trimIdle() {
+    size_t drop = 0;
+    size_t bytes = stats_.idleBytes;
+    while (drop < idle_.size() && bytes > maxIdleBytes_) {
+        bytes -= idle_[drop].set.vertexCapacity + idle_[drop].set.indexCapacity;
+        deleteSet(idle_[drop].set);
+        ++drop;
+    }
+    if (drop > 0) {
+        idle_.erase(idle_.begin(), idle_.begin() + drop);
+        stats_.idleSets = idle_.size();
+        stats_.idleBytes = bytes;
+    }
+}
+
+void MeshBufferPool::clear() {
+    for (IdleSet& entry : idle_) {
+        deleteSet(entry.set);
+    }
+    idle_.clear();
+    stats_.idleSets = 0;
+    stats_.idleBytes = 0;
+}
+
+void MeshBufferPool::resetStats() {
+    // The idle totals describe the pool, not the interval
+    MeshBufferPoolStats stats;
+    stats.idleSets = stats_.idleSets;
+    stats.idleBytes = stats_.idleBytes;
+    stats_ = stats;
+}
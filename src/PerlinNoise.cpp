@@ -4,18 +4,11 @@
 #include <algorithm>   // For std::shuffle, std::min, std::max
 #include <stdexcept>   // For std::runtime_error
 
-PerlinNoise::PerlinNoise() {
-    // Initialize with a random seed
-    std::random_device rd;
-    std::mt19937 generator(rd());
-    
-    p.resize(256);
-    std::iota(p.begin(), p.end(), 0); // Fill p with 0-255
-    std::shuffle(p.begin(), p.end(), generator); // Shuffle it
-    p.insert(p.end(), p.begin(), p.end()); // Duplicate the permutation vector
+PerlinNoise::PerlinNoise() : PerlinNoise(std::random_device()()) {
+    // Random seed, kept so the terrain can be recreated with getSeed()
 }
 
-PerlinNoise::PerlinNoise(unsigned int seed) {
+PerlinNoise::PerlinNoise(unsigned int seed) : seed_(seed) {
     p.resize(256);
     std::iota(p.begin(), p.end(), 0); // Fill p with 0-255
 
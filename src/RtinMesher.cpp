@@ -0,0 +1,148 @@
+#include "RtinMesher.h"
+#include "HeightMap.h"
+#include <iostream>
+#include <algorithm> // For std::max
+#include <cmath>     // For std::abs
+#include <limits>
+
+RtinMesher::RtinMesher(int gridSize) : gridSize_(0), parentTriangleCount_(0) {
+    int tileSize = gridSize - 1;
+    if (tileSize < 2 || (tileSize & (tileSize - 1)) != 0 || gridSize > 65535) {
+        std::cerr << "RtinMesher: grid size " << gridSize << " is not 2^n + 1, adaptive meshing disabled." << std::endl;
+        return;
+    }
+    gridSize_ = gridSize;
+
+    // Walk every triangle of the implicit tree from its id: the two roots split the square along the
+    // diagonal, and each further bit of the id picks the left or right half of the parent.
+    int triangleCount = tileSize * tileSize * 2 - 2;
+    parentTriangleCount_ = triangleCount - tileSize * tileSize;
+    triangleCoords_.resize(static_cast<size_t>(triangleCount) * 4);
+    for (int i = 0; i < triangleCount; ++i) {
+        int id = i + 2;
+        int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+        if (id & 1) {
+            bx = by = cx = tileSize; // Bottom-left root
+        } else {
+            ax = ay = cy = tileSize; // Top-right root
+        }
+        while ((id >>= 1) > 1) {
+            int mx = (ax + bx) >> 1;
+            int my = (ay + by) >> 1;
+            if (id & 1) { // Left half
+                bx = ax; by = ay;
+                ax = cx; ay = cy;
+            } else {      // Right half
+                ax = bx; ay = by;
+                bx = cx; by = cy;
+            }
+            cx = mx; cy = my;
+        }
+        triangleCoords_[i * 4 + 0] = static_cast<unsigned short>(ax);
+        triangleCoords_[i * 4 + 1] = static_cast<unsigned short>(ay);
+        triangleCoords_[i * 4 + 2] = static_cast<unsigned short>(bx);
+        triangleCoords_[i * 4 + 3] = static_cast<unsigned short>(by);
+    }
+}
+
+void RtinMesher::computeErrors(const HeightMap& heightMap, float verticalScale, ScratchVector<float>& outErrors) const {
+    outErrors.clear();
+    if (!isValid() || heightMap.getWidth() != gridSize_ || heightMap.getDepth() != gridSize_) {
+        std::cerr << "RtinMesher: heightmap does not match the " << gridSize_ << "^2 grid." << std::endl;
+        return;
+    }
+    int size = gridSize_;
+    int last = size - 1;
+    outErrors.assign(static_cast<size_t>(size) * size, 0.0f);
+
+    // Boundary vertices can never be dropped, so both chunks sharing an edge triangulate it identically
+    const float keep = std::numeric_limits<float>::max();
+    for (int i = 0; i < size; ++i) {
+        outErrors[i] = outErrors[last * size + i] = keep;
+        outErrors[i * size] = outErrors[i * size + last] = keep;
+    }
+
+    auto height = [&](int x, int y) { return heightMap.getHeight(x, y) * verticalScale; };
+
+    // Children before parents, so each midpoint error already includes everything below it
+    int triangleCount = static_cast<int>(triangleCoords_.size() / 4);
+    for (int i = triangleCount - 1; i >= 0; --i) {
+        int ax = triangleCoords_[i * 4 + 0];
+        int ay = triangleCoords_[i * 4 + 1];
+        int bx = triangleCoords_[i * 4 + 2];
+        int by = triangleCoords_[i * 4 + 3];
+        int mx = (ax + bx) >> 1;
+        int my = (ay + by) >> 1;
+        int cx = mx + my - ay;
+        int cy = my + ax - mx;
+
+        // Largest deviation of any grid vertex under the triangle from its plane. Martini only measures the
+        // hypotenuse midpoint, which can exceed the tolerance by 50% or more once large triangles are kept.
+        float ha = height(ax, ay), hb = height(bx, by), hc = height(cx, cy);
+        float det = static_cast<float>((by - cy) * (ax - cx) + (cx - bx) * (ay - cy));
+        float triangleError = 0.0f;
+        for (int y = std::min(std::min(ay, by), cy); y <= std::max(std::max(ay, by), cy); ++y) {
+            for (int x = std::min(std::min(ax, bx), cx); x <= std::max(std::max(ax, bx), cx); ++x) {
+                float wa = ((by - cy) * (x - cx) + (cx - bx) * (y - cy)) / det;
+                float wb = ((cy - ay) * (x - cx) + (ax - cx) * (y - cy)) / det;
+                float wc = 1.0f - wa - wb;
+                if (wa < -1e-6f || wb < -1e-6f || wc < -1e-6f) continue;
+                triangleError = std::max(triangleError, std::abs(wa * ha + wb * hb + wc * hc - height(x, y)));
+            }
+        }
+
+        // Both triangles sharing this hypotenuse write the same midpoint, so they always split together
+        int middleIndex = my * size + mx;
+        float& middleError = outErrors[middleIndex];
+        middleError = std::max(middleError, triangleError);
+
+        if (i < parentTriangleCount_) {
+            int leftChildIndex = ((ay + cy) >> 1) * size + ((ax + cx) >> 1);
+            int rightChildIndex = ((by + cy) >> 1) * size + ((bx + cx) >> 1);
+            middleError = std::max(middleError, std::max(outErrors[leftChildIndex], outErrors[rightChildIndex]));
+        }
+    }
+}
+
+void RtinMesher::extractTriangles(const ScratchVector<float>& errors, float maxError, ScratchVector<unsigned int>& outTriangles) const {
+    outTriangles.clear();
+    int size = gridSize_;
+    if (!isValid() || errors.size() != static_cast<size_t>(size) * size) {
+        return;
+    }
+    int last = size - 1;
+    // Worst case up front: outTriangles may share the arena with the stack below, so it must not grow past it
+    outTriangles.reserve(static_cast<size_t>(last) * last * 6);
+
+    auto emit = [&](int ax, int ay, int bx, int by, int cx, int cy) {
+        unsigned int a = ay * size + ax;
+        unsigned int b = by * size + bx;
+        unsigned int c = cy * size + cx;
+        // Keep the normal pointing up (+Y), as in the full-resolution grid
+        if ((by - ay) * (cx - ax) - (bx - ax) * (cy - ay) < 0) std::swap(b, c);
+        outTriangles.push_back(a);
+        outTriangles.push_back(b);
+        outTriangles.push_back(c);
+    };
+
+    // Explicit stack instead of recursion: each entry is a triangle (a, b, c) with c the right angle
+    struct Pending { int ax, ay, bx, by, cx, cy; };
+    ScratchArena::Scope scratch(ScratchArena::forThread());
+    ScratchVector<Pending> stack{ ArenaAllocator<Pending>(&scratch.arena()) };
+    stack.reserve(64 * 2); // Depth-first: at most two pending triangles per tree level
+    stack.push_back({ last, last, 0, 0, 0, last });
+    stack.push_back({ 0, 0, last, last, last, 0 });
+    while (!stack.empty()) {
+        Pending t = stack.back();
+        stack.pop_back();
+        int mx = (t.ax + t.bx) >> 1;
+        int my = (t.ay + t.by) >> 1;
+        bool canSplit = std::abs(t.ax - t.cx) + std::abs(t.ay - t.cy) > 1;
+        if (canSplit && errors[my * size + mx] > maxError) {
+            stack.push_back({ t.bx, t.by, t.cx, t.cy, mx, my });
+            stack.push_back({ t.cx, t.cy, t.ax, t.ay, mx, my });
+        } else {
+            emit(t.ax, t.ay, t.bx, t.by, t.cx, t.cy);
+        }
+    }
+}
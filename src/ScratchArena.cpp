@@ -0,0 +1,115 @@
+#include "ScratchArena.h"
+#include <algorithm> // For std::max
+#include <new>
+
+ScratchArena::ScratchArena(size_t initialBytes)
+    : currentBlock_(0), offset_(0), bytesBeforeCurrent_(0), highWaterBytes_(0), blockAllocations_(0) {
+    if (initialBytes > 0) {
+        blocks_.push_back({ static_cast<char*>(::operator new(initialBytes)), initialBytes });
+        blockAllocations_++;
+    }
+}
+
+ScratchArena::~ScratchArena() {
+    for (const Block& block : blocks_) {
+        ::operator delete(block.data);
+    }
+}
+
+void* ScratchArena::allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;
+    if (alignment == 0) alignment = 1;
+    for (;;) {
+        if (!blocks_.empty()) {
+            Block& block = blocks_[currentBlock_];
+            uintptr_t address = reinterpret_cast<uintptr_t>(block.data + offset_);
+            size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+            if (offset_ + padding + bytes <= block.size) {
+                char* result = block.data + offset_ + padding;
+                offset_ += padding + bytes;
+                highWaterBytes_ = std::max(highWaterBytes_, bytesBeforeCurrent_ + offset_);
+                return result;
+            }
+        }
+        moveToNextBlock(bytes, alignment); // Always leaves room for this allocation
+    }
+}
+
+void ScratchArena::deallocate(void* pointer, size_t bytes) {
+    if (blocks_.empty() || pointer == nullptr) return;
+    char* top = blocks_[currentBlock_].data + offset_;
+    char* start = static_cast<char*>(pointer);
+    if (start + bytes == top && start >= blocks_[currentBlock_].data) {
+        offset_ -= bytes;
+    }
+}
+
+void ScratchArena::moveToNextBlock(size_t bytes, size_t alignment) {
+    size_t needed = bytes + alignment;
+    size_t next = blocks_.empty() ? 0 : currentBlock_ + 1;
+    if (next < blocks_.size() && blocks_[next].size >= needed) {
+        // A block kept from an earlier job that overflowed
+        bytesBeforeCurrent_ += blocks_[currentBlock_].size;
+        currentBlock_ = next;
+        offset_ = 0;
+        return;
+    }
+
+    size_t lastSize = blocks_.empty() ? 0 : blocks_.back().size;
+    size_t size = std::max(needed, std::max(lastSize * 2, static_cast<size_t>(64 * 1024)));
+    Block block = { static_cast<char*>(::operator new(size)), size };
+    blockAllocations_++;
+    if (blocks_.empty()) {
+        blocks_.push_back(block);
+        currentBlock_ = 0;
+    } else {
+        blocks_.insert(blocks_.begin() + next, block);
+        bytesBeforeCurrent_ += blocks_[currentBlock_].size;
+        currentBlock_ = next;
+    }
+    offset_ = 0;
+}
+
+void ScratchArena::rewind(size_t block, size_t offset) {
+    if (blocks_.empty()) return;
+    if (block == 0 && offset == 0 && blocks_.size() > 1) {
+        // Nothing is live: merge the overflow blocks so a job of this size fits in one block next time
+        size_t total = getCapacity();
+        for (const Block& old : blocks_) {
+            ::operator delete(old.data);
+        }
+        blocks_.clear();
+        blocks_.push_back({ static_cast<char*>(::operator new(total)), total });
+        blockAllocations_++;
+    }
+    currentBlock_ = block;
+    offset_ = offset;
+    bytesBeforeCurrent_ = 0;
+    for (size_t i = 0; i < block; ++i) {
+        bytesBeforeCurrent_ += blocks_[i].size;
+    }
+}
+
+size_t ScratchArena::getBytesInUse() const {
+    return bytesBeforeCurrent_ + offset_;
+}
+
+size_t ScratchArena::getCapacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+ScratchArena& ScratchArena::forThread() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+ScratchArena::Scope::Scope(ScratchArena& arena)
+    : arena_(arena), block_(arena.currentBlock_), offset_(arena.offset_) {}
+
+ScratchArena::Scope::~Scope() {
+    arena_.rewind(block_, offset_);
+}
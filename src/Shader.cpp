@@ -5,7 +5,9 @@
 #include <sstream>     // For std::stringstream
 #include <iostream>    // For std::cerr, std::endl
 #include <string>      // For std::string (though often pulled in by other headers)
+#include <algorithm>   // For std::max
 #include <glm/gtc/type_ptr.hpp> // For glm::value_ptr (already there but good to confirm)
+#include <cstring>     // For std::memcmp, std::memcpy
 
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath) {
@@ -65,6 +67,140 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     // Delete the shaders as they're linked into our program now and no longer necessary
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    reflectUniforms();
+}
+
+void Shader::reflectUniforms() {
+    GLint linked = 0;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        return; // Every set becomes a no-op, as with glGetUniformLocation returning -1
+    }
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<GLchar> nameBuffer(static_cast<size_t>(std::max(maxNameLength, 1)));
+
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint arraySize = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &length, &arraySize, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), static_cast<size_t>(length));
+        // Arrays are reported as "name[0]"; list each element, and element 0 under the bare name too
+        std::string baseName = name;
+        size_t bracket = baseName.find('[');
+        if (bracket != std::string::npos) {
+            baseName.erase(bracket);
+        }
+        for (GLint element = 0; element < std::max(arraySize, 1); ++element) {
+            std::string elementName = arraySize > 1 || bracket != std::string::npos
+                                          ? baseName + "[" + std::to_string(element) + "]" : baseName;
+            UniformSlot slot;
+            slot.location = glGetUniformLocation(ID, elementName.c_str());
+            slot.type = type;
+            if (slot.location < 0) {
+                continue; // Uniform block members have no location; they are set through their buffer
+            }
+            int index = static_cast<int>(uniforms_.size());
+            uniforms_.push_back(slot);
+            uniformSlots_[elementName] = index;
+            if (element == 0 && elementName != baseName) {
+                uniformSlots_[baseName] = index;
+            }
+        }
+    }
+}
+
+int Shader::findUniform(const std::string& name) const {
+    auto it = uniformSlots_.find(name);
+    return it == uniformSlots_.end() ? -1 : it->second;
+}
+
+bool Shader::storeValue(int slot, const void* value, size_t bytes) const {
+    UniformSlot& uniform = uniforms_[slot];
+    if (uniform.hasValue && std::memcmp(uniform.value, value, bytes) == 0) {
+        uniformStats_.redundantSkipped++;
+        return false;
+    }
+    std::memcpy(uniform.value, value, bytes);
+    uniform.hasValue = true;
+    uniformStats_.uploads++;
+    return true;
+}
+
+bool Shader::typeAccepts(GLenum glslType, GLenum expected) {
+    if (glslType == expected) {
+        return true;
+    }
+    if (expected == GL_INT || expected == GL_BOOL) {
+        // glUniform1i sets ints, bools and samplers alike
+        switch (glslType) {
+        case GL_INT: case GL_BOOL:
+        case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE: case GL_SAMPLER_2D_ARRAY:
+            return true;
+        default:
+            return false;
+        }
+    }
+    return expected == GL_FLOAT && glslType == GL_BOOL; // glUniform1f may set a bool
+}
+
+bool Shader::checkUniformType(int slot, GLenum expected, const std::string& name) const {
+    if (typeAccepts(uniforms_[slot].type, expected)) {
+        return true;
+    }
+    std::cerr << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH: '" << name << "' has GL type 0x" << std::hex << uniforms_[slot].type
+              << ", the handle sets 0x" << expected << std::dec << std::endl;
+    return false;
+}
+
+void Shader::setUniform(int slot, bool value) const {
+    setUniform(slot, static_cast<int>(value));
+}
+
+void Shader::setUniform(int slot, int value) const {
+    if (storeValue(slot, &value, sizeof(value))) glUniform1i(uniforms_[slot].location, value);
+}
+
+void Shader::setUniform(int slot, float value) const {
+    if (storeValue(slot, &value, sizeof(value))) glUniform1f(uniforms_[slot].location, value);
+}
+
+void Shader::setUniform(int slot, const glm::vec2& value) const {
+    if (storeValue(slot, glm::value_ptr(value), sizeof(float) * 2)) glUniform2fv(uniforms_[slot].location, 1, glm::value_ptr(value));
+}
+
+void Shader::setUniform(int slot, const glm::vec3& value) const {
+    if (storeValue(slot, glm::value_ptr(value), sizeof(float) * 3)) glUniform3fv(uniforms_[slot].location, 1, glm::value_ptr(value));
+}
+
+void Shader::setUniform(int slot, const glm::vec4& value) const {
+    if (storeValue(slot, glm::value_ptr(value), sizeof(float) * 4)) glUniform4fv(uniforms_[slot].location, 1, glm::value_ptr(value));
+}
+
+void Shader::setUniform(int slot, const glm::mat4& value) const {
+    if (storeValue(slot, glm::value_ptr(value), sizeof(float) * 16)) glUniformMatrix4fv(uniforms_[slot].location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+bool Shader::bindUniformBlock(const std::string& blockName, GLuint bindingPoint, size_t expectedSize) const {
+    if (ID == 0) {
+        return false;
+    }
+    GLuint blockIndex = glGetUniformBlockIndex(ID, blockName.c_str());
+    if (blockIndex == GL_INVALID_INDEX) {
+        return false;
+    }
+    GLint dataSize = 0;
+    glGetActiveUniformBlockiv(ID, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+    if (expectedSize != 0 && static_cast<size_t>(dataSize) != expectedSize) {
+        std::cerr << "ERROR::SHADER::UNIFORM_BLOCK_SIZE: '" << blockName << "' is " << dataSize << " bytes, its buffer "
+                  << expectedSize << std::endl;
+    }
+    glUniformBlockBinding(ID, blockIndex, bindingPoint);
+    return true;
 }
 
 Shader::~Shader() {
@@ -79,26 +215,42 @@ void Shader::use() {
     }
 }
 
+// The by-name setters go through the location table; names the program lacks are counted and ignored, which is
+// what glUniform* did with the -1 location glGetUniformLocation returned for them
 void Shader::setBool(const std::string &name, bool value) const {
-    if (ID != 0) glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setInt(name, static_cast<int>(value));
 }
 void Shader::setInt(const std::string &name, int value) const {
-    if (ID != 0) glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    int slot = findUniform(name);
+    if (slot >= 0) setUniform(slot, value); else uniformStats_.unknownNames++;
 }
 void Shader::setFloat(const std::string &name, float value) const {
-    if (ID != 0) glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    int slot = findUniform(name);
+    if (slot >= 0) setUniform(slot, value); else uniformStats_.unknownNames++;
 }
 
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-    if (ID != 0) glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    int slot = findUniform(name);
+    if (slot >= 0) setUniform(slot, mat); else uniformStats_.unknownNames++;
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    if (ID != 0) glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    int slot = findUniform(name);
+    if (slot >= 0) setUniform(slot, value); else uniformStats_.unknownNames++;
 }
 
 void Shader::setVec3(const std::string &name, float x, float y, float z) const {
-    if (ID != 0) glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    setVec3(name, glm::vec3(x, y, z));
+}
+
+void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
+    int slot = findUniform(name);
+    if (slot >= 0) setUniform(slot, value); else uniformStats_.unknownNames++;
+}
+
+void Shader::setVec4(const std::string &name, const glm::vec4 &value) const {
+    int slot = findUniform(name);
+    if (slot >= 0) setUniform(slot, value); else uniformStats_.unknownNames++;
 }
 
 void Shader::checkCompileErrors(unsigned int shader, std::string type) {
@@ -0,0 +1,58 @@
+#include "ThreadPool.h"
+#include <algorithm> // For std::max
+#include <iostream>
+
+ThreadPool::ThreadPool(int threadCount) : stopping_(false) {
+    threadCount = std::max(1, threadCount);
+    threads_.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+    std::cout << "ThreadPool: started " << threadCount << " worker threads." << std::endl;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+size_t ThreadPool::getQueuedJobs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+int ThreadPool::defaultThreadCount() {
+    int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency()); // 0 if unknown
+    return std::max(1, hardwareThreads - 1);
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        job();
+    }
+}
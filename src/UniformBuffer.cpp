@@ -0,0 +1,51 @@
+#include "UniformBuffer.h"
+#include <iostream>
+#include <cstring> // For std::memcmp, std::memcpy
+
+UniformBuffer::UniformBuffer()
+    : buffer_(0), bindingPoint_(0), hasContents_(false), uploads_(0) {}
+
+UniformBuffer::~UniformBuffer() {
+    if (buffer_ != 0) {
+        glDeleteBuffers(1, &buffer_);
+    }
+}
+
+void UniformBuffer::create(GLuint bindingPoint, size_t size) {
+    if (buffer_ == 0) {
+        glGenBuffers(1, &buffer_);
+    }
+    bindingPoint_ = bindingPoint;
+    shadow_.assign(size, 0);
+    hasContents_ = false;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    bind();
+}
+
+bool UniformBuffer::update(const void* data, size_t size) {
+    if (buffer_ == 0 || size != shadow_.size()) {
+        std::cerr << "UniformBuffer::update(): " << size << " bytes for a block of " << shadow_.size()
+                  << (buffer_ == 0 ? " (buffer not created)" : "") << std::endl;
+        return false;
+    }
+    if (hasContents_ && std::memcmp(shadow_.data(), data, size) == 0) {
+        return false;
+    }
+    std::memcpy(shadow_.data(), data, size);
+    hasContents_ = true;
+    uploads_++;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return true;
+}
+
+void UniformBuffer::bind() const {
+    if (buffer_ != 0) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint_, buffer_);
+    }
+}
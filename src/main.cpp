@@ -2,6 +2,10 @@
 #include <vector>
 #include <string>
 #include <limits> // For Mesh.h AABB initialization
+#include <cstdlib> // For std::atoi
+#include <algorithm> // For std::max
+#include <chrono>    // For timing terrain updates
+#include <cmath>     // For std::sqrt
 
 // GLAD (must be included before GLFW)
 #include <glad/glad.h>
@@ -22,13 +26,17 @@
 #include "Frustum.h" // Include Frustum
 #include "terrain_manager.h" // Manages terrain chunks
 #include "terrain_chunk.h"   // For Chunk static members if needed directly
+#include "AllocationCounter.h" // Chunk-load allocation counts (TERRAIN_COUNT_ALLOCATIONS builds)
+#include "ScratchArena.h"
+#include "UniformBuffer.h"
+#include "terrain_uniforms.h" // std140 blocks shared by the terrain shaders
 
 // Window dimensions (use unsigned int for consistency with GLFW getframebuffersize)
 unsigned int SCR_WIDTH = 1280; // Increased resolution for better detail
 unsigned int SCR_HEIGHT = 720;
 
 // Camera
-Camera camera(glm::vec3(0.0f, 25.0f, 40.0f)); // Adjusted initial camera position
+Camera camera(glm::dvec3(0.0, 25.0, 40.0)); // Adjusted initial camera position
 float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
@@ -43,8 +51,165 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+void runCullBenchmark(int radius);
+int runPrecisionCheck(double distance);
+
+int main(int argc, char** argv) {
+    // Command line: --radius N sets the chunk load radius, --no-lod draws every chunk at full resolution,
+    // --mode cdlod switches to the quadtree renderer (view distance set by --view-distance, in world units),
+    // --mode clipmap to the geometry clipmap renderer; --mesher rtin builds chunk meshes adaptively
+    // within --rtin-error world units of the full grid, --mesher displaced uploads only chunk heights;
+    // --keep-cpu-mesh keeps chunk vertices/indices in RAM after upload (default: GPU only);
+    // --seed N picks the terrain (default: a new random terrain every run, its seed is printed), --chunk-cache DIR
+    // caches chunk heights on disk under DIR (off by default; it only hits again across runs with the same --seed,
+    // and it is not size-limited, so clear DIR when it gets too big), --no-chunk-cache turns it back off;
+    // --no-cluster-culling draws whole chunk meshes, --no-culling also skips the chunk frustum test, and
+    // --no-cull-tree tests every chunk against the frustum instead of quadtree blocks of chunks;
+    // --workers N sets the chunk generation threads (default: hardware threads - 1, 0 = on the render thread);
+    // --upload-budget-kb N and --upload-budget-ms X cap the chunk uploads per frame (most wanted chunks first);
+    // --no-load-priority builds and uploads chunks nearest first, ignoring heading, speed and the frustum;
+    // --unload-radius N keeps chunks loaded out to N chunks (default: radius + 1), and chunks beyond it go to an
+    // LRU of --evicted-cache-mb MB (0 disables) that keeps them uploaded, or only their heights with --evict-heights-only;
+    // --no-pooling creates and deletes chunk objects and their GL buffers instead of recycling them;
+    // --region circle|ellipse|budget loads a circle of the radius, an ellipse pushed ahead along the view, or the
+    // --region-budget N best chunks by load priority instead of the whole square (--region square);
+    // --prefetch-horizon S builds the chunks the camera's path will need over the next S seconds while the workers
+    // are idle (default 2), --no-prefetch turns that off;
+    // --adaptive-radius MIN MAX lets the frame time pick the load radius (and LOD bias) within MIN..MAX, holding
+    // frames near --target-frame-ms X (default 16.7; vsync is turned off so frame times show the actual load);
+    // --cull-backend scalar|avx2|avx512 picks the instruction set of the batched cluster culling (default: the best
+    // the CPU has), and --cull-benchmark N times the per-frame cluster batch against one-box-at-a-time culling at radius N, then exits;
+    // --start X Z starts the camera at world position (X, Z), and --precision-check D measures the screen error of
+    // the chunk transforms D units from the world origin (absolute float vs camera-relative), then exits;
+    // --far-field-radius N draws N rings of coarse 4x4-chunk tiles beyond the loaded chunks (default 12, ~3 km),
+    // --no-far-field draws the chunks alone
+    int loadRadius = 2; 
+    int unloadRadius = -1;
+    EvictedChunkSettings evictedChunkSettings;
+    bool enableLod = true;
+    TerrainRenderMode renderMode = TerrainRenderMode::Chunks;
+    float cdlodViewDistance = CdlodSettings().viewDistance;
+    unsigned int terrainSeed = 0;
+    bool randomSeed = true;
+    CullingSettings cullingSettings;
+    int workerThreads = -1;
+    UploadBudget uploadBudget;
+    ChunkPrioritySettings chunkPriority;
+    PoolingSettings pooling;
+    LoadRegionSettings loadRegion;
+    PrefetchSettings prefetch;
+    AdaptiveRadiusSettings adaptiveRadius;
+    FarFieldSettings farField;
+    std::string chunkCacheDirectory; // Empty: no disk cache
+    int cullBenchmarkRadius = -1;
+    double precisionCheckDistance = -1.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--radius" && i + 1 < argc) {
+            loadRadius = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--no-lod") {
+            enableLod = false;
+        } else if (arg == "--mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "cdlod") renderMode = TerrainRenderMode::Cdlod;
+            else if (mode == "clipmap") renderMode = TerrainRenderMode::Clipmap;
+            else if (mode == "chunks") renderMode = TerrainRenderMode::Chunks;
+            else std::cerr << "Unknown render mode: " << mode << std::endl;
+        } else if (arg == "--mesher" && i + 1 < argc) {
+            std::string mesher = argv[++i];
+            if (mesher == "rtin") Chunk::MESH_BUILDER = ChunkMeshBuilder::Rtin;
+            else if (mesher == "displaced") Chunk::MESH_BUILDER = ChunkMeshBuilder::Displaced;
+            else if (mesher == "grid") Chunk::MESH_BUILDER = ChunkMeshBuilder::Grid;
+            else std::cerr << "Unknown mesher: " << mesher << std::endl;
+        } else if (arg == "--rtin-error" && i + 1 < argc) {
+            Chunk::RTIN_MAX_ERROR = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            terrainSeed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            randomSeed = false;
+        } else if (arg == "--random-seed") { // The default; kept for scripts that pass it
+            randomSeed = true;
+        } else if (arg == "--chunk-cache" && i + 1 < argc) {
+            chunkCacheDirectory = argv[++i];
+        } else if (arg == "--no-chunk-cache") {
+            chunkCacheDirectory.clear();
+        } else if (arg == "--workers" && i + 1 < argc) {
+            workerThreads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--upload-budget-kb" && i + 1 < argc) {
+            uploadBudget.maxBytesPerFrame = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) * 1024;
+        } else if (arg == "--unload-radius" && i + 1 < argc) {
+            unloadRadius = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--evicted-cache-mb" && i + 1 < argc) {
+            evictedChunkSettings.maxBytes = static_cast<size_t>(std::max(0, std::atoi(argv[++i]))) * 1024 * 1024;
+        } else if (arg == "--evict-heights-only") {
+            evictedChunkSettings.keepGpuBuffers = false;
+        } else if (arg == "--no-pooling") {
+            pooling.enabled = false;
+        } else if (arg == "--region" && i + 1 < argc) {
+            std::string shape = argv[++i];
+            if (shape == "square") loadRegion.shape = LoadRegionShape::Square;
+            else if (shape == "circle") loadRegion.shape = LoadRegionShape::Circle;
+            else if (shape == "ellipse") loadRegion.shape = LoadRegionShape::ViewEllipse;
+            else if (shape == "budget") loadRegion.shape = LoadRegionShape::Budget;
+            else std::cerr << "Unknown load region: " << shape << " (expected square, circle, ellipse or budget)" << std::endl;
+        } else if (arg == "--region-budget" && i + 1 < argc) {
+            loadRegion.shape = LoadRegionShape::Budget;
+            loadRegion.budgetChunks = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--prefetch-horizon" && i + 1 < argc) {
+            prefetch.horizonSeconds = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--no-prefetch") {
+            prefetch.enabled = false;
+        } else if (arg == "--adaptive-radius" && i + 2 < argc) {
+            adaptiveRadius.enabled = true;
+            adaptiveRadius.minRadius = std::max(0, std::atoi(argv[++i]));
+            adaptiveRadius.maxRadius = std::max(adaptiveRadius.minRadius, std::atoi(argv[++i]));
+        } else if (arg == "--target-frame-ms" && i + 1 < argc) {
+            adaptiveRadius.targetFrameMs = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--far-field-radius" && i + 1 < argc) {
+            farField.radiusTiles = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--no-far-field") {
+            farField.enabled = false;
+        } else if (arg == "--no-load-priority") {
+            chunkPriority.enabled = false;
+        } else if (arg == "--upload-budget-ms" && i + 1 < argc) {
+            uploadBudget.maxMsPerFrame = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--no-cluster-culling") {
+            cullingSettings.clusters = false;
+        } else if (arg == "--no-cull-tree") {
+            cullingSettings.hierarchical = false;
+        } else if (arg == "--no-culling") {
+            cullingSettings.frustum = false;
+            cullingSettings.clusters = false;
+        } else if (arg == "--cull-backend" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "scalar") Frustum::setCullBackend(CullBackend::Scalar);
+            else if (backend == "avx2") Frustum::setCullBackend(CullBackend::AVX2);
+            else if (backend == "avx512") Frustum::setCullBackend(CullBackend::AVX512);
+            else std::cerr << "Unknown cull backend: " << backend << " (expected scalar, avx2 or avx512)" << std::endl;
+        } else if (arg == "--cull-benchmark" && i + 1 < argc) {
+            cullBenchmarkRadius = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--precision-check" && i + 1 < argc) {
+            precisionCheckDistance = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--start" && i + 2 < argc) {
+            camera.Position.x = std::atof(argv[++i]);
+            camera.Position.z = std::atof(argv[++i]);
+        } else if (arg == "--keep-cpu-mesh") {
+            Chunk::MESH_RESIDENCY = MeshResidency::CpuAndGpu;
+        } else if (arg == "--view-distance" && i + 1 < argc) {
+            cdlodViewDistance = std::max(64.0f, static_cast<float>(std::atof(argv[++i])));
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+        }
+    }
+    std::cout << "Cluster culling backend: " << Frustum::cullBackendName(Frustum::getCullBackend())
+              << " (best available: " << Frustum::cullBackendName(Frustum::bestCullBackend()) << ")" << std::endl;
+    if (cullBenchmarkRadius >= 0) {
+        runCullBenchmark(cullBenchmarkRadius); // Needs no window
+        return 0;
+    }
+    if (precisionCheckDistance >= 0.0) {
+        return runPrecisionCheck(precisionCheckDistance); // Needs no window either
+    }
 
-int main() {
     // Initialize GLFW
     if (!glfwInit()) {
         std::cerr << "GLFW initialization failed!" << std::endl;
@@ -67,6 +232,9 @@ int main() {
         return -1;
     }
     glfwMakeContextCurrent(window);
+    if (adaptiveRadius.enabled) {
+        glfwSwapInterval(0); // Synced frames would all take the refresh interval, hiding how much headroom is left
+    }
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
@@ -90,6 +258,12 @@ int main() {
     Shader terrainShader("../shaders/basic.vert", "../shaders/basic.frag");
     if (terrainShader.getID() == 0) { std::cerr << "Failed to load shaders." << std::endl; glfwTerminate(); return -1; }
     
+    Shader cdlodShader("../shaders/cdlod.vert", "../shaders/basic.frag");
+    if (renderMode == TerrainRenderMode::Cdlod && cdlodShader.getID() == 0) { std::cerr << "Failed to load CDLOD shaders." << std::endl; glfwTerminate(); return -1; }
+
+    Shader clipmapShader("../shaders/clipmap.vert", "../shaders/basic.frag");
+    if (renderMode == TerrainRenderMode::Clipmap && clipmapShader.getID() == 0) { std::cerr << "Failed to load clipmap shaders." << std::endl; glfwTerminate(); return -1; }
+
     Shader skyboxShader("../shaders/skybox.vert", "../shaders/skybox.frag");
     if (skyboxShader.getID() == 0) { std::cerr << "Failed to load skybox shaders." << std::endl; glfwTerminate(); return -1; }
 
@@ -153,8 +327,37 @@ int main() {
     Chunk::CHUNK_VERTEX_RESOLUTION_X = 33; 
     Chunk::CHUNK_VERTEX_RESOLUTION_Z = 33;
 
-    int loadRadius = 2; 
-    TerrainManager terrainManager(loadRadius);
+    if (randomSeed) {
+        terrainSeed = std::random_device()();
+    }
+    std::cout << "Terrain seed " << terrainSeed << " (--seed " << terrainSeed << " reproduces this terrain)" << std::endl;
+    TerrainManager terrainManager(loadRadius, terrainSeed);
+    terrainManager.chunkCacheDirectory = chunkCacheDirectory;
+    terrainManager.lodSettings.enabled = enableLod;
+    terrainManager.cullingSettings = cullingSettings;
+    terrainManager.workerThreads = workerThreads;
+    terrainManager.uploadBudget = uploadBudget;
+    terrainManager.chunkPriority = chunkPriority;
+    terrainManager.unloadRadius = unloadRadius;
+    terrainManager.evictedChunkSettings = evictedChunkSettings;
+    terrainManager.pooling = pooling;
+    terrainManager.loadRegion = loadRegion;
+    terrainManager.prefetch = prefetch;
+    terrainManager.adaptiveRadius = adaptiveRadius;
+    terrainManager.farField = farField;
+    terrainManager.renderMode = renderMode;
+    terrainManager.cdlodSettings.viewDistance = cdlodViewDistance;
+    bool cdlodMode = renderMode == TerrainRenderMode::Cdlod;
+    bool clipmapMode = renderMode == TerrainRenderMode::Clipmap;
+    bool farFieldMode = !cdlodMode && !clipmapMode && farField.enabled;
+    // CDLOD, clipmaps and the far field draw kilometers of terrain: push the far plane out and thin the fog to match
+    float farPlane = 1000.0f;
+    if (cdlodMode) farPlane = cdlodViewDistance * 1.1f;
+    if (clipmapMode) farPlane = ClipmapTerrain::computeExtent(terrainManager.clipmapSettings) * 1.5f;
+    if (farFieldMode) farPlane = FarFieldTerrain::computeExtent(farField) * 1.1f;
+    bool wideView = cdlodMode || clipmapMode || farFieldMode;
+    float nearPlane = wideView ? 1.0f : 0.1f;
+    float fogDensity = wideView ? 2.0f / farPlane : 0.015f;
     // --- End Terrain Manager Setup ---
 
     Frustum cameraFrustum; // Create a Frustum object
@@ -164,12 +367,57 @@ int main() {
     terrainShader.setInt("textureGrass", 0);
     terrainShader.setInt("textureRock", 1);
     terrainShader.setInt("textureSnow", 2);
+    cdlodShader.use();
+    cdlodShader.setInt("textureGrass", 0);
+    cdlodShader.setInt("textureRock", 1);
+    cdlodShader.setInt("textureSnow", 2);
+    clipmapShader.use();
+    clipmapShader.setInt("textureGrass", 0);
+    clipmapShader.setInt("textureRock", 1);
+    clipmapShader.setInt("textureSnow", 2);
 
     skyboxShader.use();
     skyboxShader.setInt("skybox", 0);
 
+    // Camera, light and fog go to every terrain shader through one uniform buffer, written once per frame; the
+    // material block never changes, so it is written here once
+    UniformBuffer frameUniformBuffer;
+    UniformBuffer materialUniformBuffer;
+    frameUniformBuffer.create(FRAME_UNIFORM_BINDING, sizeof(FrameUniformBlock));
+    materialUniformBuffer.create(MATERIAL_UNIFORM_BINDING, sizeof(MaterialUniformBlock));
+    for (Shader* shader : { &terrainShader, &cdlodShader, &clipmapShader }) {
+        shader->bindUniformBlock("FrameUniforms", FRAME_UNIFORM_BINDING, sizeof(FrameUniformBlock));
+        shader->bindUniformBlock("MaterialUniforms", MATERIAL_UNIFORM_BINDING, sizeof(MaterialUniformBlock));
+    }
+    MaterialUniformBlock material = {};
+    material.heightRockStart = Chunk::TERRAIN_MAX_HEIGHT * 0.35f; // Use Chunk's static max height
+    material.heightRockFull = Chunk::TERRAIN_MAX_HEIGHT * 0.55f;
+    material.heightSnowStart = Chunk::TERRAIN_MAX_HEIGHT * 0.70f;
+    material.heightSnowFull = Chunk::TERRAIN_MAX_HEIGHT * 0.85f;
+    material.textureTilingFactor = 16.0f;
+    material.specularStrength = 0.4f;
+    material.shininess = 32;
+    materialUniformBuffer.update(material);
+    FrameUniformBlock frameUniforms = {};
+
+    UniformHandle<glm::mat4> skyboxViewUniform = skyboxShader.uniform<glm::mat4>("view");
+    UniformHandle<glm::mat4> skyboxProjectionUniform = skyboxShader.uniform<glm::mat4>("projection");
+    Shader& activeTerrainShader = cdlodMode ? cdlodShader : (clipmapMode ? clipmapShader : terrainShader);
+
     // unsigned int framesRendered = 0; // For simple culling feedback
 
+    // Frame-time and triangle statistics, printed every couple of seconds
+    float statsTimer = 0.0f;
+    int statsFrames = 0;
+    float statsMaxFrameTime = 0.0f;
+    double statsFrameTimeSquares = 0.0; // For the frame time standard deviation (hitches from streaming)
+    double statsUpdateMs = 0.0;    // Terrain update cost: chunk streaming, or clipmap strip updates
+    double statsMaxUpdateMs = 0.0;
+
+    // Start the frame clock here, so the first deltaTime does not include the setup above (it would make the
+    // first frame look like a multi-second hitch to the stats and the adaptive radius controller)
+    lastFrame = static_cast<float>(glfwGetTime());
+
     // Render loop
     while (!glfwWindowShouldClose(window)) {
         float currentFrame = static_cast<float>(glfwGetTime());
@@ -178,41 +426,157 @@ int main() {
 
         processInput(window);
 
+        statsTimer += deltaTime;
+        statsFrames++;
+        statsMaxFrameTime = std::max(statsMaxFrameTime, deltaTime);
+        statsFrameTimeSquares += static_cast<double>(deltaTime) * deltaTime;
+        if (statsTimer >= 2.0f) {
+            double meanFrameTime = statsTimer / statsFrames;
+            double frameTimeStddev = std::sqrt(std::max(0.0, statsFrameTimeSquares / statsFrames - meanFrameTime * meanFrameTime));
+            const TerrainRenderStats& renderStats = terrainManager.getLastRenderStats();
+            std::cout << "[Stats] radius " << terrainManager.loadRadius;
+            if (terrainManager.adaptiveRadius.enabled) {
+                const AdaptiveRadiusStatus& adaptive = terrainManager.getAdaptiveRadiusStatus();
+                std::cout << " (adaptive " << terrainManager.adaptiveRadius.minRadius << ".." << terrainManager.adaptiveRadius.maxRadius
+                          << ", LOD bias " << adaptive.lodBias << ", " << adaptive.radiusIncreases << " up / "
+                          << adaptive.radiusDecreases << " down, backlog " << adaptive.backlog << ")";
+            }
+            std::cout << (terrainManager.lodSettings.enabled ? ", LOD on" : ", LOD off")
+                      << ": avg frame " << (statsTimer / statsFrames) * 1000.0f << " ms"
+                      << ", max " << statsMaxFrameTime * 1000.0f << " ms, stddev " << frameTimeStddev * 1000.0 << " ms"
+                      << ", terrain update avg " << statsUpdateMs / statsFrames << " ms, max " << statsMaxUpdateMs << " ms"
+                      << ", " << renderStats.chunksDrawn << " chunks"
+                      << ", " << renderStats.trianglesDrawn << " triangles, per level:";
+            for (int count : renderStats.chunksPerLevel) std::cout << " " << count;
+            if (renderStats.boundsTested > 0) {
+                std::cout << ", " << renderStats.boundsTested << " frustum tests";
+            }
+            if (renderStats.chunksCulled > 0) {
+                std::cout << ", " << renderStats.chunksCulled << " chunks frustum-culled";
+                if (renderStats.blocksCulled > 0) {
+                    std::cout << " (" << renderStats.blocksCulled << " whole blocks)";
+                }
+            }
+            if (renderStats.clusters.clustersTested > 0) {
+                const ClusterCullStats& clusterStats = renderStats.clusters;
+                std::cout << ", clusters culled " << (100.0 * (clusterStats.frustumCulled + clusterStats.backfaceCulled)) / clusterStats.clustersTested
+                          << "% of " << clusterStats.clustersTested << " (frustum " << clusterStats.frustumCulled
+                          << ", backface " << clusterStats.backfaceCulled << ")";
+            }
+            if (const CdlodTerrain* cdlod = terrainManager.getCdlodTerrain()) {
+                const CdlodStats& cdlodStats = cdlod->getStats();
+                std::cout << " (CDLOD nodes, selection " << cdlodStats.selectionMs << " ms, "
+                          << cdlodStats.tilesResident << " tiles resident)";
+            }
+            TerrainMemoryStats memoryStats = terrainManager.computeMemoryStats();
+            std::cout << ", chunk memory CPU " << memoryStats.totalCpuBytes() / 1024 << " KB, GPU "
+                      << memoryStats.totalGpuBytes() / 1024 << " KB (GPU-only/CPU+GPU/CPU-only chunks: "
+                      << memoryStats.perPolicy[0].chunks << "/" << memoryStats.perPolicy[1].chunks << "/"
+                      << memoryStats.perPolicy[2].chunks << ")";
+            const TerrainLoadStats& loadStats = terrainManager.getLoadStats();
+            if (!cdlodMode && !clipmapMode) {
+                TerrainStreamingStats streaming = terrainManager.getStreamingStats();
+                std::cout << ", streaming (" << streaming.workerThreads << " workers): " << streaming.queued << " queued, "
+                          << streaming.generating << " generating, " << streaming.readyToUpload << " waiting to upload, "
+                          << streaming.resident << " resident (load region " << streaming.regionChunks << ")";
+                if (loadStats.chunksLoaded > 0) {
+                    std::cout << ", upload avg " << loadStats.uploadMs / loadStats.chunksLoaded << " ms, max " << loadStats.maxUploadMs << " ms"
+                              << ", per frame max " << loadStats.maxFrameUploadBytes / 1024 << " KB / " << loadStats.maxFrameUploadMs << " ms"
+                              << " (" << loadStats.framesBudgetLimited << " frames over budget)"
+                              << ", time to visible avg " << loadStats.timeToVisibleMs / loadStats.chunksLoaded << " ms, max "
+                              << loadStats.maxTimeToVisibleMs << " ms";
+                }
+                const MeshBufferPoolStats& bufferStats = MeshBufferPool::instance().getStats();
+                std::cout << ", chunk objects " << loadStats.chunksCreated << " new / " << loadStats.chunksRecycled << " recycled"
+                          << ", GL buffer sets " << bufferStats.setsCreated << " created / " << bufferStats.setsDeleted << " deleted / "
+                          << bufferStats.setsReused << " reused, " << bufferStats.storageAllocations << " glBufferData / "
+                          << bufferStats.storageUpdates << " glBufferSubData (" << bufferStats.idleSets << " idle sets, "
+                          << bufferStats.idleBytes / 1024 << " KB)";
+                MeshBufferPool::instance().resetStats();
+                if (loadStats.chunksCancelled > 0) {
+                    std::cout << ", " << loadStats.chunksCancelled << " cancelled (" << loadStats.cancelledBeforeBuild << " before generation)";
+                }
+                if (loadStats.evictedCacheHits + loadStats.evictedCacheMisses > 0 || streaming.evicted > 0) {
+                    std::cout << ", evicted cache " << loadStats.evictedCacheHits << " hits / " << loadStats.evictedCacheMisses << " misses, "
+                              << streaming.evicted << " chunks (" << streaming.evictedBytes / 1024 << " KB)";
+                }
+                if (loadStats.prefetchesQueued + loadStats.prefetchesUsed + loadStats.prefetchesWasted > 0) {
+                    std::cout << ", prefetch " << loadStats.prefetchesQueued << " queued / " << loadStats.prefetchesUsed << " used / "
+                              << loadStats.prefetchesWasted << " wasted";
+                }
+                std::cout << ", " << loadStats.popIns << " pop-ins";
+                if (const FarFieldTerrain* farFieldTerrain = terrainManager.getFarFieldTerrain()) {
+                    const FarFieldStats& farStats = farFieldTerrain->getStats();
+                    std::cout << ", far field " << farStats.tilesDrawn << " tiles drawn (" << farStats.cellsDrawn << " cells, "
+                              << farStats.cellsReplaced << " replaced by chunks, " << farStats.trianglesDrawn << " triangles), "
+                              << streaming.farTilesResident << " resident / " << streaming.farTilesPending << " pending, "
+                              << farStats.tilesBuilt << " built (avg "
+                              << (farStats.tilesBuilt ? farStats.buildMs / farStats.tilesBuilt : 0.0) << " ms)";
+                    terrainManager.resetFarFieldBuildStats();
+                }
+            }
+            if (loadStats.chunksLoaded > 0) {
+                size_t heightLoads = loadStats.cacheHits + loadStats.heightsGenerated;
+                std::cout << ", chunk heights: cache hit rate " << (100.0 * loadStats.cacheHits) / std::max<size_t>(heightLoads, 1) << "%"
+                          << ", read avg " << (loadStats.cacheHits ? loadStats.cacheReadMs / loadStats.cacheHits : 0.0) << " ms"
+                          << ", generate avg " << (loadStats.heightsGenerated ? loadStats.generateMs / loadStats.heightsGenerated : 0.0) << " ms"
+                          << ", write avg " << (loadStats.heightsGenerated ? loadStats.cacheWriteMs / loadStats.heightsGenerated : 0.0) << " ms";
+            }
+            if (loadStats.indexedChunks > 0) {
+                std::cout << ", chunk indices " << loadStats.indexBytesBefore / loadStats.indexedChunks << " -> "
+                          << loadStats.indexBytesAfter / loadStats.indexedChunks << " bytes avg, ACMR "
+                          << loadStats.acmrBefore / loadStats.indexedChunks << " -> " << loadStats.acmrAfter / loadStats.indexedChunks;
+            }
+            if (AllocationCounter::isEnabled() && loadStats.chunksLoaded > 0) {
+                std::cout << ", " << loadStats.chunksLoaded << " chunk loads, heap allocations avg "
+                          << loadStats.heapAllocations / loadStats.chunksLoaded << " max " << loadStats.maxHeapAllocations
+                          << ", scratch high water " << ScratchArena::forThread().getHighWaterBytes() / 1024 << " KB";
+            }
+            const ShaderUniformStats& uniformStats = activeTerrainShader.getUniformStats();
+            std::cout << ", terrain shader uniforms " << uniformStats.uploads << " uploaded / " << uniformStats.redundantSkipped
+                      << " unchanged skipped";
+            if (uniformStats.unknownNames > 0) {
+                std::cout << " / " << uniformStats.unknownNames << " unknown names";
+            }
+            activeTerrainShader.resetUniformStats();
+            terrainManager.resetLoadStats();
+            std::cout << std::endl;
+            statsTimer = 0.0f;
+            statsFrames = 0;
+            statsMaxFrameTime = 0.0f;
+            statsFrameTimeSquares = 0.0;
+            statsUpdateMs = 0.0;
+            statsMaxUpdateMs = 0.0;
+        }
+
         // --- Update ---
+        terrainManager.reportFrameTime(deltaTime * 1000.0f);
+        auto updateStart = std::chrono::high_resolution_clock::now();
         terrainManager.update(camera); // Update terrain based on camera position
+        double updateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - updateStart).count();
+        statsUpdateMs += updateMs;
+        statsMaxUpdateMs = std::max(statsMaxUpdateMs, updateMs);
 
         glClearColor(currentFogColor.r, currentFogColor.g, currentFogColor.b, 1.0f); 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        // glm::mat4 viewProjectionMatrix = projection * view; // Already calculated if needed for frustum
-        // cameraFrustum.update(viewProjectionMatrix); // Frustum update is fine here
-
-        // --- Render Terrain Chunks ---
-        terrainShader.use();
-        terrainShader.setMat4("projection", projection);
-        terrainShader.setMat4("view", view);
-        
-        // Texturing uniforms (already here, good)
-        terrainShader.setFloat("heightRockStart", Chunk::TERRAIN_MAX_HEIGHT * 0.35f); // Use Chunk's static max height
-        terrainShader.setFloat("heightRockFull",  Chunk::TERRAIN_MAX_HEIGHT * 0.55f);
-        terrainShader.setFloat("heightSnowStart", Chunk::TERRAIN_MAX_HEIGHT * 0.70f);
-        terrainShader.setFloat("heightSnowFull",  Chunk::TERRAIN_MAX_HEIGHT * 0.85f);
-        terrainShader.setFloat("textureTilingFactor", 16.0f);
-
-        // Lighting uniforms (already here, good)
-        glm::vec3 lightDirection_main = glm::normalize(glm::vec3(-0.5f, -1.0f, -0.3f));
-        terrainShader.setVec3("lightDir_world", lightDirection_main);
-        terrainShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 0.95f));
-        terrainShader.setFloat("ambientStrength", 0.25f);
-        terrainShader.setVec3("viewPos_world", camera.Position); 
-        terrainShader.setFloat("specularStrength", 0.4f);      
-        terrainShader.setInt("shininess", 32);                 
-
-        // Fog uniforms (already here, good)
-        terrainShader.setVec3("fogColor", currentFogColor);
-        terrainShader.setFloat("fogDensity", 0.015f); 
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, nearPlane, farPlane);
+        glm::mat4 view = camera.GetViewMatrix(); // Relative to camera.GetRenderOrigin(), like everything drawn below
+        glm::mat4 viewProjectionMatrix = projection * view;
+        cameraFrustum.update(viewProjectionMatrix, camera.GetRenderOrigin()); // Planes in absolute world space
+
+        // All terrain shaders share basic.frag, so they read the same frame block: one upload per frame
+        frameUniforms.viewProjection = viewProjectionMatrix;
+        frameUniforms.lightDir_world = glm::normalize(glm::vec3(-0.5f, -1.0f, -0.3f));
+        frameUniforms.ambientStrength = 0.25f;
+        frameUniforms.lightColor = glm::vec3(1.0f, 1.0f, 0.95f);
+        frameUniforms.viewPos_world = glm::vec3(camera.Position - camera.GetRenderOrigin());
+        frameUniforms.fogColor = currentFogColor;
+        frameUniforms.fogDensity = fogDensity;
+        frameUniformBuffer.update(frameUniforms);
+        frameUniformBuffer.bind();
+        materialUniformBuffer.bind();
+        activeTerrainShader.use();
 
         // Bind textures once before rendering all chunks (already here, good)
         glActiveTexture(GL_TEXTURE0);
@@ -222,16 +586,23 @@ int main() {
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, snowTexture);
 
-        // vvv UNCOMMENT OR ADD THIS LINE vvv
-        terrainManager.renderActiveChunks(terrainShader); 
-        // ^^^ END OF CHANGE ^^^
+        if (cdlodMode) {
+            terrainManager.renderCdlod(cdlodShader, cameraFrustum, camera.Position);
+        } else if (clipmapMode) {
+            terrainManager.renderClipmap(clipmapShader, camera.Position);
+        } else {
+            // LOD selection works in pixels, so keep it in sync with the framebuffer and zoom
+            terrainManager.lodSettings.viewportHeight = static_cast<float>(SCR_HEIGHT);
+            terrainManager.lodSettings.fovYRadians = glm::radians(camera.Zoom);
+            terrainManager.renderActiveChunks(terrainShader, cameraFrustum, camera.Position);
+        }
 
         // --- Render Skybox --- (already here, good)
         glDepthFunc(GL_LEQUAL); 
         skyboxShader.use();
         glm::mat4 skyboxView = glm::mat4(glm::mat3(camera.GetViewMatrix())); 
-        skyboxShader.setMat4("view", skyboxView);
-        skyboxShader.setMat4("projection", projection); 
+        skyboxViewUniform.set(skyboxView);
+        skyboxProjectionUniform.set(projection);
 
         glBindVertexArray(skyboxVAO);
         glActiveTexture(GL_TEXTURE0); 
@@ -304,4 +675,215 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
-}
\ No newline at end of file
+}
+// --cull-benchmark: lays out the clusters of every chunk within 'radius' the way the renderer has them (mesh-space
+// bounds per chunk, (resolution - 1) / clusterQuads clusters a side, heights like the terrain's), then turns the
+// camera through a full circle. Each step the clusters of the chunks whose bounds pass the frustum (the cull tree's
+// part, done up front) are culled one box at a time with Frustum::isAABBVisible, with one Frustum::cullBatch per
+// chunk, and gathered into one world-space batch culled with a single cullBatch as renderActiveChunks does, the
+// last two on every backend the CPU has
+void runCullBenchmark(int radius) {
+    const int clusterQuads = Chunk::MESH_INDEX_OPTIONS.clusterQuads > 0 ? Chunk::MESH_INDEX_OPTIONS.clusterQuads : Chunk::CHUNK_VERTEX_RESOLUTION_X - 1;
+    const int clustersPerSide = std::max(1, (Chunk::CHUNK_VERTEX_RESOLUTION_X - 1 + clusterQuads - 1) / clusterQuads);
+    const float chunkSize = Chunk::CHUNK_WORLD_SIZE_X;
+    const float clusterSize = chunkSize / clustersPerSide;
+    struct BenchChunk {
+        glm::vec3 center;
+        BoundingBox worldBounds;
+        AABBBatch clusters; // Mesh space, like Mesh::getClusterBounds
+    };
+    std::vector<BenchChunk> chunks;
+    for (int chunkZ = -radius; chunkZ <= radius; ++chunkZ) {
+        for (int chunkX = -radius; chunkX <= radius; ++chunkX) {
+            BenchChunk chunk;
+            chunk.center = glm::vec3(chunkX * chunkSize, 0.0f, chunkZ * chunkSize);
+            for (int z = 0; z < clustersPerSide; ++z) {
+                for (int x = 0; x < clustersPerSide; ++x) {
+                    int globalX = chunkX * clustersPerSide + x;
+                    int globalZ = chunkZ * clustersPerSide + z;
+                    BoundingBox box;
+                    float low = 10.0f + 8.0f * std::sin(globalX * 0.11f) * std::cos(globalZ * 0.07f);
+                    box.min = glm::vec3(-0.5f * chunkSize + x * clusterSize, low, -0.5f * chunkSize + z * clusterSize);
+                    box.max = glm::vec3(box.min.x + clusterSize, low + 6.0f, box.min.z + clusterSize);
+                    chunk.clusters.push_back(box);
+                    chunk.worldBounds.min = glm::min(chunk.worldBounds.min, box.min + chunk.center);
+                    chunk.worldBounds.max = glm::max(chunk.worldBounds.max, box.max + chunk.center);
+                }
+            }
+            chunks.push_back(std::move(chunk));
+        }
+    }
+
+    const int steps = 360;
+    std::vector<Frustum> frustums(steps);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 3000.0f);
+    glm::vec3 eye(0.0f, 25.0f, 0.0f);
+    std::vector<std::vector<uint32_t>> visibleChunks(steps);
+    size_t boxesTested = 0;
+    for (int step = 0; step < steps; ++step) {
+        float yaw = glm::radians(static_cast<float>(step));
+        glm::vec3 front(std::cos(yaw), -0.2f, std::sin(yaw));
+        frustums[step].update(projection * glm::lookAt(eye, eye + front, glm::vec3(0.0f, 1.0f, 0.0f)));
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            if (frustums[step].isAABBVisible(chunks[c].worldBounds)) {
+                visibleChunks[step].push_back(static_cast<uint32_t>(c));
+                boxesTested += chunks[c].clusters.size();
+            }
+        }
+    }
+
+    std::vector<uint32_t> visible(chunks.size() * clustersPerSide * clustersPerSide);
+    std::vector<size_t> expected(steps);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < steps; ++step) {
+        size_t count = 0;
+        for (uint32_t c : visibleChunks[step]) {
+            const BenchChunk& chunk = chunks[c];
+            for (size_t i = 0; i < chunk.clusters.size(); ++i) {
+                BoundingBox box;
+                box.min = glm::vec3(chunk.clusters.minX[i], chunk.clusters.minY[i], chunk.clusters.minZ[i]) + chunk.center;
+                box.max = glm::vec3(chunk.clusters.maxX[i], chunk.clusters.maxY[i], chunk.clusters.maxZ[i]) + chunk.center;
+                if (frustums[step].isAABBVisible(box)) count++;
+            }
+        }
+        expected[step] = count;
+    }
+    double scalarMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count() / steps;
+    size_t visibleTotal = 0;
+    for (size_t count : expected) visibleTotal += count;
+    std::cout << "[CullBenchmark] " << chunks.size() << " chunks of " << clustersPerSide << "x" << clustersPerSide << " clusters, "
+              << boxesTested / steps << " cluster boxes in visible chunks per pass, " << visibleTotal / steps << " visible on average" << std::endl;
+    std::cout << "[CullBenchmark] isAABBVisible per box: " << scalarMs << " ms per pass" << std::endl;
+
+    AABBBatch frameBatch;
+    CullBackend selected = Frustum::getCullBackend();
+    const CullBackend backends[3] = { CullBackend::Scalar, CullBackend::AVX2, CullBackend::AVX512 };
+    for (CullBackend backend : backends) {
+        if (static_cast<int>(backend) > static_cast<int>(Frustum::bestCullBackend())) {
+            continue;
+        }
+        Frustum::setCullBackend(backend);
+        for (int frameWide = 0; frameWide <= 1; ++frameWide) {
+            for (BenchChunk& chunk : chunks) chunk.clusters.planeHint.assign(chunk.clusters.size(), 0);
+            size_t mismatches = 0;
+            double cullOnlyMs = 0.0;
+            startTime = std::chrono::high_resolution_clock::now();
+            for (int step = 0; step < steps; ++step) {
+                size_t count = 0;
+                if (frameWide) {
+                    // Gather, cull once, hand the hints back: what TerrainManager::renderClusterBatch does per frame
+                    frameBatch.clear();
+                    for (uint32_t c : visibleChunks[step]) frameBatch.append(chunks[c].clusters, chunks[c].center);
+                    auto cullStart = std::chrono::high_resolution_clock::now();
+                    count = frustums[step].cullBatch(frameBatch, visible.data());
+                    cullOnlyMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - cullStart).count();
+                    size_t first = 0;
+                    for (uint32_t c : visibleChunks[step]) {
+                        AABBBatch& clusters = chunks[c].clusters;
+                        clusters.planeHint.assign(frameBatch.planeHint.begin() + first, frameBatch.planeHint.begin() + first + clusters.size());
+                        first += clusters.size();
+                    }
+                } else {
+                    for (uint32_t c : visibleChunks[step]) {
+                        count += frustums[step].cullBatch(chunks[c].clusters, visible.data(), chunks[c].center);
+                    }
+                }
+                if (count != expected[step]) mismatches++;
+            }
+            double batchMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count() / steps;
+            std::cout << "[CullBenchmark] cullBatch " << Frustum::cullBackendName(backend)
+                      << (frameWide ? ", one frame-wide batch: " : ", one batch per chunk: ") << batchMs << " ms per pass ("
+                      << scalarMs / batchMs << "x";
+            if (frameWide) {
+                std::cout << "; the cullBatch call alone " << cullOnlyMs / steps << " ms";
+            }
+            std::cout << "), " << mismatches << " passes with a different visible count" << std::endl;
+        }
+    }
+    Frustum::setCullBackend(selected);
+}
+
+// --precision-check: places a chunk 'distance' units from the world origin and pans the camera over it in steps of
+// a hundredth of a unit, projecting a grid of the chunk's vertices to the screen the way the terrain shader does:
+// once with the absolute float model/view matrices used before camera-relative rendering, once with the chunk and
+// camera matrices used now, and once in double as the reference. Prints the worst screen error of each in pixels;
+// returns 1 (the exit code) if the camera-relative one is off by more than half a pixel, which would show as jitter.
+int runPrecisionCheck(double distance) {
+    PerlinNoise noise(1337);
+    Vec2i coords(static_cast<int>(std::floor(distance / Chunk::CHUNK_WORLD_SIZE_X)),
+                 static_cast<int>(std::floor(distance / Chunk::CHUNK_WORLD_SIZE_Z)));
+    Chunk chunk(coords, &noise);
+    glm::dvec3 center = chunk.getWorldCenter();
+
+    // Every 8th vertex, in mesh space as Mesh::generateFromHeightMap lays it out (centred on the chunk)
+    const int stride = 8;
+    double spacing = static_cast<double>(Chunk::CHUNK_WORLD_SIZE_X) / (Chunk::CHUNK_VERTEX_RESOLUTION_X - 1);
+    std::vector<glm::dvec3> vertices;
+    for (int z = 0; z < Chunk::CHUNK_VERTEX_RESOLUTION_Z; z += stride) {
+        for (int x = 0; x < Chunk::CHUNK_VERTEX_RESOLUTION_X; x += stride) {
+            double height = Chunk::sampleTerrainHeight(noise, chunk.worldPosition.x + x * spacing, chunk.worldPosition.z + z * spacing) *
+                            Chunk::MESH_VERTICAL_SCALE;
+            // Through float, like the vertex buffer
+            glm::vec3 local(static_cast<float>(x * spacing - Chunk::CHUNK_VERTEX_RESOLUTION_X * spacing / 2.0),
+                            static_cast<float>(height),
+                            static_cast<float>(z * spacing - Chunk::CHUNK_VERTEX_RESOLUTION_Z * spacing / 2.0));
+            vertices.push_back(glm::dvec3(local));
+        }
+    }
+
+    const float width = static_cast<float>(SCR_WIDTH), height = static_cast<float>(SCR_HEIGHT);
+    const float nearPlane = 0.1f, farPlane = 1000.0f;
+    glm::mat4 projection = glm::perspective(glm::radians(ZOOM), width / height, nearPlane, farPlane);
+    glm::dmat4 projectionReference = glm::perspective(glm::radians(static_cast<double>(ZOOM)), static_cast<double>(width) / height,
+                                                      static_cast<double>(nearPlane), static_cast<double>(farPlane));
+    auto toPixels = [&](const glm::dvec4& clip, glm::dvec2& pixels) {
+        if (clip.w <= nearPlane) return false;
+        pixels = glm::dvec2((clip.x / clip.w * 0.5 + 0.5) * width, (clip.y / clip.w * 0.5 + 0.5) * height);
+        return pixels.x >= 0.0 && pixels.x <= width && pixels.y >= 0.0 && pixels.y <= height;
+    };
+
+    Camera viewer(center + glm::dvec3(-40.0, 60.0, 90.0), glm::vec3(0.0f, 1.0f, 0.0f), -70.0f, -30.0f);
+    const int steps = 200;
+    const double stepSize = 0.01;
+    double absoluteError = 0.0, relativeError = 0.0;
+    size_t projected = 0;
+    for (int step = 0; step < steps; ++step) {
+        glm::dmat4 viewReference = glm::lookAt(viewer.Position, viewer.Position + glm::dvec3(viewer.Front), glm::dvec3(viewer.Up));
+        glm::vec3 eye(viewer.Position);
+        glm::mat4 viewAbsolute = glm::lookAt(eye, eye + viewer.Front, viewer.Up);
+        glm::mat4 modelAbsolute = glm::translate(glm::mat4(1.0f), glm::vec3(center));
+        glm::mat4 viewRelative = viewer.GetViewMatrix();
+        glm::mat4 modelRelative = chunk.getModelMatrix(viewer.GetRenderOrigin());
+
+        for (const glm::dvec3& vertex : vertices) {
+            glm::dvec2 reference, absolute, relative;
+            if (!toPixels(projectionReference * (viewReference * glm::dvec4(center + vertex, 1.0)), reference)) continue;
+            glm::vec4 local(glm::vec3(vertex), 1.0f);
+            glm::vec4 clipAbsolute = projection * (viewAbsolute * (modelAbsolute * local));
+            glm::vec4 clipRelative = projection * (viewRelative * (modelRelative * local));
+            if (toPixels(glm::dvec4(clipAbsolute.x, clipAbsolute.y, clipAbsolute.z, clipAbsolute.w), absolute)) {
+                absoluteError = std::max(absoluteError, glm::length(absolute - reference));
+            } else {
+                absoluteError = std::max(absoluteError, static_cast<double>(width)); // Thrown off screen
+            }
+            if (toPixels(glm::dvec4(clipRelative.x, clipRelative.y, clipRelative.z, clipRelative.w), relative)) {
+                relativeError = std::max(relativeError, glm::length(relative - reference));
+            } else {
+                relativeError = std::max(relativeError, static_cast<double>(width));
+            }
+            projected++;
+        }
+        viewer.Position.x += stepSize;
+    }
+
+    std::cout << "[PrecisionCheck] chunk (" << coords.x << ", " << coords.z << "), " << distance << " units from the origin: "
+              << projected << " vertex projections over " << steps << " camera steps of " << stepSize << " units" << std::endl;
+    std::cout << "[PrecisionCheck] absolute float transforms: max error " << absoluteError << " px" << std::endl;
+    std::cout << "[PrecisionCheck] camera-relative transforms: max error " << relativeError << " px" << std::endl;
+    if (projected == 0 || relativeError > 0.5) {
+        std::cerr << "[PrecisionCheck] FAILED: camera-relative rendering is not steady to half a pixel" << std::endl;
+        return 1;
+    }
+    std::cout << "[PrecisionCheck] passed" << std::endl;
+    return 0;
+}
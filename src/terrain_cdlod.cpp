@@ -0,0 +1,338 @@
+#include "terrain_cdlod.h"
+#include "terrain_chunk.h" // For the shared TERRAIN_* parameters and sampleTerrainHeight
+#include "Shader.h"
+#include "Camera.h"        // For renderOriginFor
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm> // For std::min, std::max
+#include <chrono>
+#include <cmath>     // For std::floor
+#include <iostream>
+#include <limits>
+
+// Texture unit used for the height tile array; units 0-2 hold the terrain material textures
+static const int CDLOD_HEIGHT_TEXTURE_UNIT = 3;
+
+CdlodTerrain::CdlodTerrain(const PerlinNoise* noiseGenerator, const CdlodSettings& settings)
+    : noise_(noiseGenerator), settings_(settings), levelCount_(1), rootNodeSize_(settings.leafNodeSize),
+      selectionCamera_(0.0f), selectionFrustum_(nullptr),
+      gpuReady_(false), patchVAO_(0), patchVBO_(0), patchEBO_(0), tileTexture_(0),
+      tileTexels_(settings.patchResolution + 2), quadrantIndexCount_(0), frameCounter_(0) {
+
+    // Smallest number of levels whose coarsest range reaches the view distance
+    while (settings_.leafRange * static_cast<float>(1 << (levelCount_ - 1)) < settings_.viewDistance && levelCount_ < 20) {
+        ++levelCount_;
+    }
+    rootNodeSize_ = settings_.leafNodeSize * static_cast<float>(1 << (levelCount_ - 1));
+
+    levelRanges_.resize(levelCount_);
+    morphRanges_.resize(levelCount_);
+    for (int level = 0; level < levelCount_; ++level) {
+        levelRanges_[level] = settings_.leafRange * static_cast<float>(1 << level);
+    }
+    levelRanges_[levelCount_ - 1] = std::max(settings_.viewDistance, levelCount_ > 1 ? levelRanges_[levelCount_ - 2] : 0.0f);
+    for (int level = 0; level < levelCount_; ++level) {
+        float previousRange = level == 0 ? 0.0f : levelRanges_[level - 1];
+        float morphStart = previousRange + (levelRanges_[level] - previousRange) * settings_.morphStartRatio;
+        morphRanges_[level] = glm::vec2(morphStart, levelRanges_[level]);
+    }
+
+    std::cout << "CdlodTerrain created: " << levelCount_ << " levels, root node size " << rootNodeSize_
+              << ", view distance " << settings_.viewDistance << std::endl;
+}
+
+CdlodTerrain::~CdlodTerrain() {
+    if (patchVAO_ != 0) glDeleteVertexArrays(1, &patchVAO_);
+    if (patchVBO_ != 0) glDeleteBuffers(1, &patchVBO_);
+    if (patchEBO_ != 0) glDeleteBuffers(1, &patchEBO_);
+    if (tileTexture_ != 0) glDeleteTextures(1, &tileTexture_);
+}
+
+void CdlodTerrain::setupGPU() {
+    if (gpuReady_) return;
+    gpuReady_ = true;
+
+    int resolution = settings_.patchResolution;
+    int half = (resolution - 1) / 2;
+
+    // Shared patch: integer grid coordinates, the vertex shader places and displaces them per node
+    std::vector<float> gridCoords;
+    gridCoords.reserve(static_cast<size_t>(resolution) * resolution * 2);
+    for (int z = 0; z < resolution; ++z) {
+        for (int x = 0; x < resolution; ++x) {
+            gridCoords.push_back(static_cast<float>(x));
+            gridCoords.push_back(static_cast<float>(z));
+        }
+    }
+
+    // Indices grouped by quadrant so a partially selected node draws sub-ranges of the same buffer
+    std::vector<uint16_t> indices;
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        int startX = (quadrant & 1) * half;
+        int startZ = (quadrant >> 1) * half;
+        for (int z = startZ; z < startZ + half; ++z) {
+            for (int x = startX; x < startX + half; ++x) {
+                uint16_t topLeft = static_cast<uint16_t>(z * resolution + x);
+                uint16_t topRight = static_cast<uint16_t>(topLeft + 1);
+                uint16_t bottomLeft = static_cast<uint16_t>((z + 1) * resolution + x);
+                uint16_t bottomRight = static_cast<uint16_t>(bottomLeft + 1);
+                indices.insert(indices.end(), { topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight });
+            }
+        }
+    }
+    quadrantIndexCount_ = static_cast<GLsizei>(indices.size() / 4);
+
+    glGenVertexArrays(1, &patchVAO_);
+    glGenBuffers(1, &patchVBO_);
+    glGenBuffers(1, &patchEBO_);
+    glBindVertexArray(patchVAO_);
+    glBindBuffer(GL_ARRAY_BUFFER, patchVBO_);
+    glBufferData(GL_ARRAY_BUFFER, gridCoords.size() * sizeof(float), gridCoords.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, patchEBO_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glBindVertexArray(0);
+
+    glGenTextures(1, &tileTexture_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tileTexture_);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, tileTexels_, tileTexels_, settings_.tileCapacity, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    freeLayers_.clear();
+    for (int layer = settings_.tileCapacity - 1; layer >= 0; --layer) freeLayers_.push_back(layer);
+    tileScratch_.resize(static_cast<size_t>(tileTexels_) * tileTexels_);
+}
+
+uint64_t CdlodTerrain::tileKey(int level, float x, float z, float size) {
+    int64_t nodeX = static_cast<int64_t>(std::floor(x / size + 0.5f));
+    int64_t nodeZ = static_cast<int64_t>(std::floor(z / size + 0.5f));
+    return (static_cast<uint64_t>(level) << 56) |
+           ((static_cast<uint64_t>(nodeX) & 0xFFFFFFFull) << 28) |
+           (static_cast<uint64_t>(nodeZ) & 0xFFFFFFFull);
+}
+
+const CdlodTerrain::Tile* CdlodTerrain::findTile(uint64_t key) const {
+    auto it = tiles_.find(key);
+    return it != tiles_.end() ? &it->second : nullptr;
+}
+
+CdlodTerrain::Tile* CdlodTerrain::buildTile(int level, float x, float z, float size) {
+    if (!noise_) return nullptr;
+    if (freeLayers_.empty()) {
+        // Evict the least recently used tile that is not needed this frame
+        auto victim = tiles_.end();
+        for (auto it = tiles_.begin(); it != tiles_.end(); ++it) {
+            if (it->second.lastUsedFrame == frameCounter_) continue;
+            if (victim == tiles_.end() || it->second.lastUsedFrame < victim->second.lastUsedFrame) victim = it;
+        }
+        if (victim == tiles_.end()) return nullptr;
+        freeLayers_.push_back(victim->second.layer);
+        tiles_.erase(victim);
+    }
+
+    Tile tile;
+    tile.layer = freeLayers_.back();
+    freeLayers_.pop_back();
+    tile.minHeight = std::numeric_limits<float>::max();
+    tile.maxHeight = std::numeric_limits<float>::lowest();
+
+    // One border texel on each side so the vertex shader can take central differences at patch edges
+    double spacing = static_cast<double>(size) / (settings_.patchResolution - 1);
+    for (int tz = 0; tz < tileTexels_; ++tz) {
+        for (int tx = 0; tx < tileTexels_; ++tx) {
+            double worldX = x + (tx - 1) * spacing;
+            double worldZ = z + (tz - 1) * spacing;
+            float height = Chunk::sampleTerrainHeight(*noise_, worldX, worldZ) * Chunk::MESH_VERTICAL_SCALE;
+            tileScratch_[tz * tileTexels_ + tx] = height;
+            if (tx >= 1 && tx <= settings_.patchResolution && tz >= 1 && tz <= settings_.patchResolution) {
+                tile.minHeight = std::min(tile.minHeight, height);
+                tile.maxHeight = std::max(tile.maxHeight, height);
+            }
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tileTexture_);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, tile.layer, tileTexels_, tileTexels_, 1, GL_RED, GL_FLOAT, tileScratch_.data());
+
+    tile.lastUsedFrame = frameCounter_;
+    Tile& stored = tiles_[tileKey(level, x, z, size)];
+    stored = tile;
+    return &stored;
+}
+
+void CdlodTerrain::nodeHeightBounds(float x, float z, int level, float& minHeight, float& maxHeight) const {
+    float size = settings_.leafNodeSize * static_cast<float>(1 << level);
+    const Tile* tile = findTile(tileKey(level, x, z, size));
+    if (tile) {
+        minHeight = tile->minHeight;
+        maxHeight = tile->maxHeight;
+    } else {
+        // Conservative until the node's tile exists
+        minHeight = Chunk::TERRAIN_MIN_HEIGHT * Chunk::MESH_VERTICAL_SCALE;
+        maxHeight = Chunk::TERRAIN_MAX_HEIGHT * Chunk::MESH_VERTICAL_SCALE;
+    }
+}
+
+bool CdlodTerrain::nodeInRange(float x, float z, float size, int level, float range) const {
+    float minHeight, maxHeight;
+    nodeHeightBounds(x, z, level, minHeight, maxHeight);
+    // Sphere (camera, range) against the node's AABB
+    float dx = std::max(std::max(x - selectionCamera_.x, 0.0f), selectionCamera_.x - (x + size));
+    float dy = std::max(std::max(minHeight - selectionCamera_.y, 0.0f), selectionCamera_.y - maxHeight);
+    float dz = std::max(std::max(z - selectionCamera_.z, 0.0f), selectionCamera_.z - (z + size));
+    return dx * dx + dy * dy + dz * dz <= range * range;
+}
+
+bool CdlodTerrain::selectNode(float x, float z, int level) {
+    float size = settings_.leafNodeSize * static_cast<float>(1 << level);
+    if (!nodeInRange(x, z, size, level, levelRanges_[level])) {
+        return false; // Out of this level's range: the parent covers the area
+    }
+
+    BoundingBox box;
+    nodeHeightBounds(x, z, level, box.min.y, box.max.y);
+    box.min.x = x;
+    box.min.z = z;
+    box.max.x = x + size;
+    box.max.z = z + size;
+    if (selectionFrustum_ && !selectionFrustum_->isAABBVisible(box)) {
+        return true; // Culled, but handled
+    }
+
+    if (level == 0 || !nodeInRange(x, z, size, level, levelRanges_[level - 1])) {
+        selection_.push_back({ x, z, size, level, 15 });
+        return true;
+    }
+
+    // Children that are out of their own range are drawn by this node at its own level
+    float half = size * 0.5f;
+    int quadrantMask = 0;
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        float childX = x + static_cast<float>(quadrant & 1) * half;
+        float childZ = z + static_cast<float>(quadrant >> 1) * half;
+        if (!selectNode(childX, childZ, level - 1)) {
+            quadrantMask |= 1 << quadrant;
+        }
+    }
+    if (quadrantMask != 0) {
+        selection_.push_back({ x, z, size, level, quadrantMask });
+    }
+    return true;
+}
+
+void CdlodTerrain::select(const glm::vec3& cameraPosition, const Frustum& frustum) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    selection_.clear();
+    selectionCamera_ = cameraPosition;
+    selectionFrustum_ = &frustum;
+
+    int topLevel = levelCount_ - 1;
+    int minRootX = static_cast<int>(std::floor((cameraPosition.x - settings_.viewDistance) / rootNodeSize_));
+    int maxRootX = static_cast<int>(std::floor((cameraPosition.x + settings_.viewDistance) / rootNodeSize_));
+    int minRootZ = static_cast<int>(std::floor((cameraPosition.z - settings_.viewDistance) / rootNodeSize_));
+    int maxRootZ = static_cast<int>(std::floor((cameraPosition.z + settings_.viewDistance) / rootNodeSize_));
+    for (int rootZ = minRootZ; rootZ <= maxRootZ; ++rootZ) {
+        for (int rootX = minRootX; rootX <= maxRootX; ++rootX) {
+            selectNode(rootX * rootNodeSize_, rootZ * rootNodeSize_, topLevel);
+        }
+    }
+    selectionFrustum_ = nullptr;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    stats_.selectionMs = std::chrono::duration<double, std::milli>(end - start).count();
+    stats_.nodesSelected = selection_.size();
+}
+
+void CdlodTerrain::render(Shader& shader, const glm::dvec3& cameraPosition) {
+    setupGPU();
+    frameCounter_++;
+    stats_.tilesBuilt = 0;
+    stats_.trianglesDrawn = 0;
+
+    shader.setInt("heightTiles", CDLOD_HEIGHT_TEXTURE_UNIT);
+    shader.setFloat("patchSegments", static_cast<float>(settings_.patchResolution - 1));
+    shader.setFloat("textureWorldSize", Chunk::CHUNK_WORLD_SIZE_X);
+    // Node corners are sent relative to the render origin, subtracted in double; the material texture phase
+    // of the origin goes separately so texture coordinates stay small too
+    glm::dvec3 renderOrigin = renderOriginFor(cameraPosition);
+    glm::dvec2 originRepeats = glm::dvec2(renderOrigin.x, renderOrigin.z) / static_cast<double>(Chunk::CHUNK_WORLD_SIZE_X);
+    shader.setVec2("textureOrigin", glm::vec2(originRepeats - glm::floor(originRepeats)));
+    // The camera position for morphing is viewPos_world from the frame uniform block
+
+    glActiveTexture(GL_TEXTURE0 + CDLOD_HEIGHT_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tileTexture_);
+    glBindVertexArray(patchVAO_);
+
+    // Set once per node: resolved here rather than looked up by name in the loop
+    UniformHandle<glm::vec4> nodeParams = shader.uniform<glm::vec4>("nodeParams");
+    UniformHandle<glm::vec2> morphRange = shader.uniform<glm::vec2>("morphRange");
+    UniformHandle<glm::vec4> tileTransformUniform = shader.uniform<glm::vec4>("tileTransform");
+    UniformHandle<float> tileTexelWorldSize = shader.uniform<float>("tileTexelWorldSize");
+
+    int segments = settings_.patchResolution - 1;
+    for (const SelectedNode& node : selection_) {
+        uint64_t key = tileKey(node.level, node.x, node.z, node.size);
+        auto found = tiles_.find(key);
+        Tile* tile = found != tiles_.end() ? &found->second : nullptr;
+        if (!tile && (stats_.tilesBuilt < settings_.maxTileBuildsPerFrame || node.level == levelCount_ - 1)) {
+            tile = buildTile(node.level, node.x, node.z, node.size);
+            if (tile) stats_.tilesBuilt++;
+        }
+
+        // Map patch grid coordinates to tile texels: texel = grid * scale + offset
+        glm::vec4 tileTransform(1.0f, 1.0f, 1.0f, 0.0f);
+        float texelWorldSize = node.size / segments;
+        if (!tile) {
+            // Borrow the closest resident ancestor tile until this node's own tile is built
+            for (int level = node.level + 1; level < levelCount_ && !tile; ++level) {
+                float ancestorSize = settings_.leafNodeSize * static_cast<float>(1 << level);
+                float ancestorX = std::floor(node.x / ancestorSize + 0.5f * node.size / ancestorSize) * ancestorSize;
+                float ancestorZ = std::floor(node.z / ancestorSize + 0.5f * node.size / ancestorSize) * ancestorSize;
+                auto ancestor = tiles_.find(tileKey(level, ancestorX, ancestorZ, ancestorSize));
+                if (ancestor != tiles_.end()) {
+                    tile = &ancestor->second;
+                    float scale = node.size / ancestorSize;
+                    tileTransform = glm::vec4((node.x - ancestorX) / ancestorSize * segments + 1.0f,
+                                              (node.z - ancestorZ) / ancestorSize * segments + 1.0f,
+                                              scale, 0.0f);
+                    texelWorldSize = ancestorSize / segments;
+                }
+            }
+        }
+        if (!tile) continue;
+        tile->lastUsedFrame = frameCounter_;
+        tileTransform.w = static_cast<float>(tile->layer);
+
+        nodeParams.set(glm::vec4(static_cast<float>(node.x - renderOrigin.x), static_cast<float>(node.z - renderOrigin.z),
+                                 node.size, static_cast<float>(node.level)));
+        morphRange.set(morphRanges_[node.level]);
+        tileTransformUniform.set(tileTransform);
+        tileTexelWorldSize.set(texelWorldSize);
+
+        if (node.quadrantMask == 15) {
+            glDrawElements(GL_TRIANGLES, quadrantIndexCount_ * 4, GL_UNSIGNED_SHORT, 0);
+            stats_.trianglesDrawn += static_cast<size_t>(quadrantIndexCount_) * 4 / 3;
+        } else {
+            GLsizei counts[4];
+            const void* offsets[4];
+            GLsizei drawCount = 0;
+            for (int quadrant = 0; quadrant < 4; ++quadrant) {
+                if (!(node.quadrantMask & (1 << quadrant))) continue;
+                counts[drawCount] = quadrantIndexCount_;
+                offsets[drawCount] = reinterpret_cast<const void*>(static_cast<size_t>(quadrant) * quadrantIndexCount_ * sizeof(uint16_t));
+                drawCount++;
+            }
+            glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_SHORT, offsets, drawCount);
+            stats_.trianglesDrawn += static_cast<size_t>(quadrantIndexCount_) * drawCount / 3;
+        }
+    }
+
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+    stats_.tilesResident = static_cast<int>(tiles_.size());
+}
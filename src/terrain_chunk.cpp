@@ -1,7 +1,17 @@
 #include "terrain_chunk.h"
 #include "Shader.h" 
+#include "GeoMipmap.h"
+#include "RtinMesher.h"
+#include "HeightTextureArray.h"
+#include "ScratchArena.h"
+#include "AllocationCounter.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <glm/gtc/matrix_transform.hpp> 
 #include <cmath> // For std::pow, std::max, std::min
+#include <algorithm>
+#include <limits>
 
 // Initialize static members for terrain generation
 // These values should be similar to what you used for your single large terrain
@@ -20,18 +30,56 @@ float Chunk::TERRAIN_PEAK_EXPONENT = 1.2f;
 float Chunk::MESH_VERTICAL_SCALE = 1.0f;  // Multiplier for the generated height values
 // MESH_HORIZONTAL_SCALE will be calculated dynamically in load()
 
+// 33x33 chunks fit in 16-bit indices; the stripe walk roughly halves vertex shader invocations.
+// Indices are laid out in 16x16-quad clusters so renderClusters can skip the parts of a chunk that are off screen.
+static IndexBuildOptions defaultChunkIndexOptions() {
+    IndexBuildOptions options;
+    options.clusterQuads = 16;
+    return options;
+}
+IndexBuildOptions Chunk::MESH_INDEX_OPTIONS = defaultChunkIndexOptions();
+
+ChunkMeshBuilder Chunk::MESH_BUILDER = ChunkMeshBuilder::Grid;
+float Chunk::RTIN_MAX_ERROR = 0.25f; // A quarter unit on 30-unit-high terrain is invisible at normal view distances
+
+// Nothing reads a chunk's CPU mesh after upload, so by default it is freed (~60 KB per 33x33 chunk)
+MeshResidency Chunk::MESH_RESIDENCY = MeshResidency::GpuOnly;
+
+// The RTIN triangle tree depends only on the grid size, so all chunks share one mesher.
+// Workers call this concurrently; the resolution does not change while chunks are being built.
+static const RtinMesher& sharedRtinMesher(int gridSize) {
+    static std::mutex mutex;
+    static std::unique_ptr<RtinMesher> mesher;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!mesher || mesher->getGridSize() != gridSize) {
+        mesher = std::make_unique<RtinMesher>(gridSize);
+    }
+    return *mesher;
+}
+
+// Displacement texels live from load() until uploaded (possibly on another thread), then go back to the pool
+static VectorPool<uint16_t>& displacementTexelPool() {
+    static VectorPool<uint16_t> pool(16);
+    return pool;
+}
+
 // Constructor now takes a PerlinNoise generator
 Chunk::Chunk(Vec2i pGridCoords, const PerlinNoise* pNoiseGenerator) // Modified constructor
     : gridCoords(pGridCoords), 
       perlinGenerator_(pNoiseGenerator), // Store the generator
       isLoaded_(false), 
-      isActive_(false) {
+      isActive_(false),
+      lodLevelCount_(0),
+      meshBuildMs_(0.0),
+      loadAllocations_(0),
+      heightLayer_(-1),
+      keepHeights_(false),
+      state_(ChunkState::Queued),
+      cancelled_(false) {
     
-    worldPosition.x = static_cast<float>(gridCoords.x) * CHUNK_WORLD_SIZE_X;
-    worldPosition.y = 0.0f; 
-    worldPosition.z = static_cast<float>(gridCoords.z) * CHUNK_WORLD_SIZE_Z;
-
-    calculateModelMatrix();
+    worldPosition.x = static_cast<double>(gridCoords.x) * CHUNK_WORLD_SIZE_X;
+    worldPosition.y = 0.0; 
+    worldPosition.z = static_cast<double>(gridCoords.z) * CHUNK_WORLD_SIZE_Z;
 
     std::cout << "Chunk created at grid (" << gridCoords.x << ", " << gridCoords.z 
               << ") world origin (" << worldPosition.x << ", " << worldPosition.z << ")" << std::endl;
@@ -47,27 +95,111 @@ Chunk::~Chunk() {
     std::cout << "Chunk at grid (" << gridCoords.x << ", " << gridCoords.z << ") destroyed." << std::endl;
 }
 
-void Chunk::calculateModelMatrix() {
-    float chunkCenterX = worldPosition.x + CHUNK_WORLD_SIZE_X / 2.0f;
-    float chunkCenterZ = worldPosition.z + CHUNK_WORLD_SIZE_Z / 2.0f;
-    modelMatrix_ = glm::translate(glm::mat4(1.0f), glm::vec3(chunkCenterX, 0.0f, chunkCenterZ));
+float Chunk::sampleTerrainHeight(const PerlinNoise& noise, double worldX, double worldZ) {
+    return sampleTerrainHeight(noise, worldX, worldZ, TERRAIN_OCTAVES);
+}
+
+float Chunk::sampleTerrainHeight(const PerlinNoise& noise, double worldX, double worldZ, int octaves) {
+    // Scale world coordinates for Perlin noise input
+    // Using the static TERRAIN_SCALE for consistent feature size across chunks
+    double noiseSampleX = worldX / TERRAIN_SCALE;
+    double noiseSampleZ = worldZ / TERRAIN_SCALE;
+
+    // Generate Perlin noise value (typically 0.0 to 1.0 from your PerlinNoise class)
+    double perlinValue;
+    octaves = std::max(octaves, 1);
+    if (octaves >= TERRAIN_OCTAVES) {
+        perlinValue = noise.octaveNoise(noiseSampleX, noiseSampleZ, TERRAIN_OCTAVES, TERRAIN_PERSISTENCE);
+    } else {
+        // octaveNoise normalizes by the amplitudes it used; weigh its result back by them and let each skipped
+        // octave contribute its mean (0.5), normalized by the amplitudes of all TERRAIN_OCTAVES
+        double usedAmplitude = 0.0, fullAmplitude = 0.0, amplitude = 1.0;
+        for (int i = 0; i < TERRAIN_OCTAVES; ++i) {
+            if (i < octaves) usedAmplitude += amplitude;
+            fullAmplitude += amplitude;
+            amplitude *= TERRAIN_PERSISTENCE;
+        }
+        double coarse = noise.octaveNoise(noiseSampleX, noiseSampleZ, octaves, TERRAIN_PERSISTENCE);
+        perlinValue = (coarse * usedAmplitude + 0.5 * (fullAmplitude - usedAmplitude)) / fullAmplitude;
+    }
+
+    // Apply peak exponent
+    if (TERRAIN_PEAK_EXPONENT != 1.0f && TERRAIN_PEAK_EXPONENT > 0.0f) {
+        perlinValue = std::pow(perlinValue, static_cast<double>(TERRAIN_PEAK_EXPONENT));
+    }
+    // Clamp perlinValue to [0, 1] just in case octaveNoise goes slightly out of bounds
+    perlinValue = std::max(0.0, std::min(1.0, perlinValue));
+
+    // Map Perlin value to height range
+    return static_cast<float>(TERRAIN_MIN_HEIGHT + perlinValue * (TERRAIN_MAX_HEIGHT - TERRAIN_MIN_HEIGHT));
+}
+
+size_t Chunk::getBorderedHeightCount() {
+    return static_cast<size_t>(CHUNK_VERTEX_RESOLUTION_X + 2) * (CHUNK_VERTEX_RESOLUTION_Z + 2);
+}
+
+bool Chunk::generateHeights(float* outBorderedHeights) const {
+    if (!perlinGenerator_) {
+        std::cerr << "ERROR: Cannot generate heights for Chunk (" << gridCoords.x << ", " << gridCoords.z 
+                  << ") because PerlinNoise generator is null." << std::endl;
+        return false;
+    }
+    // Same vertex spacing as load(); the border row/column on each side lies in the neighboring chunks
+    float MESH_HORIZONTAL_SCALE = CHUNK_WORLD_SIZE_X / static_cast<float>(CHUNK_VERTEX_RESOLUTION_X - 1);
+    int borderedWidth = CHUNK_VERTEX_RESOLUTION_X + 2;
+    for (int z_idx = -1; z_idx <= CHUNK_VERTEX_RESOLUTION_Z; ++z_idx) {
+        for (int x_idx = -1; x_idx <= CHUNK_VERTEX_RESOLUTION_X; ++x_idx) {
+            // Calculate the world coordinates for this specific vertex in the chunk
+            // worldPosition is the origin (min corner) of the chunk, exact in double for any grid coordinate,
+            // so neighboring chunks sample their shared edge at identical positions.
+            double vertexWorldX = worldPosition.x + 
+                                  static_cast<double>(x_idx) * MESH_HORIZONTAL_SCALE;
+            double vertexWorldZ = worldPosition.z + 
+                                  static_cast<double>(z_idx) * MESH_HORIZONTAL_SCALE; // Use same scale for Z
+            outBorderedHeights[(z_idx + 1) * borderedWidth + (x_idx + 1)] =
+                sampleTerrainHeight(*perlinGenerator_, vertexWorldX, vertexWorldZ);
+        }
+    }
+    return true;
 }
 
 void Chunk::load() {
     if (isLoaded_) {
         return;
     }
-    if (!perlinGenerator_) {
-        std::cerr << "ERROR: Cannot load Chunk (" << gridCoords.x << ", " << gridCoords.z 
-                  << ") because PerlinNoise generator is null." << std::endl;
+    ScratchArena::Scope scratch(ScratchArena::forThread());
+    ScratchVector<float> borderedHeights(getBorderedHeightCount(), 0.0f, ArenaAllocator<float>(&scratch.arena()));
+    if (generateHeights(borderedHeights.data())) {
+        load(borderedHeights.data());
+    }
+}
+
+void Chunk::load(const float* borderedHeights) {
+    if (isLoaded_) {
+        return;
+    }
+    prepare(borderedHeights);
+    uploadToGpu();
+}
+
+void Chunk::prepare(const float* borderedHeights) {
+    if (isLoaded_) {
         return;
     }
 
     std::cout << "Chunk (" << gridCoords.x << ", " << gridCoords.z << "): Actual LOAD initiated." << std::endl;
+    uint64_t allocationsBefore = AllocationCounter::threadAllocations();
+    if (keepHeights_ && borderedHeights != heights_.data()) {
+        heights_.assign(borderedHeights, borderedHeights + getBorderedHeightCount());
+    }
+
+    // All temporaries of the build (heights, RTIN errors, index optimizer state) are scratch memory of this
+    // thread, rewound when load() returns; the mesh's own buffers come from Mesh's recycling pools
+    ScratchArena::Scope scratch(ScratchArena::forThread());
 
     // Create a local HeightMap for this chunk
     // The HeightMap dimensions are the number of vertices
-    HeightMap localHeightMap(CHUNK_VERTEX_RESOLUTION_X, CHUNK_VERTEX_RESOLUTION_Z);
+    HeightMap localHeightMap(CHUNK_VERTEX_RESOLUTION_X, CHUNK_VERTEX_RESOLUTION_Z, &scratch.arena());
 
     // Calculate horizontal scaling for the mesh generation.
     // This is the distance between vertices in the heightmap/mesh.
@@ -79,35 +211,28 @@ void Chunk::load() {
     float MESH_HORIZONTAL_SCALE = CHUNK_WORLD_SIZE_X / static_cast<float>(CHUNK_VERTEX_RESOLUTION_X - 1);
 
 
-    for (int z_idx = 0; z_idx < CHUNK_VERTEX_RESOLUTION_Z; ++z_idx) {
-        for (int x_idx = 0; x_idx < CHUNK_VERTEX_RESOLUTION_X; ++x_idx) {
-            // Calculate the world coordinates for this specific vertex in the chunk
-            // worldPosition is the origin (min corner) of the chunk.
-            double vertexWorldX = static_cast<double>(worldPosition.x) + 
-                                  static_cast<double>(x_idx) * MESH_HORIZONTAL_SCALE;
-            double vertexWorldZ = static_cast<double>(worldPosition.z) + 
-                                  static_cast<double>(z_idx) * MESH_HORIZONTAL_SCALE; // Use same scale for Z
-
-            // Scale world coordinates for Perlin noise input
-            // Using the static TERRAIN_SCALE for consistent feature size across chunks
-            double noiseSampleX = vertexWorldX / TERRAIN_SCALE;
-            double noiseSampleZ = vertexWorldZ / TERRAIN_SCALE;
+    bool displaced = MESH_BUILDER == ChunkMeshBuilder::Displaced;
+    int borderedWidth = CHUNK_VERTEX_RESOLUTION_X + 2;
+    if (displaced) {
+        displacementTexelPool().acquire(displacementTexels_);
+        displacementTexels_.assign(static_cast<size_t>(borderedWidth) * (CHUNK_VERTEX_RESOLUTION_Z + 2), 0);
+    }
+    float heightRange = std::max(displacementMaxHeight() - displacementMinHeight(), 1e-6f);
 
-            // Generate Perlin noise value (typically 0.0 to 1.0 from your PerlinNoise class)
-            double perlinValue = perlinGenerator_->octaveNoise(noiseSampleX, noiseSampleZ, 
-                                                              TERRAIN_OCTAVES, TERRAIN_PERSISTENCE);
+    // Displaced chunks also use the one-vertex border so the shader can take central differences at the edges
+    int border = displaced ? 1 : 0;
+    for (int z_idx = -border; z_idx < CHUNK_VERTEX_RESOLUTION_Z + border; ++z_idx) {
+        for (int x_idx = -border; x_idx < CHUNK_VERTEX_RESOLUTION_X + border; ++x_idx) {
+            float finalHeight = borderedHeights[(z_idx + 1) * borderedWidth + (x_idx + 1)];
 
-            // Apply peak exponent
-            if (TERRAIN_PEAK_EXPONENT != 1.0f && TERRAIN_PEAK_EXPONENT > 0.0f) {
-                perlinValue = std::pow(perlinValue, static_cast<double>(TERRAIN_PEAK_EXPONENT));
+            if (displaced) {
+                float normalized = (finalHeight * MESH_VERTICAL_SCALE - displacementMinHeight()) / heightRange;
+                normalized = std::max(0.0f, std::min(1.0f, normalized));
+                displacementTexels_[(z_idx + 1) * borderedWidth + (x_idx + 1)] = static_cast<uint16_t>(normalized * 65535.0f + 0.5f);
+            }
+            if (x_idx < 0 || z_idx < 0 || x_idx >= CHUNK_VERTEX_RESOLUTION_X || z_idx >= CHUNK_VERTEX_RESOLUTION_Z) {
+                continue; // Border texel only
             }
-            // Clamp perlinValue to [0, 1] just in case octaveNoise goes slightly out of bounds
-            perlinValue = std::max(0.0, std::min(1.0, perlinValue));
-
-
-            // Map Perlin value to height range
-            float finalHeight = static_cast<float>(TERRAIN_MIN_HEIGHT + perlinValue * (TERRAIN_MAX_HEIGHT - TERRAIN_MIN_HEIGHT));
-            
             localHeightMap.setHeight(x_idx, z_idx, finalHeight);
         }
     }
@@ -118,36 +243,114 @@ void Chunk::load() {
     // Generate mesh using the local heightmap
     // The MESH_HORIZONTAL_SCALE determines the spacing of vertices in the XZ plane.
     // The MESH_VERTICAL_SCALE multiplies the height values.
-    mesh_.generateFromHeightMap(localHeightMap, MESH_HORIZONTAL_SCALE, MESH_VERTICAL_SCALE);
-    mesh_.setupMesh(); // Creates VAO, VBO, EBO
+    auto meshStart = std::chrono::high_resolution_clock::now();
+    if (displaced) {
+        // No CPU mesh: only the bounds are needed (same placement as Mesh::generateFromHeightMap)
+        float minHeight = std::numeric_limits<float>::max();
+        float maxHeight = std::numeric_limits<float>::lowest();
+        for (int z_idx = 0; z_idx < CHUNK_VERTEX_RESOLUTION_Z; ++z_idx) {
+            for (int x_idx = 0; x_idx < CHUNK_VERTEX_RESOLUTION_X; ++x_idx) {
+                minHeight = std::min(minHeight, localHeightMap.getHeight(x_idx, z_idx));
+                maxHeight = std::max(maxHeight, localHeightMap.getHeight(x_idx, z_idx));
+            }
+        }
+        float halfX = static_cast<float>(CHUNK_VERTEX_RESOLUTION_X) * MESH_HORIZONTAL_SCALE / 2.0f;
+        float halfZ = static_cast<float>(CHUNK_VERTEX_RESOLUTION_Z) * MESH_HORIZONTAL_SCALE / 2.0f;
+        localBounds_.min = glm::vec3(-halfX, minHeight * MESH_VERTICAL_SCALE, -halfZ);
+        localBounds_.max = glm::vec3(static_cast<float>(CHUNK_VERTEX_RESOLUTION_X - 1) * MESH_HORIZONTAL_SCALE - halfX,
+                                     maxHeight * MESH_VERTICAL_SCALE,
+                                     static_cast<float>(CHUNK_VERTEX_RESOLUTION_Z - 1) * MESH_HORIZONTAL_SCALE - halfZ);
+    } else if (MESH_BUILDER == ChunkMeshBuilder::Rtin && CHUNK_VERTEX_RESOLUTION_X == CHUNK_VERTEX_RESOLUTION_Z) {
+        const RtinMesher& mesher = sharedRtinMesher(CHUNK_VERTEX_RESOLUTION_X);
+        mesh_.generateAdaptiveFromHeightMap(localHeightMap, MESH_HORIZONTAL_SCALE, MESH_VERTICAL_SCALE, mesher, RTIN_MAX_ERROR);
+    } else {
+        mesh_.generateFromHeightMap(localHeightMap, MESH_HORIZONTAL_SCALE, MESH_VERTICAL_SCALE);
+    }
+    meshBuildMs_ = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - meshStart).count();
+    mesh_.setIndexBuildOptions(MESH_INDEX_OPTIONS);
 
+    // Geometric error per geomipmap level, used by screen-space-error LOD selection
+    int lodLevels = 1;
+    while ((1 << (lodLevels - 1)) < std::min(CHUNK_VERTEX_RESOLUTION_X, CHUNK_VERTEX_RESOLUTION_Z) - 1 && lodLevels < MAX_LOD_LEVELS) ++lodLevels;
+    lodLevelCount_ = lodLevels;
+    computeGeoMipmapLevelErrors(localHeightMap, lodLevelCount_, lodErrors_);
+    for (int level = 0; level < lodLevelCount_; ++level) {
+        lodErrors_[level] *= MESH_VERTICAL_SCALE;
+    }
+
+    if (!displaced) {
+        if (MESH_RESIDENCY != MeshResidency::CpuOnly) {
+            mesh_.prepareGpuData(); // Index layout and clusters, so uploadToGpu() only has GL calls left
+        }
+        localBounds_ = mesh_.boundingBox;
+    }
+    glm::vec3 center(getWorldCenter());
+    worldBounds_.min = localBounds_.min + center;
+    worldBounds_.max = localBounds_.max + center;
+
+    loadAllocations_ = AllocationCounter::threadAllocations() - allocationsBefore;
+    if (displaced) {
+        std::cout << "Chunk (" << gridCoords.x << ", " << gridCoords.z << ") PREPARED. Displacement heights: "
+                  << displacementTexels_.size() * sizeof(uint16_t) << " bytes, no mesh";
+    } else {
+        std::cout << "Chunk (" << gridCoords.x << ", " << gridCoords.z << ") PREPARED. Mesh generated: "
+                  << mesh_.getVerticesCount() << " vertices, " << mesh_.getIndicesCount() << " indices, built in "
+                  << meshBuildMs_ << " ms";
+    }
+    if (AllocationCounter::isEnabled()) {
+        std::cout << ", " << loadAllocations_ << " heap allocations";
+    }
+    std::cout << "." << std::endl;
+}
+
+void Chunk::uploadToGpu() {
+    if (isLoaded_) {
+        return;
+    }
+    if (!usesDisplacement()) {
+        mesh_.setResidency(MESH_RESIDENCY); // Creates VAO, VBO, EBO unless CPU-only, then drops what the policy excludes
+    }
     isLoaded_ = true;
     isActive_ = true; // Mark as active for rendering once loaded
-    std::cout << "Chunk (" << gridCoords.x << ", " << gridCoords.z << ") LOADED. Mesh generated: "
-              << mesh_.getVerticesCount() << " vertices, " << mesh_.getIndicesCount() << " indices." << std::endl;
+    state_.store(ChunkState::Resident);
 }
 
 void Chunk::unload() {
+    // Also reached for chunks that were built but never uploaded (cancelled), so free the data unconditionally
+    mesh_.clear();
+    displacementTexelPool().recycle(displacementTexels_);
     if (!isLoaded_) {
         return;
     }
     std::cout << "Chunk (" << gridCoords.x << ", " << gridCoords.z << "): UNLOAD initiated." << std::endl;
-    
-    // The Mesh object (mesh_) is a member. Its destructor will be called when the Chunk
-    // object is destroyed, and that destructor should handle glDeleteVertexArrays, glDeleteBuffers.
-    // If you need to free GPU resources *without* destroying the Chunk object itself
-    // (e.g., for a more complex caching system), your Mesh class would need a
-    // specific method like `clearGPUData()` or `destroyBuffers()`.
-    // For now, relying on Mesh destructor is fine as unique_ptr in TerrainManager deletes Chunks.
-    
-    // mesh_.clearGPUData(); // If Mesh had such a method for explicit cleanup.
-
     isLoaded_ = false;
     isActive_ = false;
     std::cout << "Chunk (" << gridCoords.x << ", " << gridCoords.z << ") UNLOADED." << std::endl;
 }
 
-void Chunk::render(Shader& shader) {
+void Chunk::reset(Vec2i newGridCoords) {
+    if (heightLayer_ >= 0) {
+        std::cerr << "WARNING: Chunk (" << gridCoords.x << ", " << gridCoords.z
+                  << ") reset while holding a height layer; the layer is leaked." << std::endl;
+        heightLayer_ = -1;
+    }
+    unload();
+    gridCoords = newGridCoords;
+    worldPosition = glm::dvec3(static_cast<double>(gridCoords.x) * CHUNK_WORLD_SIZE_X, 0.0,
+                               static_cast<double>(gridCoords.z) * CHUNK_WORLD_SIZE_Z);
+    lodLevelCount_ = 0;
+    meshBuildMs_ = 0.0;
+    loadAllocations_ = 0;
+    localBounds_ = BoundingBox();
+    worldBounds_ = BoundingBox();
+    heights_.clear(); // Keeps the capacity for the next kept or revived heights
+    keepHeights_ = false;
+    state_.store(ChunkState::Queued);
+    cancelled_.store(false);
+    std::cout << "Chunk recycled at grid (" << gridCoords.x << ", " << gridCoords.z << ")" << std::endl;
+}
+
+void Chunk::render(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin) {
     if (!isLoaded_ || !isActive_) { // isActive_ is set in load() and unset in unload()
         return;
     }
@@ -156,8 +359,182 @@ void Chunk::render(Shader& shader) {
     // View and projection matrices should also be set globally on the shader.
     
     // Set the model matrix specific to this chunk
-    shader.setMat4("model", modelMatrix_);
+    uniforms.model.set(getModelMatrix(renderOrigin));
 
     // Draw the chunk's mesh
     mesh_.draw();
 }
+
+void Chunk::render(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin, const GeoMipmapIndexSet& lodIndexSet, int level, int stitchMask) {
+    if (!isLoaded_ || !isActive_) {
+        return;
+    }
+    if (!supportsLod(lodIndexSet)) {
+        render(uniforms, renderOrigin);
+        return;
+    }
+
+    uniforms.model.set(getModelMatrix(renderOrigin));
+
+    const GeoMipmapIndexSet::Range& range = lodIndexSet.getRange(level, stitchMask);
+    mesh_.drawWithIndexBuffer(lodIndexSet.getEBO(), lodIndexSet.getIndexType(), range.byteOffset, range.count);
+}
+
+void Chunk::appendClusterBounds(AABBBatch& batch) {
+    // The model matrix is a pure translation, so the world bounds are the mesh-space ones moved by the center
+    // (absolute, like the frustum, see getWorldBounds)
+    batch.append(mesh_.getClusterBounds(), glm::vec3(getWorldCenter()));
+}
+
+void Chunk::storeClusterHints(const AABBBatch& batch, size_t first) {
+    AABBBatch& bounds = mesh_.getClusterBounds();
+    bounds.planeHint.assign(batch.planeHint.begin() + first, batch.planeHint.begin() + first + bounds.size());
+}
+
+void Chunk::renderClusters(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin, const uint32_t* visibleClusters, size_t visibleCount,
+                           const glm::vec3& viewPosition, ClusterCullStats& stats) {
+    if (!isLoaded_ || !isActive_) {
+        return;
+    }
+    const std::vector<MeshCluster>& clusters = mesh_.getClusters();
+    if (clusters.empty()) {
+        render(uniforms, renderOrigin);
+        stats.trianglesDrawn += getTriangleCount();
+        return;
+    }
+
+    // Cone axes need no transform, and the bounds only this offset (see appendClusterBounds)
+    glm::vec3 offset(getWorldCenter());
+    ScratchArena::Scope scratch(ScratchArena::forThread());
+    ScratchVector<GLsizei> counts{ ArenaAllocator<GLsizei>(&scratch.arena()) };
+    ScratchVector<const void*> byteOffsets{ ArenaAllocator<const void*>(&scratch.arena()) };
+    counts.reserve(visibleCount);
+    byteOffsets.reserve(visibleCount);
+    size_t indexSize = mesh_.getIndexSize();
+    uint32_t runFirst = 0;
+    size_t lastDrawn = clusters.size(); // None yet
+
+    // The cone test on the frustum survivors, in buffer order
+    for (size_t v = 0; v < visibleCount; ++v) {
+        size_t i = visibleClusters[v];
+        const MeshCluster& cluster = clusters[i];
+        BoundingBox worldBounds;
+        worldBounds.min = cluster.bounds.min + offset;
+        worldBounds.max = cluster.bounds.max + offset;
+        glm::vec3 toCenter = (worldBounds.min + worldBounds.max) * 0.5f - viewPosition;
+        float radius = glm::length(worldBounds.max - worldBounds.min) * 0.5f;
+        if (glm::dot(toCenter, cluster.coneAxis) >= cluster.coneCutoff * glm::length(toCenter) + radius) {
+            stats.backfaceCulled++;
+            continue;
+        }
+        stats.trianglesDrawn += cluster.triangleCount;
+
+        // Neighbors in the buffer merge into one range (strip clusters are joined by a restart index)
+        if (lastDrawn + 1 == i) {
+            counts.back() = static_cast<GLsizei>(cluster.firstIndex + cluster.indexCount - runFirst);
+        } else {
+            runFirst = cluster.firstIndex;
+            counts.push_back(static_cast<GLsizei>(cluster.indexCount));
+            byteOffsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(cluster.firstIndex) * indexSize));
+        }
+        lastDrawn = i;
+    }
+    if (counts.empty()) {
+        return;
+    }
+
+    uniforms.model.set(getModelMatrix(renderOrigin));
+    mesh_.drawRanges(counts.data(), byteOffsets.data(), static_cast<GLsizei>(counts.size()));
+}
+
+bool Chunk::supportsLod(const GeoMipmapIndexSet& lodIndexSet) const {
+    if (!lodIndexSet.isValid() || lodIndexSet.getEBO() == 0) {
+        return false;
+    }
+    if (usesDisplacement()) {
+        // The shared grid always has the current chunk resolution
+        return CHUNK_VERTEX_RESOLUTION_X == lodIndexSet.getGridWidth() && CHUNK_VERTEX_RESOLUTION_Z == lodIndexSet.getGridDepth();
+    }
+    return mesh_.getGridWidth() == lodIndexSet.getGridWidth() &&
+           mesh_.getGridDepth() == lodIndexSet.getGridDepth();
+}
+
+size_t Chunk::getTriangleCount() const {
+    if (usesDisplacement()) {
+        return static_cast<size_t>(CHUNK_VERTEX_RESOLUTION_X - 1) * (CHUNK_VERTEX_RESOLUTION_Z - 1) * 2;
+    }
+    return mesh_.getIndicesCount() / 3;
+}
+
+void Chunk::setResidency(MeshResidency residency) {
+    if (usesDisplacement()) {
+        return; // Heights live in the shared texture array
+    }
+    mesh_.setResidency(residency);
+}
+
+MeshResidency Chunk::getResidency() const {
+    return usesDisplacement() ? MeshResidency::GpuOnly : mesh_.getResidency();
+}
+
+size_t Chunk::getCpuBytes() const {
+    return mesh_.getCpuBytes() + displacementTexels_.capacity() * sizeof(uint16_t) + heights_.capacity() * sizeof(float);
+}
+
+size_t Chunk::getGpuBytes() const {
+    return mesh_.getGpuBytes();
+}
+
+size_t Chunk::getObjectBytes() const {
+    return sizeof(Chunk) + mesh_.getBookkeepingBytes();
+}
+
+size_t Chunk::getUploadBytes() const {
+    if (usesDisplacement()) {
+        return displacementTexels_.size() * sizeof(uint16_t);
+    }
+    return MESH_RESIDENCY == MeshResidency::CpuOnly ? 0 : mesh_.getPendingUploadBytes();
+}
+
+void Chunk::uploadDisplacement(HeightTextureArray& heightTextures) {
+    if (displacementTexels_.empty()) {
+        return;
+    }
+    if (heightLayer_ < 0) {
+        heightLayer_ = heightTextures.allocate();
+    }
+    if (heightLayer_ >= 0) {
+        heightTextures.upload(heightLayer_, displacementTexels_);
+    }
+    displacementTexelPool().recycle(displacementTexels_);
+}
+
+void Chunk::releaseDisplacement(HeightTextureArray& heightTextures) {
+    if (heightLayer_ >= 0) {
+        heightTextures.release(heightLayer_);
+        heightLayer_ = -1;
+    }
+}
+
+void Chunk::renderDisplaced(const ChunkUniforms& uniforms, const glm::dvec3& renderOrigin, const Mesh& sharedGrid, const GeoMipmapIndexSet* lodIndexSet,
+                            int level, int stitchMask) {
+    if (!isLoaded_ || !isActive_ || heightLayer_ < 0) {
+        return;
+    }
+    uniforms.model.set(getModelMatrix(renderOrigin));
+    uniforms.heightLayer.set(static_cast<float>(heightLayer_));
+
+    if (lodIndexSet && supportsLod(*lodIndexSet)) {
+        const GeoMipmapIndexSet::Range& range = lodIndexSet->getRange(level, stitchMask);
+        sharedGrid.drawWithIndexBuffer(lodIndexSet->getEBO(), lodIndexSet->getIndexType(), range.byteOffset, range.count);
+    } else {
+        sharedGrid.draw();
+    }
+}
+
+float Chunk::getLodError(int level) const {
+    if (lodLevelCount_ == 0) return 0.0f;
+    if (level < 0) level = 0;
+    if (level >= lodLevelCount_) level = lodLevelCount_ - 1;
+    return lodErrors_[level];
+}
@@ -0,0 +1,232 @@
+#include "terrain_clipmap.h"
+#include "terrain_chunk.h" // For the shared TERRAIN_* parameters and sampleTerrainHeight
+#include "IndexOptimizer.h"
+#include "Shader.h"
+#include <algorithm> // For std::min, std::max
+#include <chrono>
+#include <cmath>     // For std::floor
+#include <cstdlib>   // For std::abs
+#include <iostream>
+
+// Same unit as the CDLOD height tiles; units 0-2 hold the terrain material textures
+static const int CLIPMAP_HEIGHT_TEXTURE_UNIT = 3;
+
+ClipmapTerrain::ClipmapTerrain(const PerlinNoise* noiseGenerator, const ClipmapSettings& settings)
+    : noise_(noiseGenerator), settings_(settings), gpuReady_(false),
+      gridVAO_(0), gridVBO_(0), gridEBO_(0), heightTexture_(0) {
+    settings_.levels = std::max(1, std::min(settings_.levels, 16));
+    settings_.gridQuads = std::max(8, settings_.gridQuads / 4 * 4);
+    baseSpacing_ = Chunk::CHUNK_WORLD_SIZE_X / static_cast<float>(Chunk::CHUNK_VERTEX_RESOLUTION_X - 1);
+    textureSize_ = settings_.gridQuads + 4;
+    levels_.resize(settings_.levels);
+    for (int i = 0; i < RING_VARIANTS; ++i) {
+        variantOffsets_[i] = 0;
+        variantCounts_[i] = 0;
+    }
+
+    std::cout << "ClipmapTerrain created: " << settings_.levels << " levels of " << settings_.gridQuads << "x"
+              << settings_.gridQuads << " quads, extent " << getExtent() << std::endl;
+}
+
+ClipmapTerrain::~ClipmapTerrain() {
+    if (gridVAO_ != 0) glDeleteVertexArrays(1, &gridVAO_);
+    if (gridVBO_ != 0) glDeleteBuffers(1, &gridVBO_);
+    if (gridEBO_ != 0) glDeleteBuffers(1, &gridEBO_);
+    if (heightTexture_ != 0) glDeleteTextures(1, &heightTexture_);
+}
+
+float ClipmapTerrain::computeExtent(const ClipmapSettings& settings) {
+    float baseSpacing = Chunk::CHUNK_WORLD_SIZE_X / static_cast<float>(Chunk::CHUNK_VERTEX_RESOLUTION_X - 1);
+    return baseSpacing * static_cast<float>(1 << (settings.levels - 1)) * settings.gridQuads * 0.5f;
+}
+
+void ClipmapTerrain::setupGPU() {
+    if (gpuReady_) return;
+    gpuReady_ = true;
+
+    int quads = settings_.gridQuads;
+    int resolution = quads + 1;
+    std::vector<float> gridCoords;
+    gridCoords.reserve(static_cast<size_t>(resolution) * resolution * 2);
+    for (int z = 0; z < resolution; ++z) {
+        for (int x = 0; x < resolution; ++x) {
+            gridCoords.push_back(static_cast<float>(x));
+            gridCoords.push_back(static_cast<float>(z));
+        }
+    }
+
+    // Each ring leaves a (quads / 2)^2 hole for the next finer level. Depending on how the finer level snapped,
+    // the hole starts one quad further along x and/or z, hence four ring variants plus the full grid for level 0.
+    std::vector<uint16_t> indices;
+    std::vector<unsigned int> triangles;
+    std::vector<unsigned int> ordered;
+    size_t vertexCount = static_cast<size_t>(resolution) * resolution;
+    for (int variant = 0; variant < RING_VARIANTS; ++variant) {
+        bool hasHole = variant < 4;
+        int holeX = quads / 4 + (variant & 1);
+        int holeZ = quads / 4 + (variant >> 1);
+        triangles.clear();
+        for (int z = 0; z < quads; ++z) {
+            for (int x = 0; x < quads; ++x) {
+                if (hasHole && x >= holeX && x < holeX + quads / 2 && z >= holeZ && z < holeZ + quads / 2) continue;
+                unsigned int topLeft = z * resolution + x;
+                unsigned int topRight = topLeft + 1;
+                unsigned int bottomLeft = (z + 1) * resolution + x;
+                unsigned int bottomRight = bottomLeft + 1;
+                triangles.insert(triangles.end(), { topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight });
+            }
+        }
+        IndexOptimizer::optimizeTipsify(triangles, vertexCount, IndexBuildOptions().cacheSize, ordered);
+        variantOffsets_[variant] = static_cast<GLsizei>(indices.size());
+        variantCounts_[variant] = static_cast<GLsizei>(ordered.size());
+        for (unsigned int index : ordered) indices.push_back(static_cast<uint16_t>(index));
+    }
+
+    glGenVertexArrays(1, &gridVAO_);
+    glGenBuffers(1, &gridVBO_);
+    glGenBuffers(1, &gridEBO_);
+    glBindVertexArray(gridVAO_);
+    glBindBuffer(GL_ARRAY_BUFFER, gridVBO_);
+    glBufferData(GL_ARRAY_BUFFER, gridCoords.size() * sizeof(float), gridCoords.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridEBO_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glBindVertexArray(0);
+
+    // GL_REPEAT does the toroidal addressing: texel (x mod size, z mod size) holds world texel (x, z)
+    glGenTextures(1, &heightTexture_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, heightTexture_);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, textureSize_, textureSize_, settings_.levels, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void ClipmapTerrain::updateRegion(int level, int x0, int z0, int width, int depth) {
+    if (width <= 0 || depth <= 0 || !noise_) return;
+    float spacing = getLevelSpacing(level);
+
+    // Split into at most 2x2 rectangles that do not cross the texture edge
+    for (int zStart = z0; zStart < z0 + depth;) {
+        int texZ = wrap(zStart, textureSize_);
+        int rows = std::min(z0 + depth - zStart, textureSize_ - texZ);
+        for (int xStart = x0; xStart < x0 + width;) {
+            int texX = wrap(xStart, textureSize_);
+            int columns = std::min(x0 + width - xStart, textureSize_ - texX);
+
+            scratch_.resize(static_cast<size_t>(columns) * rows);
+            for (int z = 0; z < rows; ++z) {
+                for (int x = 0; x < columns; ++x) {
+                    double worldX = static_cast<double>(xStart + x) * spacing;
+                    double worldZ = static_cast<double>(zStart + z) * spacing;
+                    scratch_[z * columns + x] = Chunk::sampleTerrainHeight(*noise_, worldX, worldZ) * Chunk::MESH_VERTICAL_SCALE;
+                }
+            }
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, texX, texZ, level, columns, rows, 1, GL_RED, GL_FLOAT, scratch_.data());
+            stats_.texelsUpdated += columns * rows;
+            xStart += columns;
+        }
+        zStart += rows;
+    }
+}
+
+void ClipmapTerrain::update(const glm::dvec3& viewerPosition) {
+    auto start = std::chrono::high_resolution_clock::now();
+    setupGPU();
+    stats_.texelsUpdated = 0;
+    stats_.levelsUpdated = 0;
+
+    int quads = settings_.gridQuads;
+    int window = quads + 3; // Grid vertices plus one border texel on each side for normals
+    glBindTexture(GL_TEXTURE_2D_ARRAY, heightTexture_);
+    for (int level = 0; level < settings_.levels; ++level) {
+        // Snap to every other vertex so this level's grid lands on the next coarser level's vertices
+        double spacing = getLevelSpacing(level);
+        int originX = static_cast<int>(std::floor(viewerPosition.x / (2.0 * spacing))) * 2 - quads / 2;
+        int originZ = static_cast<int>(std::floor(viewerPosition.z / (2.0 * spacing))) * 2 - quads / 2;
+        Level& state = levels_[level];
+        if (state.valid && originX == state.originX && originZ == state.originZ) continue;
+
+        int newX = originX - 1, newZ = originZ - 1;
+        int oldX = state.originX - 1, oldZ = state.originZ - 1;
+        if (!state.valid || std::abs(newX - oldX) >= window || std::abs(newZ - oldZ) >= window) {
+            updateRegion(level, newX, newZ, window, window);
+        } else {
+            // L-shaped update: the columns that scrolled in (full height), then the rows (over the kept columns)
+            if (newX > oldX) updateRegion(level, oldX + window, newZ, newX - oldX, window);
+            else if (newX < oldX) updateRegion(level, newX, newZ, oldX - newX, window);
+            int keptX0 = std::max(newX, oldX);
+            int keptX1 = std::min(newX, oldX) + window;
+            if (newZ > oldZ) updateRegion(level, keptX0, oldZ + window, keptX1 - keptX0, newZ - oldZ);
+            else if (newZ < oldZ) updateRegion(level, keptX0, newZ, keptX1 - keptX0, oldZ - newZ);
+        }
+        state.originX = originX;
+        state.originZ = originZ;
+        state.valid = true;
+        stats_.levelsUpdated++;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    stats_.updateMs = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void ClipmapTerrain::render(Shader& shader, const glm::dvec3& renderOrigin) {
+    setupGPU();
+    stats_.trianglesDrawn = 0;
+
+    shader.setInt("heightLevels", CLIPMAP_HEIGHT_TEXTURE_UNIT);
+    shader.setFloat("gridQuads", static_cast<float>(settings_.gridQuads));
+    shader.setFloat("levelTextureSize", static_cast<float>(textureSize_));
+    shader.setFloat("transitionWidth", std::max(1.0f, settings_.gridQuads * 0.5f * settings_.transitionRatio));
+    shader.setFloat("textureWorldSize", Chunk::CHUNK_WORLD_SIZE_X);
+    glm::dvec2 originRepeats = glm::dvec2(renderOrigin.x, renderOrigin.z) / static_cast<double>(Chunk::CHUNK_WORLD_SIZE_X);
+    shader.setVec2("textureOrigin", glm::vec2(originRepeats - glm::floor(originRepeats)));
+
+    glActiveTexture(GL_TEXTURE0 + CLIPMAP_HEIGHT_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, heightTexture_);
+    glBindVertexArray(gridVAO_);
+
+    // Set once per level: resolved here rather than looked up by name in the loop
+    UniformHandle<glm::vec2> levelOrigin = shader.uniform<glm::vec2>("levelOrigin");
+    UniformHandle<glm::vec2> levelTexelOrigin = shader.uniform<glm::vec2>("levelTexelOrigin");
+    UniformHandle<float> levelSpacing = shader.uniform<float>("levelSpacing");
+    UniformHandle<float> levelIndex = shader.uniform<float>("levelIndex");
+    UniformHandle<bool> hasCoarserLevel = shader.uniform<bool>("hasCoarserLevel");
+
+    int quads = settings_.gridQuads;
+    for (int level = 0; level < settings_.levels; ++level) {
+        const Level& state = levels_[level];
+        if (!state.valid) continue;
+
+        int variant = 4;
+        if (level > 0 && levels_[level - 1].valid) {
+            // Where the finer level's grid starts inside this one, relative to the centered position
+            int holeOffsetX = levels_[level - 1].originX / 2 - state.originX - quads / 4;
+            int holeOffsetZ = levels_[level - 1].originZ / 2 - state.originZ - quads / 4;
+            variant = std::max(0, std::min(holeOffsetX, 1)) + 2 * std::max(0, std::min(holeOffsetZ, 1));
+        }
+
+        // Placed relative to the render origin (in double), and the texel origin wrapped to twice the texture
+        // size: still the same texels in this level and, halved, in the next coarser one, but small numbers
+        double spacing = getLevelSpacing(level);
+        int wrap = 2 * textureSize_;
+        levelOrigin.set(glm::vec2(static_cast<float>(state.originX * spacing - renderOrigin.x),
+                                  static_cast<float>(state.originZ * spacing - renderOrigin.z)));
+        levelTexelOrigin.set(glm::vec2(static_cast<float>(((state.originX % wrap) + wrap) % wrap),
+                                       static_cast<float>(((state.originZ % wrap) + wrap) % wrap)));
+        levelSpacing.set(static_cast<float>(spacing));
+        levelIndex.set(static_cast<float>(level));
+        hasCoarserLevel.set(level + 1 < settings_.levels);
+
+        glDrawElements(GL_TRIANGLES, variantCounts_[variant], GL_UNSIGNED_SHORT,
+                       reinterpret_cast<const void*>(static_cast<size_t>(variantOffsets_[variant]) * sizeof(uint16_t)));
+        stats_.trianglesDrawn += variantCounts_[variant] / 3;
+    }
+
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,378 @@
+#include "terrain_far_field.h"
+#include "terrain_chunk.h" // For the shared TERRAIN_* parameters and sampleTerrainHeight
+#include "Shader.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm> // For std::min, std::max
+#include <chrono>
+#include <cmath>     // For std::floor
+#include <cstdlib>   // For std::abs
+#include <iostream>
+
+FarFieldTerrain::FarFieldTerrain(const PerlinNoise* noiseGenerator, const FarFieldSettings& settings)
+    : noise_(noiseGenerator), settings_(settings) {
+    settings_.tileChunks = std::max(1, settings_.tileChunks);
+    // Every chunk edge must fall on a vertex line, so a cell can be drawn (and skipped) on its own
+    int quadsPerCell = std::max(1, (settings_.tileResolution - 1) / settings_.tileChunks);
+    settings_.tileResolution = quadsPerCell * settings_.tileChunks + 1;
+    settings_.octaves = std::max(1, std::min(settings_.octaves, Chunk::TERRAIN_OCTAVES));
+    settings_.radiusTiles = std::max(1, settings_.radiusTiles);
+    settings_.maxQueued = std::max<size_t>(1, settings_.maxQueued);
+    settings_.maxBuildsPerFrame = std::max(1, settings_.maxBuildsPerFrame);
+    tileWorldSize_ = Chunk::CHUNK_WORLD_SIZE_X * static_cast<float>(settings_.tileChunks);
+    vertexSpacing_ = tileWorldSize_ / static_cast<float>(settings_.tileResolution - 1);
+    // Far and near surfaces never differ by more than the height range, so skirts this deep close any seam
+    skirtDepth_ = settings_.skirtDepth > 0.0f ? settings_.skirtDepth
+                                              : (Chunk::TERRAIN_MAX_HEIGHT - Chunk::TERRAIN_MIN_HEIGHT) * Chunk::MESH_VERTICAL_SCALE;
+
+    std::cout << "FarFieldTerrain created: tiles of " << settings_.tileChunks << "x" << settings_.tileChunks << " chunks at "
+              << settings_.tileResolution << "x" << settings_.tileResolution << " vertices, " << settings_.octaves
+              << " octaves, " << settings_.radiusTiles << " rings, extent " << computeExtent(settings_) << std::endl;
+}
+
+FarFieldTerrain::~FarFieldTerrain() {
+    // The owner stops its workers first, so no build is running; the meshes free their GL objects
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    queue_.clear();
+}
+
+float FarFieldTerrain::computeExtent(const FarFieldSettings& settings) {
+    return Chunk::CHUNK_WORLD_SIZE_X * static_cast<float>(std::max(1, settings.tileChunks)) *
+           (static_cast<float>(std::max(1, settings.radiusTiles)) + 0.5f);
+}
+
+Vec2i FarFieldTerrain::tileOfChunk(Vec2i chunkCoords) const {
+    return Vec2i(static_cast<int>(std::floor(static_cast<float>(chunkCoords.x) / settings_.tileChunks)),
+                 static_cast<int>(std::floor(static_cast<float>(chunkCoords.z) / settings_.tileChunks)));
+}
+
+glm::dvec3 FarFieldTerrain::tileOrigin(Vec2i tileCoords) const {
+    return glm::dvec3(static_cast<double>(tileCoords.x) * tileWorldSize_, 0.0, static_cast<double>(tileCoords.z) * tileWorldSize_);
+}
+
+bool FarFieldTerrain::tileInsideLoadSquare(Vec2i tileCoords, Vec2i cameraChunkCoords, int loadRadius) const {
+    if (loadRadius < 0) {
+        return false;
+    }
+    int x0 = tileCoords.x * settings_.tileChunks;
+    int z0 = tileCoords.z * settings_.tileChunks;
+    int x1 = x0 + settings_.tileChunks - 1;
+    int z1 = z0 + settings_.tileChunks - 1;
+    return x0 >= cameraChunkCoords.x - loadRadius && x1 <= cameraChunkCoords.x + loadRadius &&
+           z0 >= cameraChunkCoords.z - loadRadius && z1 <= cameraChunkCoords.z + loadRadius;
+}
+
+void FarFieldTerrain::releaseTile(TileSlot& slot) {
+    if (!slot.tile || slot.tile->resident) {
+        slot.tile.reset();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (slot.tile->state == TileState::Queued) {
+            // No worker has it: drop it from the queue (its job then finds nothing to do)
+            Tile* tile = slot.tile.get();
+            queue_.erase(std::remove_if(queue_.begin(), queue_.end(), [tile](const QueuedTile& queued) { return queued.tile == tile; }),
+                         queue_.end());
+        } else {
+            // A worker has it, or it waits in completed_: freed once uploadCompletedTiles sees it
+            slot.tile->cancelled = true;
+            cancelled_.push_back(std::move(slot.tile));
+            return;
+        }
+    }
+    slot.tile.reset();
+}
+
+size_t FarFieldTerrain::update(Vec2i cameraChunkCoords, int loadRadius) {
+    uploadCompletedTiles();
+
+    Vec2i centerTile = tileOfChunk(cameraChunkCoords);
+    if (!tilesInitialized_) {
+        tilesInitialized_ = true;
+        tiles_.reset(settings_.radiusTiles, centerTile);
+    } else {
+        tiles_.recenter(centerTile, [this](const Vec2i&, TileSlot& slot) { releaseTile(slot); });
+    }
+
+    // The rings are only walked when the chunks around the camera changed, or to continue an interrupted fill
+    bool moved = !(cameraChunkCoords == lastCameraChunk_) || loadRadius != lastLoadRadius_;
+    size_t queueSize;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        queueSize = queue_.size();
+    }
+    if (!moved && !(refillPending_ && queueSize < settings_.maxQueued)) {
+        return 0;
+    }
+    lastCameraChunk_ = cameraChunkCoords;
+    lastLoadRadius_ = loadRadius;
+    refillPending_ = false;
+
+    // Nearest rings first, so the ground just beyond the chunks fills in before the horizon
+    size_t queued = 0;
+    for (int ring = 0; ring <= settings_.radiusTiles; ++ring) {
+        for (int dz = -ring; dz <= ring; ++dz) {
+            for (int dx = -ring; dx <= ring; ++dx) {
+                if (std::abs(dx) != ring && std::abs(dz) != ring) {
+                    continue; // Inner rings were visited already
+                }
+                Vec2i coords(centerTile.x + dx, centerTile.z + dz);
+                TileSlot& slot = tiles_.at(coords);
+                if (slot.tile && !moved) {
+                    continue;
+                }
+                // Inside the load square the chunks are on their way: nothing is requested there and requests
+                // not yet built are dropped, but built tiles stay, ready for when the camera moves away again.
+                // Outside it tiles are built even where chunks are still drawable (the unload hysteresis), so
+                // the ground is covered the moment those chunks unload.
+                bool insideLoadSquare = tileInsideLoadSquare(coords, cameraChunkCoords, loadRadius);
+                if (slot.tile) {
+                    if (insideLoadSquare && !slot.tile->resident) {
+                        releaseTile(slot);
+                    }
+                    continue;
+                }
+                if (insideLoadSquare) {
+                    continue;
+                }
+                if (queueSize >= settings_.maxQueued) {
+                    refillPending_ = true;
+                    continue;
+                }
+                slot.tile = std::make_unique<Tile>();
+                slot.tile->coords = coords;
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex_);
+                    queue_.push_back({ slot.tile.get(), ring });
+                }
+                queueSize++;
+                queued++;
+            }
+        }
+    }
+    return queued;
+}
+
+bool FarFieldTerrain::hasQueuedTiles() {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return !queue_.empty();
+}
+
+bool FarFieldTerrain::buildNext() {
+    Tile* tile = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (queue_.empty()) {
+            return false;
+        }
+        auto nearest = std::min_element(queue_.begin(), queue_.end(),
+                                        [](const QueuedTile& a, const QueuedTile& b) { return a.ring < b.ring; });
+        tile = nearest->tile;
+        *nearest = queue_.back();
+        queue_.pop_back();
+        tile->state = TileState::Generating; // Under the lock, so releaseTile knows a worker has it
+    }
+
+    auto buildStart = std::chrono::high_resolution_clock::now();
+    if (!tile->cancelled) {
+        buildTile(*tile);
+    }
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+
+    std::lock_guard<std::mutex> lock(completedMutex_);
+    completed_.push_back(tile);
+    completedMs_.push_back(buildMs);
+    return true;
+}
+
+void FarFieldTerrain::buildTile(Tile& tile) const {
+    const int n = settings_.tileResolution;
+    const int quadsPerCell = (n - 1) / settings_.tileChunks;
+    const int borderedN = n + 2;
+    const glm::dvec3 origin = tileOrigin(tile.coords);
+    const float verticalScale = Chunk::MESH_VERTICAL_SCALE;
+
+    // Heights with a one-vertex border, for central-difference normals that match across tile edges
+    std::vector<float> heights(static_cast<size_t>(borderedN) * borderedN);
+    for (int z = -1; z <= n; ++z) {
+        for (int x = -1; x <= n; ++x) {
+            double worldX = origin.x + static_cast<double>(x) * vertexSpacing_;
+            double worldZ = origin.z + static_cast<double>(z) * vertexSpacing_;
+            heights[static_cast<size_t>(z + 1) * borderedN + (x + 1)] =
+                Chunk::sampleTerrainHeight(*noise_, worldX, worldZ, settings_.octaves) * verticalScale;
+        }
+    }
+    auto heightAt = [&](int x, int z) { return heights[static_cast<size_t>(z + 1) * borderedN + (x + 1)]; };
+
+    // Relative to the tile's center, like a chunk mesh, and shifted by half a chunk vertex spacing the way
+    // Mesh::generateFromHeightMap places chunk vertices, so cell edges lie exactly on the chunk edges
+    float chunkVertexSpacing = Chunk::CHUNK_WORLD_SIZE_X / static_cast<float>(Chunk::CHUNK_VERTEX_RESOLUTION_X - 1);
+    float localOffset = -tileWorldSize_ * 0.5f - chunkVertexSpacing * 0.5f;
+
+    Mesh& mesh = tile.mesh;
+    mesh.vertices.reserve(static_cast<size_t>(n) * n * 2);
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x) {
+            Vertex vertex;
+            vertex.Position = glm::vec3(static_cast<float>(x) * vertexSpacing_ + localOffset, heightAt(x, z),
+                                        static_cast<float>(z) * vertexSpacing_ + localOffset);
+            vertex.Normal = glm::normalize(glm::vec3(heightAt(x - 1, z) - heightAt(x + 1, z), 2.0f * vertexSpacing_,
+                                                     heightAt(x, z - 1) - heightAt(x, z + 1)));
+            // Chunk units, so the material textures repeat at the chunks' rate
+            vertex.TexCoords = glm::vec2(static_cast<float>(x) * vertexSpacing_ / Chunk::CHUNK_WORLD_SIZE_X,
+                                         static_cast<float>(z) * vertexSpacing_ / Chunk::CHUNK_WORLD_SIZE_Z);
+            mesh.vertices.push_back(vertex);
+        }
+    }
+
+    // One skirt vertex under every vertex on a cell edge, shared by the cells on both sides
+    std::vector<int> skirtIndex(static_cast<size_t>(n) * n, -1);
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x) {
+            if (x % quadsPerCell != 0 && z % quadsPerCell != 0) {
+                continue;
+            }
+            size_t top = static_cast<size_t>(z) * n + x;
+            Vertex skirt = mesh.vertices[top];
+            skirt.Position.y -= skirtDepth_;
+            skirtIndex[top] = static_cast<int>(mesh.vertices.size());
+            mesh.vertices.push_back(skirt);
+        }
+    }
+
+    // Indices cell by cell (surface, then the four skirts), so each cell is one contiguous range
+    int cells = settings_.tileChunks * settings_.tileChunks;
+    tile.cellCounts.assign(static_cast<size_t>(cells), 0);
+    tile.cellFirst.assign(static_cast<size_t>(cells), 0);
+    mesh.indices.clear();
+    mesh.indices.reserve(static_cast<size_t>(cells) * quadsPerCell * (quadsPerCell + 4) * 6);
+    auto vertexIndex = [n](int x, int z) { return static_cast<unsigned int>(z * n + x); };
+    for (int cellZ = 0; cellZ < settings_.tileChunks; ++cellZ) {
+        for (int cellX = 0; cellX < settings_.tileChunks; ++cellX) {
+            size_t cell = static_cast<size_t>(cellZ) * settings_.tileChunks + cellX;
+            tile.cellFirst[cell] = static_cast<uint32_t>(mesh.indices.size());
+            int x0 = cellX * quadsPerCell, z0 = cellZ * quadsPerCell;
+            int x1 = x0 + quadsPerCell, z1 = z0 + quadsPerCell;
+            // Same winding as IndexOptimizer::buildGridTriangles
+            for (int z = z0; z < z1; ++z) {
+                for (int x = x0; x < x1; ++x) {
+                    unsigned int topLeft = vertexIndex(x, z), topRight = vertexIndex(x + 1, z);
+                    unsigned int bottomLeft = vertexIndex(x, z + 1), bottomRight = vertexIndex(x + 1, z + 1);
+                    mesh.indices.insert(mesh.indices.end(), { topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight });
+                }
+            }
+            // Each edge walked so its skirt faces away from the cell: -Z and +X forward, +Z and -X backward
+            struct Edge { int startX, startZ, stepX, stepZ; };
+            const Edge edges[4] = { { x0, z0, 1, 0 }, { x1, z0, 0, 1 }, { x1, z1, -1, 0 }, { x0, z1, 0, -1 } };
+            for (const Edge& edge : edges) {
+                for (int i = 0; i < quadsPerCell; ++i) {
+                    int ax = edge.startX + edge.stepX * i, az = edge.startZ + edge.stepZ * i;
+                    unsigned int a = vertexIndex(ax, az);
+                    unsigned int b = vertexIndex(ax + edge.stepX, az + edge.stepZ);
+                    unsigned int skirtA = static_cast<unsigned int>(skirtIndex[a]);
+                    unsigned int skirtB = static_cast<unsigned int>(skirtIndex[b]);
+                    mesh.indices.insert(mesh.indices.end(), { a, b, skirtB, a, skirtB, skirtA });
+                }
+            }
+            tile.cellCounts[cell] = static_cast<GLsizei>(mesh.indices.size() - tile.cellFirst[cell]);
+        }
+    }
+
+    BoundingBox bounds;
+    for (const Vertex& vertex : mesh.vertices) {
+        bounds.min = glm::min(bounds.min, vertex.Position);
+        bounds.max = glm::max(bounds.max, vertex.Position);
+    }
+    mesh.boundingBox = bounds;
+    glm::vec3 center(origin + glm::dvec3(tileWorldSize_ * 0.5, 0.0, tileWorldSize_ * 0.5));
+    tile.worldBounds.min = bounds.min + center;
+    tile.worldBounds.max = bounds.max + center;
+
+    // The cell order must survive the index build: no reordering, only the 16-bit packing
+    IndexBuildOptions options;
+    options.ordering = VertexCacheOrdering::None;
+    options.topology = IndexTopology::Triangles;
+    mesh.setIndexBuildOptions(options);
+    mesh.prepareGpuData();
+}
+
+void FarFieldTerrain::uploadCompletedTiles() {
+    std::vector<Tile*> tiles;
+    std::vector<double> buildMs;
+    {
+        std::lock_guard<std::mutex> lock(completedMutex_);
+        tiles.swap(completed_);
+        buildMs.swap(completedMs_);
+    }
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        Tile* tile = tiles[i];
+        stats_.tilesBuilt++;
+        stats_.buildMs += buildMs[i];
+        if (tile->cancelled) {
+            cancelled_.erase(std::remove_if(cancelled_.begin(), cancelled_.end(),
+                                            [tile](const std::unique_ptr<Tile>& owned) { return owned.get() == tile; }),
+                             cancelled_.end());
+            continue;
+        }
+        tile->mesh.setResidency(MeshResidency::GpuOnly); // Uploads, then frees the CPU copy
+        tile->resident = true;
+    }
+
+    stats_.tilesResident = 0;
+    stats_.tilesPending = 0;
+    if (tiles_.isValid()) {
+        tiles_.forEach([this](const Vec2i&, const TileSlot& slot) {
+            if (!slot.tile) return;
+            if (slot.tile->resident) stats_.tilesResident++;
+            else stats_.tilesPending++;
+        });
+    }
+}
+
+void FarFieldTerrain::render(Shader& shader, const Frustum& frustum, const glm::dvec3& renderOrigin, const ChunkCoverageFn& chunkDrawable) {
+    stats_.tilesDrawn = 0;
+    stats_.cellsDrawn = 0;
+    stats_.cellsReplaced = 0;
+    stats_.trianglesDrawn = 0;
+    if (!tiles_.isValid()) {
+        return;
+    }
+
+    UniformHandle<glm::mat4> model = shader.uniform<glm::mat4>("model");
+    tiles_.forEach([&](const Vec2i& coords, TileSlot& slot) {
+        Tile* tile = slot.tile.get();
+        if (!tile || !tile->resident || !frustum.isAABBVisible(tile->worldBounds)) {
+            return;
+        }
+        // Cells whose chunk is drawable are left out; neighboring drawn cells merge into one range
+        drawCounts_.clear();
+        drawOffsets_.clear();
+        size_t indexSize = tile->mesh.getIndexSize();
+        size_t lastDrawn = tile->cellCounts.size(); // None yet
+        for (int cellZ = 0; cellZ < settings_.tileChunks; ++cellZ) {
+            for (int cellX = 0; cellX < settings_.tileChunks; ++cellX) {
+                size_t cell = static_cast<size_t>(cellZ) * settings_.tileChunks + cellX;
+                if (chunkDrawable(Vec2i(coords.x * settings_.tileChunks + cellX, coords.z * settings_.tileChunks + cellZ))) {
+                    stats_.cellsReplaced++;
+                    continue;
+                }
+                if (lastDrawn + 1 == cell) {
+                    drawCounts_.back() += tile->cellCounts[cell];
+                } else {
+                    drawCounts_.push_back(tile->cellCounts[cell]);
+                    drawOffsets_.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(tile->cellFirst[cell]) * indexSize));
+                }
+                lastDrawn = cell;
+                stats_.cellsDrawn++;
+                stats_.trianglesDrawn += static_cast<size_t>(tile->cellCounts[cell]) / 3;
+            }
+        }
+        if (drawCounts_.empty()) {
+            return;
+        }
+        glm::dvec3 center = tileOrigin(coords) + glm::dvec3(tileWorldSize_ * 0.5, 0.0, tileWorldSize_ * 0.5);
+        model.set(glm::translate(glm::mat4(1.0f), glm::vec3(center - renderOrigin)));
+        tile->mesh.drawRanges(drawCounts_.data(), drawOffsets_.data(), static_cast<GLsizei>(drawCounts_.size()));
+        stats_.tilesDrawn++;
+    });
+}
@@ -1,5 +1,11 @@
 #include "terrain_manager.h"
 #include "Shader.h" 
+#include "ScratchArena.h"
+#include <algorithm> // For std::min, std::max
+#include <chrono>
+
+// Texture unit for the displaced chunks' height array; units 0-2 hold the terrain material textures
+static const int CHUNK_HEIGHT_TEXTURE_UNIT = 3;
 
 TerrainManager::TerrainManager(int pLoadRadius)
     : loadRadius(pLoadRadius), lastCameraChunkCoords_(-9999, -9999), firstUpdate_(true) {
@@ -7,10 +13,26 @@ TerrainManager::TerrainManager(int pLoadRadius)
     std::cout << "TerrainManager created with load radius: " << loadRadius << std::endl;
 }
 
+TerrainManager::TerrainManager(int pLoadRadius, unsigned int seed)
+    : loadRadius(pLoadRadius), lastCameraChunkCoords_(-9999, -9999), firstUpdate_(true), perlinGenerator_(seed) {
+    std::cout << "TerrainManager created with load radius: " << loadRadius << ", seed " << seed << std::endl;
+}
+
 TerrainManager::~TerrainManager() {
+    // Stop the workers first: a running build still points at its chunk
+    workers_.reset();
+    farField_.reset();
+    buildQueue_.clear();
+    prefetchQueue_.clear();
+    prefetchChunks_.clear();
+    prefetchedChunks_.clear();
+    cancelledChunks_.clear();
+    evictedChunks_.clear(droppedChunks_);
+    droppedChunks_.clear();
+    spareChunks_.clear();
     // unique_ptr will automatically delete the Chunk objects,
     // which in turn will call their destructors (and their unload methods).
-    activeChunks_.clear();
+    chunkWindow_ = ChunkWindow<ChunkSlot>();
     std::cout << "TerrainManager destroyed, all active chunks cleared." << std::endl;
 }
 
@@ -23,90 +45,1381 @@ Vec2i TerrainManager::getCameraChunkCoordinates(const Camera& camera) const {
 }
 
 void TerrainManager::update(const Camera& camera) {
+    if (renderMode == TerrainRenderMode::Cdlod) {
+        return; // Heights are generated per quadtree node by CdlodTerrain
+    }
+    if (renderMode == TerrainRenderMode::Clipmap) {
+        if (!clipmapTerrain_) {
+            clipmapTerrain_ = std::make_unique<ClipmapTerrain>(&perlinGenerator_, clipmapSettings);
+        }
+        clipmapTerrain_->update(camera.Position);
+        return;
+    }
+
+    if (farField.enabled && !farField_) {
+        farField_ = std::make_unique<FarFieldTerrain>(&perlinGenerator_, farField);
+    }
+
+    MeshBufferPool& bufferPool = MeshBufferPool::instance();
+    bufferPool.setEnabled(pooling.enabled);
+    bufferPool.setMaxIdleBytes(pooling.maxIdleBufferBytes);
+    bufferPool.setReuseDelayFrames(pooling.bufferReuseDelayFrames);
+    bufferPool.advanceFrame();
+    if (!pooling.enabled) {
+        spareChunks_.clear();
+    }
+
     Vec2i currentCameraChunkCoords = getCameraChunkCoordinates(camera);
+    updateCameraMotion(camera);
 
-    if (currentCameraChunkCoords == lastCameraChunkCoords_ && !firstUpdate_) {
-        return; // Camera hasn't moved to a new chunk, no update needed
+    // The desired set only changes when the camera moves to a new chunk
+    bool chunkChanged = !(currentCameraChunkCoords == lastCameraChunkCoords_) || firstUpdate_;
+    if (chunkChanged) {
+        lastCameraChunkCoords_ = currentCameraChunkCoords;
+        firstUpdate_ = false;
+        updateDesiredChunks(currentCameraChunkCoords);
+    } else if (loadRegionNeedsRefresh() || loadRadius != windowLoadRadius_) {
+        updateDesiredChunks(currentCameraChunkCoords); // A view-dependent region turned with the camera, or the radius changed
+    } else {
+        reprioritizeBuildQueue(); // The camera turned or moved within its chunk
     }
-    lastCameraChunkCoords_ = currentCameraChunkCoords;
-    firstUpdate_ = false;
 
-    std::cout << "TerrainManager update: Camera in chunk (" << currentCameraChunkCoords.x << ", " << currentCameraChunkCoords.z << ")" << std::endl;
+    // Chunks the camera is heading for are generated in the workers' idle time
+    if (!prefetch.enabled) {
+        cancelQueuedPrefetches();
+    } else if (chunkChanged || std::chrono::duration<float>(std::chrono::steady_clock::now() - lastPrefetchPlan_).count() >= prefetch.replanSeconds) {
+        planPrefetch(currentCameraChunkCoords);
+    }
+    // Coarse tiles beyond the chunks, built only when the workers have nothing else to do
+    updateFarField(currentCameraChunkCoords);
 
-    // Determine the set of chunks that *should* be active
-    std::vector<Vec2i> desiredActiveChunks;
-    desiredActiveChunks.reserve((2 * loadRadius + 1) * (2 * loadRadius + 1));
+    // Every frame: upload whatever the workers finished since the last one
+    processCompletedBuilds();
+}
 
-    for (int dz = -loadRadius; dz <= loadRadius; ++dz) {
-        for (int dx = -loadRadius; dx <= loadRadius; ++dx) {
-            desiredActiveChunks.push_back(Vec2i(currentCameraChunkCoords.x + dx, currentCameraChunkCoords.z + dz));
+void TerrainManager::reportFrameTime(float frameMs) {
+    AdaptiveRadiusStatus& status = adaptiveStatus_;
+    if (!adaptiveRadius.enabled || renderMode != TerrainRenderMode::Chunks) {
+        status.radius = loadRadius;
+        status.lodBias = 1.0f;
+        return;
+    }
+    frameMs = std::max(frameMs, 0.0f);
+    adaptiveClockSeconds_ += frameMs / 1000.0f;
+    // The average starts at the target rather than the first sample, and one slow frame (a shader compile,
+    // a window drag, a stall while loading) only counts as a few times the target. Otherwise a single hitch
+    // weighs on the average for dozens of frames and the controller shrinks the radius for nothing.
+    float targetFrameMs = std::max(adaptiveRadius.targetFrameMs, 0.1f);
+    float sampleMs = std::min(frameMs, targetFrameMs * std::max(adaptiveRadius.maxSampleFactor, 1.0f));
+    if (status.smoothedFrameMs <= 0.0f) {
+        status.smoothedFrameMs = targetFrameMs;
+    }
+    status.smoothedFrameMs += (sampleMs - status.smoothedFrameMs) * std::min(std::max(adaptiveRadius.smoothing, 0.0f), 1.0f);
+    {
+        std::lock_guard<std::mutex> lock(buildQueueMutex_);
+        status.backlog = buildQueue_.size() + uploadQueue_.size();
+    }
+
+    int minRadius = std::max(0, adaptiveRadius.minRadius);
+    int maxRadius = std::max(minRadius, adaptiveRadius.maxRadius);
+    float maxLodBias = std::max(1.0f, adaptiveRadius.maxLodBias);
+    float lodBiasStep = std::max(1.01f, adaptiveRadius.lodBiasStep);
+    if (loadRadius < minRadius || loadRadius > maxRadius) {
+        loadRadius = std::min(std::max(loadRadius, minRadius), maxRadius); // Into the bounds before any control
+        adaptiveHoldUntil_ = adaptiveClockSeconds_ + adaptiveRadius.holdSeconds;
+    }
+    status.radius = loadRadius;
+    if (adaptiveClockSeconds_ < adaptiveHoldUntil_) {
+        return; // Let the last change show in the smoothed frame time first
+    }
+
+    if (status.smoothedFrameMs > adaptiveRadius.targetFrameMs) {
+        // Over budget: coarser LOD is the cheaper loss, so it goes first
+        if (status.lodBias < maxLodBias) {
+            status.lodBias = std::min(maxLodBias, status.lodBias * lodBiasStep);
+        } else if (loadRadius > minRadius) {
+            // Remember the radius that did not fit; each repeated overrun doubles the wait before trying it again
+            overrunCooldownSeconds_ = overrunRadius_ == loadRadius ? std::min(overrunCooldownSeconds_ * 2.0, 8.0 * adaptiveRadius.retrySeconds)
+                                                                   : static_cast<double>(adaptiveRadius.retrySeconds);
+            overrunRadius_ = loadRadius;
+            overrunRetryAt_ = adaptiveClockSeconds_ + overrunCooldownSeconds_;
+            loadRadius--;
+            status.radiusDecreases++;
+            std::cout << "TerrainManager: Adaptive radius down to " << loadRadius << " (" << status.smoothedFrameMs << " ms frames)" << std::endl;
+        } else {
+            return; // Nothing left to give up
+        }
+    } else if (status.smoothedFrameMs < adaptiveRadius.targetFrameMs * (1.0f - adaptiveRadius.headroom)) {
+        size_t maxBacklog = adaptiveRadius.maxBacklog > 0 ? adaptiveRadius.maxBacklog : static_cast<size_t>(8 * (loadRadius + 1));
+        bool retryAllowed = loadRadius + 1 < overrunRadius_ || overrunRadius_ < 0 || adaptiveClockSeconds_ >= overrunRetryAt_;
+        if (status.lodBias > 1.0f) {
+            status.lodBias = std::max(1.0f, status.lodBias / lodBiasStep);
+        } else if (loadRadius < maxRadius && status.backlog <= maxBacklog && retryAllowed) {
+            loadRadius++; // The new ring is requested by this frame's update()
+            status.radiusIncreases++;
+            std::cout << "TerrainManager: Adaptive radius up to " << loadRadius << " (" << status.smoothedFrameMs << " ms frames)" << std::endl;
+        } else {
+            return; // At the bounds, still streaming the last ring, or waiting out an overrun
         }
+    } else {
+        return; // Within the band between the thresholds: hold
     }
+    status.radius = loadRadius;
+    adaptiveHoldUntil_ = adaptiveClockSeconds_ + adaptiveRadius.holdSeconds;
+}
 
-    // Step 1: Unload chunks that are no longer in the desired set
-    std::vector<Vec2i> chunksToUnloadKeys;
-    for (const auto& pair : activeChunks_) {
-        const Vec2i& loadedChunkCoord = pair.first;
-        bool foundInDesired = false;
-        for (const auto& desiredCoord : desiredActiveChunks) {
-            if (loadedChunkCoord == desiredCoord) {
-                foundInDesired = true;
-                break;
+void TerrainManager::updateDesiredChunks(Vec2i currentCameraChunkCoords) {
+    std::cout << "TerrainManager update: Camera in chunk (" << currentCameraChunkCoords.x << ", " << currentCameraChunkCoords.z << ")" << std::endl;
+
+    // Step 1: Move the window (sized to the unload radius). Chunks that leave it are unloaded (including ones
+    // still being built), and the positions that come within loadRadius are collected; for the square region only
+    // the strips along the edges are visited. Positions between the two radii keep their chunks but are not requested.
+    enteringChunks_.clear();
+    int windowRadius = getUnloadRadius();
+    Vec2i previousCenter = chunkWindow_.getCenter();
+    bool windowRebuilt = !chunkWindow_.isValid() || chunkWindow_.getRadius() != windowRadius;
+    if (windowRebuilt) {
+        resizeChunkWindow(currentCameraChunkCoords, windowRadius);
+    } else {
+        chunkWindow_.recenter(currentCameraChunkCoords, [this](const Vec2i&, ChunkSlot& slot) { unloadChunk(slot); });
+    }
+    if (loadRegion.shape != LoadRegionShape::Square) {
+        updateLoadRegion(currentCameraChunkCoords);
+    } else if (windowRebuilt || windowLoadRadius_ != loadRadius || windowShape_ != LoadRegionShape::Square) {
+        for (int dz = -loadRadius; dz <= loadRadius; ++dz) {
+            for (int dx = -loadRadius; dx <= loadRadius; ++dx) {
+                enteringChunks_.push_back(Vec2i(currentCameraChunkCoords.x + dx, currentCameraChunkCoords.z + dz));
             }
         }
-        if (!foundInDesired) {
-            chunksToUnloadKeys.push_back(loadedChunkCoord);
+        loadRegionChunks_ = static_cast<size_t>(2 * loadRadius + 1) * (2 * loadRadius + 1);
+    } else {
+        ChunkWindow<ChunkSlot>::forEachOutside(currentCameraChunkCoords, previousCenter, loadRadius,
+                                               [this](const Vec2i& coords) { enteringChunks_.push_back(coords); });
+    }
+    windowLoadRadius_ = loadRadius;
+    windowShape_ = loadRegion.shape;
+    // Chunks whose heights could not be generated are tried again on every move
+    for (const Vec2i& coords : retryChunks_) {
+        const ChunkSlot* slot = chunkWindow_.find(coords);
+        if (slot && !slot->chunk) {
+            enteringChunks_.push_back(coords);
+        }
+    }
+    retryChunks_.clear();
+
+    // Step 2: Request the new positions, most wanted first. Chunks requested earlier are rescored too, since the
+    // camera has moved since they were queued.
+    reprioritizeBuildQueue();
+    std::sort(enteringChunks_.begin(), enteringChunks_.end(), [this](const Vec2i& a, const Vec2i& b) {
+        return computeChunkPriority(a) < computeChunkPriority(b);
+    });
+    for (const Vec2i& coords : enteringChunks_) {
+        loadChunk(coords); // No-op where the hysteresis band still holds the chunk
+    }
+}
+
+void TerrainManager::resizeChunkWindow(Vec2i center, int radius) {
+    // First update, or the unload radius changed: keep the chunks that are still inside, unload the rest
+    std::vector<std::pair<Vec2i, ChunkSlot>> oldSlots;
+    if (chunkWindow_.isValid()) {
+        oldSlots.reserve(chunkWindow_.getSlotCount());
+        chunkWindow_.forEach([&oldSlots](const Vec2i& coords, ChunkSlot& slot) {
+            if (slot.chunk) {
+                oldSlots.emplace_back(coords, std::move(slot));
+            }
+        });
+    }
+    chunkWindow_.reset(radius, center);
+    for (auto& old : oldSlots) {
+        if (chunkWindow_.contains(old.first)) {
+            chunkWindow_.at(old.first) = std::move(old.second);
+        } else {
+            unloadChunk(old.second);
         }
     }
+}
+
+int TerrainManager::getUnloadRadius() const {
+    return std::max(loadRadius, unloadRadius < 0 ? loadRadius + 1 : unloadRadius);
+}
+
+float TerrainManager::regionDistance(Vec2i chunkCoords, Vec2i center) const {
+    glm::vec2 offset(static_cast<float>(chunkCoords.x - center.x), static_cast<float>(chunkCoords.z - center.z));
+    if (loadRegion.shape != LoadRegionShape::ViewEllipse || cameraViewDirection_ == glm::vec2(0.0f) || loadRadius <= 0) {
+        return glm::length(offset);
+    }
+    // An ellipse reaching loadRadius ahead and backScale * loadRadius behind (so its center lies ahead of the
+    // camera), as wide as it must be for the edges of the view cone to reach loadRadius too. Distances are
+    // scaled so the ellipse's edge is at loadRadius, which keeps the hysteresis band in chunks.
+    float radius = static_cast<float>(loadRadius);
+    float back = std::min(std::max(loadRegion.backScale, 0.05f), 1.0f);
+    float semiAlong = 0.5f * (1.0f + back);
+    float shift = 0.5f * (1.0f - back);
+    float halfAngle = glm::radians(std::min(std::max(loadRegion.viewHalfAngleDegrees, 1.0f), 89.0f));
+    float coneAlong = (std::cos(halfAngle) - shift) / semiAlong;
+    float semiAcross = coneAlong * coneAlong < 0.99f ? std::sin(halfAngle) / std::sqrt(1.0f - coneAlong * coneAlong) : semiAlong;
+
+    float ahead = glm::dot(offset, cameraViewDirection_) / radius - shift;
+    float across = (offset.x * cameraViewDirection_.y - offset.y * cameraViewDirection_.x) / radius;
+    ahead /= semiAlong;
+    across /= semiAcross;
+    return radius * std::sqrt(ahead * ahead + across * across);
+}
 
-    for (const auto& key : chunksToUnloadKeys) {
-        unloadChunk(key);
+bool TerrainManager::loadRegionNeedsRefresh() const {
+    if (loadRegion.shape != LoadRegionShape::ViewEllipse && loadRegion.shape != LoadRegionShape::Budget) {
+        return false;
+    }
+    if (loadRegion.shape != windowShape_) {
+        return true;
     }
+    float cosLimit = std::cos(glm::radians(loadRegion.refreshAngleDegrees));
+    return glm::dot(cameraViewDirection_, regionViewDirection_) < cosLimit;
+}
 
-    // Step 2: Load chunks that are in the desired set but not yet active
-    for (const auto& desiredCoord : desiredActiveChunks) {
-        if (activeChunks_.find(desiredCoord) == activeChunks_.end()) {
-            loadChunk(desiredCoord);
+void TerrainManager::updateLoadRegion(Vec2i center) {
+    regionViewDirection_ = cameraViewDirection_;
+    float hysteresis = static_cast<float>(getUnloadRadius() - loadRadius);
+    size_t inRegion = 0;
+
+    if (loadRegion.shape == LoadRegionShape::Budget) {
+        // Rank every window position by priority; the budgetChunks best are requested, and loaded chunks are kept
+        // until their score passes the last requested one's by the hysteresis band (in world units)
+        size_t budget = loadRegion.budgetChunks;
+        if (budget == 0) {
+            budget = static_cast<size_t>(std::ceil(3.14159265f * (loadRadius + 0.5f) * (loadRadius + 0.5f)));
         }
+        regionScores_.clear();
+        chunkWindow_.forEach([this](const Vec2i& coords, ChunkSlot&) {
+            regionScores_.push_back(computeChunkPriority(coords));
+        });
+        budget = std::min(std::max<size_t>(budget, 1), regionScores_.size());
+        regionRanked_.assign(regionScores_.begin(), regionScores_.end()); // Keeps its capacity: no allocation once warm
+        std::nth_element(regionRanked_.begin(), regionRanked_.begin() + (budget - 1), regionRanked_.end());
+        float requestLimit = regionRanked_[budget - 1];
+        float keepLimit = requestLimit + hysteresis * std::max(Chunk::CHUNK_WORLD_SIZE_X, Chunk::CHUNK_WORLD_SIZE_Z);
+        size_t index = 0;
+        chunkWindow_.forEach([&](const Vec2i& coords, ChunkSlot& slot) {
+            float score = regionScores_[index++];
+            if (score <= requestLimit) {
+                inRegion++;
+                if (!slot.chunk) enteringChunks_.push_back(coords);
+            } else if (slot.chunk && score > keepLimit) {
+                unloadChunk(slot);
+            }
+        });
+    } else {
+        float requestLimit = static_cast<float>(loadRadius);
+        float keepLimit = requestLimit + hysteresis;
+        chunkWindow_.forEach([&](const Vec2i& coords, ChunkSlot& slot) {
+            float distance = regionDistance(coords, center);
+            if (distance <= requestLimit) {
+                inRegion++;
+                if (!slot.chunk) enteringChunks_.push_back(coords);
+            } else if (slot.chunk && distance > keepLimit) {
+                unloadChunk(slot);
+            }
+        });
     }
+    loadRegionChunks_ = inRegion;
 }
 
 void TerrainManager::loadChunk(Vec2i chunkCoords) {
-    if (activeChunks_.count(chunkCoords)) {
-        return; 
+    ChunkSlot* slot = chunkWindow_.find(chunkCoords);
+    if (!slot || slot->chunk) {
+        return; // Outside the load window, or already requested
     }
 
     std::cout << "TerrainManager: Requesting load for chunk (" << chunkCoords.x << ", " << chunkCoords.z << ")" << std::endl;
+    slot->requestedAt = std::chrono::steady_clock::now();
+    slot->waitingForUpload = false;
+    slot->missingInView = false;
+
+    if (adoptPrefetchedChunk(chunkCoords, *slot)) {
+        return; // Prefetched (or being prefetched): no second build
+    }
+
+    // A chunk evicted not long ago comes back from the cache: still uploaded, or at least without regenerating heights
+    EvictedChunk evicted;
+    if (evictedChunks_.take(chunkCoords, evicted)) {
+        loadStats_.evictedCacheHits++;
+        if (evicted.chunk) {
+            slot->chunk = std::move(evicted.chunk);
+            slot->resident = true;
+            markCullTreeChanged(chunkCoords);
+            return;
+        }
+    } else if (evictedChunkSettings.maxBytes > 0) {
+        loadStats_.evictedCacheMisses++;
+    }
+
+    std::unique_ptr<Chunk> newChunk = acquireChunk(chunkCoords);
+    if (!evicted.heights.empty()) {
+        newChunk->setHeights(std::move(evicted.heights)); // Built from these, skipping the disk cache and the noise
+    }
+    newChunk->setKeepHeights(keepsHeightsForEviction());
+
+    if (!chunkCacheTried_) {
+        chunkCacheTried_ = true;
+        if (!chunkCacheDirectory.empty()) {
+            chunkCache_.open(chunkCacheDirectory, perlinGenerator_);
+        }
+    }
+    startWorkers();
+
+    Chunk* chunk = newChunk.get();
+    chunk->setState(ChunkState::Queued);
+    slot->chunk = std::move(newChunk);
+    slot->resident = false;
+    {
+        std::lock_guard<std::mutex> lock(buildQueueMutex_);
+        buildQueue_.push_back({ chunk, computeChunkPriority(chunkCoords) });
+    }
+    if (workers_) {
+        workers_->submit([this]() { buildNextChunk(); });
+    } else {
+        buildNextChunk(); // Uploaded by the processCompletedBuilds() at the end of this update
+    }
+}
+
+void TerrainManager::startWorkers() {
+    if (workersStarted_) {
+        return;
+    }
+    workersStarted_ = true;
+    int threads = workerThreads < 0 ? ThreadPool::defaultThreadCount() : workerThreads;
+    if (threads > 0) {
+        workers_ = std::make_unique<ThreadPool>(threads);
+    }
+}
+
+void TerrainManager::buildNextChunk() {
+    Chunk* chunk = nullptr;
+    bool prefetching = false;
+    {
+        std::lock_guard<std::mutex> lock(buildQueueMutex_);
+        if (!buildQueue_.empty()) {
+            auto best = std::min_element(buildQueue_.begin(), buildQueue_.end(),
+                                         [](const QueuedBuild& a, const QueuedBuild& b) { return a.priority < b.priority; });
+            chunk = best->chunk;
+            *best = buildQueue_.back();
+            buildQueue_.pop_back();
+        } else if (!prefetchQueue_.empty()) {
+            chunk = prefetchQueue_.front(); // Nothing requested is waiting: work ahead of the camera
+            prefetchQueue_.erase(prefetchQueue_.begin());
+            prefetching = true;
+        }
+        if (chunk) {
+            chunk->setState(ChunkState::Generating); // Under the lock, so unloadChunk knows a worker has it
+        }
+    }
+    if (!chunk) {
+        // Nothing requested or prefetched is waiting: the lowest class of work, a far-field tile. Finding none
+        // either means the chunk this job was submitted for was unloaded (or its prefetch dropped) before any
+        // worker got to it, or another job already built this job's tile.
+        if (farField_) {
+            farField_->buildNext();
+        }
+        return;
+    }
+    buildChunk(chunk, prefetching);
+}
+
+void TerrainManager::buildChunk(Chunk* chunk, bool prefetch) {
+    ChunkBuildResult result;
+    result.chunk = chunk;
+    result.prefetch = prefetch;
+    if (!chunk->isCancelled() && chunk->hasHeights()) {
+        // Revived from the evicted chunk cache: only the mesh is rebuilt
+        chunk->prepare(chunk->getHeights());
+        result.built = true;
+        result.heightsKept = true;
+        chunk->setState(ChunkState::ReadyToUpload);
+    } else if (!chunk->isCancelled()) {
+        // Heights come from the disk cache when possible; generated ones are written back for next time
+        ScratchArena::Scope scratch(ScratchArena::forThread());
+        ScratchVector<float> heights(Chunk::getBorderedHeightCount(), 0.0f, ArenaAllocator<float>(&scratch.arena()));
+        auto heightsStart = std::chrono::high_resolution_clock::now();
+        result.cacheHit = chunkCache_.read(chunk->gridCoords, heights.data(), heights.size());
+        auto heightsEnd = std::chrono::high_resolution_clock::now();
+        bool haveHeights = result.cacheHit;
+        if (result.cacheHit) {
+            result.cacheReadMs = std::chrono::duration<double, std::milli>(heightsEnd - heightsStart).count();
+        } else if (chunk->generateHeights(heights.data())) {
+            haveHeights = true;
+            auto generatedEnd = std::chrono::high_resolution_clock::now();
+            result.generateMs = std::chrono::duration<double, std::milli>(generatedEnd - heightsEnd).count();
+            if (chunkCache_.isOpen()) {
+                result.cacheWritten = chunkCache_.write(chunk->gridCoords, heights.data(), heights.size());
+                result.cacheWriteMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - generatedEnd).count();
+            }
+        }
+
+        if (haveHeights) {
+            chunk->prepare(heights.data()); // CPU mesh and index layout; the GL part waits for the main thread
+            result.built = true;
+        }
+        chunk->setState(ChunkState::ReadyToUpload);
+    }
+
+    std::lock_guard<std::mutex> lock(completedMutex_);
+    completedBuilds_.push_back(result);
+}
+
+void TerrainManager::processCompletedBuilds() {
+    {
+        std::lock_guard<std::mutex> lock(completedMutex_);
+        drainedBuilds_.swap(completedBuilds_);
+    }
+    for (const ChunkBuildResult& result : drainedBuilds_) {
+        if (result.prefetch && completePrefetch(result)) {
+            continue; // Not requested yet
+        }
+        Vec2i chunkCoords = result.chunk->gridCoords;
+        ChunkSlot* slot = chunkWindow_.find(chunkCoords);
+        if (!slot || slot->chunk.get() != result.chunk) {
+            // Unloaded while in flight: it is in cancelledChunks_, and nothing references it any more
+            for (size_t i = 0; i < cancelledChunks_.size(); ++i) {
+                if (cancelledChunks_[i].get() == result.chunk) {
+                    std::swap(cancelledChunks_[i], cancelledChunks_.back());
+                    keepEvictedHeights(cancelledChunks_.back());
+                    recycleChunk(std::move(cancelledChunks_.back()));
+                    cancelledChunks_.pop_back();
+                    break;
+                }
+            }
+            loadStats_.chunksCancelled++;
+            continue;
+        }
+        if (!result.built) {
+            recycleChunk(std::move(slot->chunk));
+            retryChunks_.push_back(chunkCoords);
+            continue; // Height generation failed (already logged); the chunk is requested again on the next move
+        }
+
+        if (result.heightsKept) {
+            // Neither read nor generated
+        } else if (result.cacheHit) {
+            loadStats_.cacheHits++;
+            loadStats_.cacheReadMs += result.cacheReadMs;
+        } else {
+            loadStats_.heightsGenerated++;
+            loadStats_.generateMs += result.generateMs;
+            loadStats_.cacheWriteMs += result.cacheWriteMs;
+        }
+        slot->waitingForUpload = true;
+        uploadQueue_.push_back(chunkCoords);
+    }
+    drainedBuilds_.clear();
+
+    if (uploadQueue_.empty()) {
+        return;
+    }
+
+    // Most wanted first; the queue is short (at most the ready chunks), so a full sort per frame is cheap.
+    // Chunks unloaded while waiting have already been taken out by unloadChunk.
+    std::sort(uploadQueue_.begin(), uploadQueue_.end(), [this](const Vec2i& a, const Vec2i& b) {
+        return computeChunkPriority(a) < computeChunkPriority(b);
+    });
+
+    auto frameStart = std::chrono::steady_clock::now();
+    size_t frameBytes = 0;
+    size_t uploaded = 0;
+    for (; uploaded < uploadQueue_.size(); ++uploaded) {
+        ChunkSlot& slot = chunkWindow_.at(uploadQueue_[uploaded]);
+        Chunk& chunk = *slot.chunk;
+        size_t bytes = chunk.getUploadBytes();
+        double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        if (uploaded > 0 && (frameBytes + bytes > uploadBudget.maxBytesPerFrame || frameMs >= uploadBudget.maxMsPerFrame)) {
+            break; // The rest waits for the next frame
+        }
+
+        auto uploadStart = std::chrono::steady_clock::now();
+        chunk.uploadToGpu();
+        if (chunk.usesDisplacement()) {
+            setupDisplacementResources();
+            chunk.uploadDisplacement(chunkHeightTextures_); // ~2.4 KB instead of a full vertex buffer
+        }
+        auto uploadEnd = std::chrono::steady_clock::now();
+        if (!bufferSetsReserved_ && chunk.getGpuBytes() > 0) {
+            // Now that a chunk mesh shows the buffer sizes: enough sets for the chunks entering on a diagonal step
+            bufferSetsReserved_ = true;
+            int side = 2 * loadRadius + 1;
+            int reserved = pooling.reservedBufferSets < 0 ? 2 * side : pooling.reservedBufferSets;
+            if (pooling.enabled && reserved > 0) {
+                MeshBufferPool::instance().reserve(static_cast<size_t>(reserved));
+            }
+        }
+        double uploadMs = std::chrono::duration<double, std::milli>(uploadEnd - uploadStart).count();
+        double timeToVisibleMs = std::chrono::duration<double, std::milli>(uploadEnd - slot.requestedAt).count();
+        frameBytes += bytes;
+        loadStats_.uploadMs += uploadMs;
+        loadStats_.maxUploadMs = std::max(loadStats_.maxUploadMs, uploadMs);
+        loadStats_.timeToVisibleMs += timeToVisibleMs;
+        loadStats_.maxTimeToVisibleMs = std::max(loadStats_.maxTimeToVisibleMs, timeToVisibleMs);
+
+        loadStats_.chunksLoaded++;
+        const IndexBuildStats& indexStats = chunk.getIndexBuildStats();
+        if (indexStats.indexBytesBefore > 0) {
+            loadStats_.indexedChunks++;
+            loadStats_.indexBytesBefore += indexStats.indexBytesBefore;
+            loadStats_.indexBytesAfter += indexStats.indexBytesAfter;
+            loadStats_.acmrBefore += indexStats.acmrBefore;
+            loadStats_.acmrAfter += indexStats.acmrAfter;
+        }
+        loadStats_.heapAllocations += chunk.getLoadAllocations();
+        loadStats_.maxHeapAllocations = std::max(loadStats_.maxHeapAllocations, chunk.getLoadAllocations());
+        if (slot.missingInView) {
+            loadStats_.popIns++;
+            slot.missingInView = false;
+        }
+        slot.resident = true;
+        slot.waitingForUpload = false;
+        markCullTreeChanged(uploadQueue_[uploaded]);
+    }
+
+    loadStats_.uploadedBytes += frameBytes;
+    loadStats_.maxFrameUploadBytes = std::max(loadStats_.maxFrameUploadBytes, frameBytes);
+    loadStats_.maxFrameUploadMs = std::max(loadStats_.maxFrameUploadMs,
+                                           std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    if (uploaded < uploadQueue_.size()) {
+        loadStats_.framesBudgetLimited++;
+    }
+    uploadQueue_.erase(uploadQueue_.begin(), uploadQueue_.begin() + uploaded);
+}
+
+void TerrainManager::updateCameraMotion(const Camera& camera) {
+    auto now = std::chrono::steady_clock::now();
+    if (cameraMotionValid_) {
+        float seconds = std::chrono::duration<float>(now - lastUpdateTime_).count();
+        if (seconds > 0.0f) {
+            glm::vec3 velocity((camera.Position - lastCameraPosition_) / static_cast<double>(seconds));
+            cameraVelocity_ = glm::mix(cameraVelocity_, velocity, 0.25f); // Smooths out frame time jitter
+        }
+    }
+    glm::vec2 velocityXZ(cameraVelocity_.x, cameraVelocity_.z);
+    float speed = glm::length(velocityXZ);
+    glm::vec2 travel = speed > 1e-3f ? velocityXZ / speed : glm::vec2(0.0f);
+    float elapsed = cameraMotionValid_ ? std::chrono::duration<float>(now - lastUpdateTime_).count() : 0.0f;
+    if (elapsed > 0.0f && travel != glm::vec2(0.0f) && travelDirection_ != glm::vec2(0.0f)) {
+        // Signed angle from the last direction of travel to this one
+        float turned = std::atan2(travelDirection_.x * travel.y - travelDirection_.y * travel.x, glm::dot(travelDirection_, travel));
+        turnRate_ = glm::mix(turnRate_, turned / elapsed, 0.25f);
+    } else if (travel == glm::vec2(0.0f)) {
+        turnRate_ = 0.0f;
+    }
+    travelDirection_ = travel;
+    cameraMotionValid_ = true;
+    lastUpdateTime_ = now;
+    lastCameraPosition_ = camera.Position;
+
+    // Head where the camera is going; when (nearly) still, where it is looking
+    glm::vec2 heading(cameraVelocity_.x, cameraVelocity_.z);
+    if (glm::length(heading) < 1.0f) {
+        heading = glm::vec2(camera.Front.x, camera.Front.z);
+    }
+    float headingLength = glm::length(heading);
+    cameraHeading_ = headingLength > 1e-4f ? heading / headingLength : glm::vec2(0.0f);
+
+    glm::vec2 view(camera.Front.x, camera.Front.z);
+    float viewLength = glm::length(view);
+    cameraViewDirection_ = viewLength > 1e-4f ? view / viewLength : glm::vec2(0.0f);
+}
+
+void TerrainManager::reprioritizeBuildQueue() {
+    std::lock_guard<std::mutex> lock(buildQueueMutex_);
+    for (QueuedBuild& queued : buildQueue_) {
+        queued.priority = computeChunkPriority(queued.chunk->gridCoords);
+    }
+}
+
+float TerrainManager::computeChunkPriority(Vec2i chunkCoords) const {
+    glm::vec2 chunkCenter((static_cast<float>(chunkCoords.x) + 0.5f) * Chunk::CHUNK_WORLD_SIZE_X,
+                          (static_cast<float>(chunkCoords.z) + 0.5f) * Chunk::CHUNK_WORLD_SIZE_Z);
+    glm::vec2 eye(lastCameraPosition_.x, lastCameraPosition_.z);
+    if (!chunkPriority.enabled) {
+        return glm::length(chunkCenter - eye);
+    }
+
+    // Measure from where the camera is about to be, but never predict past the loaded area
+    glm::vec2 lookAhead = glm::vec2(cameraVelocity_.x, cameraVelocity_.z) * chunkPriority.lookAheadSeconds;
+    float maxLookAhead = static_cast<float>(loadRadius) * std::min(Chunk::CHUNK_WORLD_SIZE_X, Chunk::CHUNK_WORLD_SIZE_Z);
+    float lookAheadLength = glm::length(lookAhead);
+    if (lookAheadLength > maxLookAhead) {
+        lookAhead = lookAhead * (maxLookAhead / lookAheadLength);
+    }
+    glm::vec2 toChunk = chunkCenter - (eye + lookAhead);
+    float distance = glm::length(toChunk);
+    float score = distance;
+
+    // 1 straight ahead, 1 + headingWeight straight behind
+    if (distance > 1e-3f) {
+        float alignment = glm::dot(toChunk / distance, cameraHeading_);
+        score *= 1.0f + chunkPriority.headingWeight * 0.5f * (1.0f - alignment);
+    }
+
+    // Heights are unknown before generation, so test the chunk's column over the whole terrain height range
+    if (lastFrustumValid_ && cullingSettings.frustum) {
+        if (!lastFrustum_.isAABBVisible(chunkColumnBounds(chunkCoords))) {
+            score *= chunkPriority.outsideFrustumScale;
+        }
+    }
+    return score;
+}
+
+BoundingBox TerrainManager::chunkColumnBounds(Vec2i chunkCoords) {
+    BoundingBox column;
+    column.min = glm::vec3(static_cast<float>(chunkCoords.x) * Chunk::CHUNK_WORLD_SIZE_X, Chunk::TERRAIN_MIN_HEIGHT * Chunk::MESH_VERTICAL_SCALE,
+                           static_cast<float>(chunkCoords.z) * Chunk::CHUNK_WORLD_SIZE_Z);
+    column.max = glm::vec3(static_cast<float>(chunkCoords.x + 1) * Chunk::CHUNK_WORLD_SIZE_X, Chunk::TERRAIN_MAX_HEIGHT * Chunk::MESH_VERTICAL_SCALE,
+                           static_cast<float>(chunkCoords.z + 1) * Chunk::CHUNK_WORLD_SIZE_Z);
+    return column;
+}
+
+bool TerrainManager::isInLoadRegion(Vec2i chunkCoords, Vec2i center) const {
+    if (loadRegion.shape == LoadRegionShape::Square) {
+        return std::abs(chunkCoords.x - center.x) <= loadRadius && std::abs(chunkCoords.z - center.z) <= loadRadius;
+    }
+    // The budget region depends on scores at a camera position that has not happened yet; its circle stands in
+    return regionDistance(chunkCoords, center) <= static_cast<float>(loadRadius);
+}
+
+void TerrainManager::planPrefetch(Vec2i cameraChunkCoords) {
+    lastPrefetchPlan_ = std::chrono::steady_clock::now();
+
+    glm::vec2 velocity(cameraVelocity_.x, cameraVelocity_.z);
+    float speed = glm::length(velocity);
+    if (!workers_ || speed < prefetch.minSpeed || prefetch.maxQueued == 0) {
+        cancelQueuedPrefetches(); // No path to work ahead on
+        return; // Without workers a prefetch would be built on the main thread, which is what it should avoid
+    }
+
+    // Walk the predicted path in half-chunk steps (turning at the current rate, if enabled). Each time it enters
+    // a new chunk, the positions the load region would take in there are wanted next, nearest the predicted
+    // position first, in the order the camera reaches them; at most maxReady of them.
+    prefetchCandidates_.clear();
+    float step = 0.5f * std::min(Chunk::CHUNK_WORLD_SIZE_X, Chunk::CHUNK_WORLD_SIZE_Z);
+    float stepSeconds = step / speed;
+    glm::vec2 position(lastCameraPosition_.x, lastCameraPosition_.z);
+    glm::vec2 direction = velocity / speed;
+    Vec2i lastCenter = cameraChunkCoords;
+    for (float t = stepSeconds; t <= prefetch.horizonSeconds && prefetchCandidates_.size() < prefetch.maxReady; t += stepSeconds) {
+        if (prefetch.followTurns && turnRate_ != 0.0f) {
+            float angle = turnRate_ * stepSeconds;
+            float c = std::cos(angle), s = std::sin(angle);
+            direction = glm::vec2(c * direction.x - s * direction.y, s * direction.x + c * direction.y);
+        }
+        position += direction * step;
+        Vec2i center(static_cast<int>(std::floor(position.x / Chunk::CHUNK_WORLD_SIZE_X)),
+                     static_cast<int>(std::floor(position.y / Chunk::CHUNK_WORLD_SIZE_Z)));
+        if (center == lastCenter) {
+            continue;
+        }
+        lastCenter = center;
+
+        size_t firstNew = prefetchCandidates_.size();
+        for (int dz = -loadRadius; dz <= loadRadius; ++dz) {
+            for (int dx = -loadRadius; dx <= loadRadius; ++dx) {
+                Vec2i coords(center.x + dx, center.z + dz);
+                if (!isInLoadRegion(coords, center) || isInLoadRegion(coords, cameraChunkCoords)) {
+                    continue; // Not needed there, or already requested for the current position
+                }
+                const ChunkSlot* slot = chunkWindow_.find(coords);
+                if ((slot && slot->chunk) || evictedChunks_.contains(coords)) {
+                    continue; // Loaded, or cheap to bring back
+                }
+                if (std::find(prefetchCandidates_.begin(), prefetchCandidates_.end(), coords) == prefetchCandidates_.end()) {
+                    prefetchCandidates_.push_back(coords);
+                }
+            }
+        }
+        std::sort(prefetchCandidates_.begin() + firstNew, prefetchCandidates_.end(), [&position](const Vec2i& a, const Vec2i& b) {
+            glm::vec2 ca((a.x + 0.5f) * Chunk::CHUNK_WORLD_SIZE_X, (a.z + 0.5f) * Chunk::CHUNK_WORLD_SIZE_Z);
+            glm::vec2 cb((b.x + 0.5f) * Chunk::CHUNK_WORLD_SIZE_X, (b.z + 0.5f) * Chunk::CHUNK_WORLD_SIZE_Z);
+            return glm::length(ca - position) < glm::length(cb - position);
+        });
+    }
+    if (prefetchCandidates_.size() > prefetch.maxReady) {
+        prefetchCandidates_.resize(prefetch.maxReady);
+    }
+    auto wanted = [this](Vec2i coords) {
+        return std::find(prefetchCandidates_.begin(), prefetchCandidates_.end(), coords) != prefetchCandidates_.end();
+    };
+
+    // Built prefetches the path no longer leads to are dropped
+    for (size_t i = 0; i < prefetchedChunks_.size();) {
+        if (wanted(prefetchedChunks_[i]->gridCoords)) {
+            ++i;
+            continue;
+        }
+        loadStats_.prefetchesWasted++;
+        recycleChunk(std::move(prefetchedChunks_[i]));
+        prefetchedChunks_.erase(prefetchedChunks_.begin() + i);
+    }
+
+    // Queued prefetches the path still leads to keep their place (and their worker job), so a replan every
+    // replanSeconds does not queue and count the same chunk again; the others are dropped before a worker
+    // gets to them
+    std::vector<Chunk*> dropped;
+    size_t waiting = 0;
+    {
+        std::lock_guard<std::mutex> lock(buildQueueMutex_);
+        for (Chunk* queuedChunk : prefetchQueue_) {
+            if (wanted(queuedChunk->gridCoords)) {
+                prefetchQueue_[waiting++] = queuedChunk;
+            } else {
+                dropped.push_back(queuedChunk); // Its job finds nothing to do, or builds a request instead
+            }
+        }
+        prefetchQueue_.resize(waiting);
+    }
+    for (Chunk* queuedChunk : dropped) {
+        for (size_t i = 0; i < prefetchChunks_.size(); ++i) {
+            if (prefetchChunks_[i].get() == queuedChunk) {
+                std::swap(prefetchChunks_[i], prefetchChunks_.back());
+                recycleChunk(std::move(prefetchChunks_.back()));
+                prefetchChunks_.pop_back();
+                break;
+            }
+        }
+    }
+
+    // The rest of the wanted positions are queued, up to maxQueued waiting and without exceeding maxReady in total
+    size_t queued = 0;
+    for (const Vec2i& coords : prefetchCandidates_) {
+        if (waiting + queued >= prefetch.maxQueued || prefetchChunks_.size() + prefetchedChunks_.size() >= prefetch.maxReady) {
+            break;
+        }
+        bool known = false;
+        for (size_t i = 0; !known && i < prefetchChunks_.size(); ++i) {
+            known = prefetchChunks_[i]->gridCoords == coords; // Being generated for an earlier plan
+        }
+        for (size_t i = 0; !known && i < prefetchedChunks_.size(); ++i) {
+            known = prefetchedChunks_[i]->gridCoords == coords;
+        }
+        if (known) {
+            continue;
+        }
+        std::unique_ptr<Chunk> chunk = acquireChunk(coords);
+        chunk->setKeepHeights(keepsHeightsForEviction());
+        chunk->setState(ChunkState::Queued);
+        {
+            std::lock_guard<std::mutex> lock(buildQueueMutex_);
+            prefetchQueue_.push_back(chunk.get());
+        }
+        prefetchChunks_.push_back(std::move(chunk));
+        workers_->submit([this]() { buildNextChunk(); });
+        loadStats_.prefetchesQueued++;
+        queued++;
+    }
+
+    // Kept and new prefetches are taken in the order the camera is now expected to need them
+    std::lock_guard<std::mutex> lock(buildQueueMutex_);
+    auto pathIndex = [this](const Chunk* chunk) {
+        return std::find(prefetchCandidates_.begin(), prefetchCandidates_.end(), chunk->gridCoords) - prefetchCandidates_.begin();
+    };
+    std::stable_sort(prefetchQueue_.begin(), prefetchQueue_.end(), [&pathIndex](const Chunk* a, const Chunk* b) {
+        return pathIndex(a) < pathIndex(b);
+    });
+}
+
+void TerrainManager::cancelQueuedPrefetches() {
+    std::vector<Chunk*> dropped;
+    {
+        std::lock_guard<std::mutex> lock(buildQueueMutex_);
+        if (prefetchQueue_.empty()) {
+            return;
+        }
+        dropped.swap(prefetchQueue_); // Their jobs find nothing to do, or build a request instead
+    }
+    for (Chunk* queued : dropped) {
+        for (size_t i = 0; i < prefetchChunks_.size(); ++i) {
+            if (prefetchChunks_[i].get() == queued) {
+                std::swap(prefetchChunks_[i], prefetchChunks_.back());
+                recycleChunk(std::move(prefetchChunks_.back()));
+                prefetchChunks_.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+bool TerrainManager::completePrefetch(const ChunkBuildResult& result) {
+    std::unique_ptr<Chunk> chunk;
+    for (size_t i = 0; i < prefetchChunks_.size(); ++i) {
+        if (prefetchChunks_[i].get() == result.chunk) {
+            std::swap(prefetchChunks_[i], prefetchChunks_.back());
+            chunk = std::move(prefetchChunks_.back());
+            prefetchChunks_.pop_back();
+            break;
+        }
+    }
+    if (!chunk) {
+        return false; // A request adopted it while it was being built: handled like any requested chunk
+    }
+    if (!result.built) {
+        recycleChunk(std::move(chunk)); // Height generation failed; a request will try again
+        return true;
+    }
+    if (result.cacheHit) {
+        loadStats_.cacheHits++;
+        loadStats_.cacheReadMs += result.cacheReadMs;
+    } else {
+        loadStats_.heightsGenerated++;
+        loadStats_.generateMs += result.generateMs;
+        loadStats_.cacheWriteMs += result.cacheWriteMs;
+    }
+    prefetchedChunks_.push_back(std::move(chunk));
+    if (prefetchedChunks_.size() > prefetch.maxReady) {
+        loadStats_.prefetchesWasted++; // maxReady was lowered meanwhile
+        recycleChunk(std::move(prefetchedChunks_.front()));
+        prefetchedChunks_.erase(prefetchedChunks_.begin());
+    }
+    return true;
+}
+
+bool TerrainManager::adoptPrefetchedChunk(Vec2i chunkCoords, ChunkSlot& slot) {
+    // Built: straight to the upload queue, uploaded by this update's processCompletedBuilds()
+    for (size_t i = 0; i < prefetchedChunks_.size(); ++i) {
+        if (prefetchedChunks_[i]->gridCoords == chunkCoords) {
+            slot.chunk = std::move(prefetchedChunks_[i]);
+            prefetchedChunks_.erase(prefetchedChunks_.begin() + i);
+            slot.resident = false;
+            slot.waitingForUpload = true;
+            uploadQueue_.push_back(chunkCoords);
+            loadStats_.prefetchesUsed++;
+            return true;
+        }
+    }
+
+    // Queued or being generated: the slot takes the chunk over. A queued one moves to buildQueue_ at the
+    // request's priority (its prefetch job builds it); a generating one is finished as a request.
+    for (size_t i = 0; i < prefetchChunks_.size(); ++i) {
+        if (!(prefetchChunks_[i]->gridCoords == chunkCoords)) {
+            continue;
+        }
+        Chunk* chunk = prefetchChunks_[i].get();
+        {
+            std::lock_guard<std::mutex> lock(buildQueueMutex_);
+            auto queued = std::find(prefetchQueue_.begin(), prefetchQueue_.end(), chunk);
+            if (queued != prefetchQueue_.end()) {
+                prefetchQueue_.erase(queued);
+                buildQueue_.push_back({ chunk, computeChunkPriority(chunkCoords) });
+            }
+        }
+        slot.chunk = std::move(prefetchChunks_[i]);
+        prefetchChunks_.erase(prefetchChunks_.begin() + i);
+        slot.resident = false;
+        loadStats_.prefetchesUsed++;
+        return true;
+    }
+    return false;
+}
+
+TerrainStreamingStats TerrainManager::getStreamingStats() const {
+    TerrainStreamingStats stats;
+    chunkWindow_.forEach([&stats](const Vec2i&, const ChunkSlot& slot) {
+        if (!slot.chunk) return;
+        if (slot.resident) {
+            stats.resident++;
+            return;
+        }
+        switch (slot.chunk->getState()) {
+        case ChunkState::Queued: stats.queued++; break;
+        case ChunkState::Generating: stats.generating++; break;
+        case ChunkState::ReadyToUpload: stats.readyToUpload++; break;
+        case ChunkState::Resident: break;
+        }
+    });
+    stats.cancelledInFlight = cancelledChunks_.size();
+    stats.evicted = evictedChunks_.size();
+    stats.evictedBytes = evictedChunks_.getBytes();
+    stats.regionChunks = loadRegionChunks_;
+    stats.workerThreads = workers_ ? workers_->getThreadCount() : 0;
+    if (farField_) {
+        stats.farTilesResident = farField_->getStats().tilesResident;
+        stats.farTilesPending = farField_->getStats().tilesPending;
+    }
+    return stats;
+}
+
+void TerrainManager::unloadChunk(ChunkSlot& slot) {
+    if (!slot.chunk) {
+        return;
+    }
+    Vec2i chunkCoords = slot.chunk->gridCoords;
+    if (!slot.resident) {
+        if (slot.waitingForUpload) {
+            // Its build result was consumed, so nothing but uploadQueue_ refers to it: free it now
+            uploadQueue_.erase(std::find(uploadQueue_.begin(), uploadQueue_.end(), chunkCoords));
+            keepEvictedHeights(slot.chunk);
+            recycleChunk(std::move(slot.chunk));
+            slot = ChunkSlot();
+            loadStats_.chunksCancelled++;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(buildQueueMutex_);
+            for (size_t i = 0; i < buildQueue_.size(); ++i) {
+                if (buildQueue_[i].chunk == slot.chunk.get()) {
+                    // No worker has started it, and none will: free it now
+                    buildQueue_[i] = buildQueue_.back();
+                    buildQueue_.pop_back();
+                    keepEvictedHeights(slot.chunk);
+                    recycleChunk(std::move(slot.chunk));
+                    slot = ChunkSlot();
+                    loadStats_.chunksCancelled++;
+                    loadStats_.cancelledBeforeBuild++;
+                    return;
+                }
+            }
+        }
+        // A worker is building it: it finishes, then processCompletedBuilds() frees it
+        slot.chunk->cancel();
+        cancelledChunks_.push_back(std::move(slot.chunk));
+        slot = ChunkSlot();
+        return;
+    }
+
+    std::cout << "TerrainManager: Requesting unload for chunk (" << chunkCoords.x << ", " << chunkCoords.z << ")" << std::endl;
+    markCullTreeChanged(chunkCoords);
+    if (evictedChunkSettings.maxBytes > 0) {
+        evictChunk(std::move(slot.chunk));
+        slot = ChunkSlot();
+        return;
+    }
+    recycleChunk(std::move(slot.chunk)); // Frees its buffers, then keeps or deletes the Chunk object
+    slot = ChunkSlot();
+}
+
+void TerrainManager::keepEvictedHeights(std::unique_ptr<Chunk>& chunk) {
+    // A chunk revived from kept heights and unloaded again before its rebuild finished: keep the heights
+    if (keepsHeightsForEviction() && chunk->hasHeights()) {
+        evictChunk(std::move(chunk));
+    }
+}
+
+bool TerrainManager::keepsHeightsForEviction() const {
+    return evictedChunkSettings.maxBytes > 0 &&
+           (!evictedChunkSettings.keepGpuBuffers || Chunk::MESH_BUILDER == ChunkMeshBuilder::Displaced);
+}
+
+void TerrainManager::evictChunk(std::unique_ptr<Chunk> chunk) {
+    Vec2i chunkCoords = chunk->gridCoords;
+    EvictedChunk entry;
+    // Every entry costs its node and the EvictedChunk itself, whatever it keeps
+    size_t bytes = sizeof(EvictedChunk);
+    if (evictedChunkSettings.keepGpuBuffers && chunk->isLoaded() && !chunk->usesDisplacement()) {
+        // Kept whole: its buffers stay on the GPU, and the Chunk object with its vectors stays in RAM
+        bytes += chunk->getObjectBytes() + chunk->getCpuBytes() + chunk->getGpuBytes();
+        entry.chunk = std::move(chunk);
+    } else {
+        // Chunks that never got uploaded (handed over by keepEvictedHeights) have nothing else worth keeping.
+        // Displaced chunks always keep only their heights: a whole one is ~2.4 KB, so the budget would keep
+        // tens of thousands of them, each holding a layer of chunkHeightTextures_ (which has a hard GPU limit).
+        // Their layer goes back to the array here; rebuilding the texels from the heights is cheap.
+        entry.heights = chunk->takeHeights(); // Empty if it was loaded before the cache was enabled
+        bytes += entry.heights.capacity() * sizeof(float);
+        recycleChunk(std::move(chunk));
+    }
+
+    evictedChunks_.setMaxBytes(evictedChunkSettings.maxBytes);
+    evictedChunks_.insert(chunkCoords, std::move(entry), bytes, droppedChunks_);
+    for (EvictedChunk& dropped : droppedChunks_) {
+        recycleChunk(std::move(dropped.chunk)); // Its GPU buffers go back to the MeshBufferPool
+    }
+    droppedChunks_.clear();
+}
+
+std::unique_ptr<Chunk> TerrainManager::acquireChunk(Vec2i chunkCoords) {
+    if (pooling.enabled && !spareChunks_.empty()) {
+        std::unique_ptr<Chunk> chunk = std::move(spareChunks_.back());
+        spareChunks_.pop_back();
+        chunk->reset(chunkCoords);
+        loadStats_.chunksRecycled++;
+        return chunk;
+    }
+    loadStats_.chunksCreated++;
     // Pass the address of the TerrainManager's perlinGenerator_ to the Chunk constructor
-    auto newChunk = std::make_unique<Chunk>(chunkCoords, &perlinGenerator_); 
-    
-    // The actual mesh generation now happens inside newChunk->load()
-    newChunk->load(); // Call the actual load method which generates the mesh
-    
-    activeChunks_[chunkCoords] = std::move(newChunk);
+    return std::make_unique<Chunk>(chunkCoords, &perlinGenerator_);
 }
 
-void TerrainManager::unloadChunk(Vec2i chunkCoords) {
-    auto it = activeChunks_.find(chunkCoords);
-    if (it != activeChunks_.end()) {
-        std::cout << "TerrainManager: Requesting unload for chunk (" << chunkCoords.x << ", " << chunkCoords.z << ")" << std::endl;
-        // The Chunk's unload() method will be called by its destructor when the unique_ptr is reset.
-        // If Chunk::unload() needs to be called explicitly before destruction for some reason:
-        // if (it->second) {
-        //     it->second->unload(); 
-        // }
-        activeChunks_.erase(it); // This erases the unique_ptr, deleting the Chunk
+void TerrainManager::recycleChunk(std::unique_ptr<Chunk> chunk) {
+    if (!chunk) {
+        return; // Already handed to evictedChunks_
+    }
+    chunk->releaseDisplacement(chunkHeightTextures_);
+    if (pooling.enabled && spareChunks_.size() < pooling.maxSpareChunks) {
+        chunk->unload(); // Buffers and CPU data go back to their pools now, not when the object is reused
+        spareChunks_.push_back(std::move(chunk));
     }
+    // Otherwise the unique_ptr deletes the Chunk, whose destructor unloads it
 }
 
-void TerrainManager::renderActiveChunks(Shader& terrainShader) {
+void TerrainManager::renderActiveChunks(Shader& terrainShader, const Frustum& frustum, const glm::dvec3& cameraPosition) {
     // The terrainShader should already be in use (shader.use())
     // and have global uniforms like view, projection, lighting, fog, textures set by main.cpp.
+    lastRenderStats_.chunksDrawn = 0;
+    lastRenderStats_.chunksCulled = 0;
+    lastRenderStats_.blocksCulled = 0;
+    lastRenderStats_.boundsTested = 0;
+    lastRenderStats_.trianglesDrawn = 0;
+    lastRenderStats_.chunksPerLevel.assign(1, 0);
+    lastRenderStats_.clusters = ClusterCullStats();
+    lastFrustum_ = frustum; // Chunk requests made by the next update() favour what this frame could see
+    lastFrustumValid_ = true;
+    // LOD selection and cluster culling work on absolute float bounds; only the model matrices need double
+    glm::vec3 viewPosition(cameraPosition);
+    glm::dvec3 renderOrigin = renderOriginFor(cameraPosition);
+
+    if (lodSettings.enabled && !lodIndexSetBuilt_) {
+        lodIndexSetBuilt_ = true; // Only try once; an unsupported resolution falls back to full detail
+        if (lodIndexSet_.build(Chunk::CHUNK_VERTEX_RESOLUTION_X, Chunk::CHUNK_VERTEX_RESOLUTION_Z)) {
+            lodIndexSet_.setupGPU();
+        }
+    }
+    bool useLod = lodSettings.enabled && lodIndexSet_.isValid();
+
+    // Always point the array sampler at its own unit: samplers of different types may not share a unit
+    terrainShader.setInt("chunkHeights", CHUNK_HEIGHT_TEXTURE_UNIT);
+    terrainShader.setBool("displaceFromTexture", false);
+    if (displacementReady_) {
+        // Shared by every displaced chunk; renderChunk toggles displaceFromTexture per chunk type
+        chunkHeightTextures_.bind(CHUNK_HEIGHT_TEXTURE_UNIT);
+        terrainShader.setVec2("chunkHeightRange", glm::vec2(Chunk::displacementMinHeight(), Chunk::displacementMaxHeight()));
+        terrainShader.setFloat("gridSpacing", Chunk::CHUNK_WORLD_SIZE_X / static_cast<float>(Chunk::CHUNK_VERTEX_RESOLUTION_X - 1));
+    }
+    displacingShader_ = false;
+    // Per-chunk uniforms are looked up once here instead of by name on every draw
+    ChunkUniforms chunkUniforms(terrainShader);
+    frameClusterBounds_.clear();
+    frameClusterChunks_.clear();
+    cullChunks(frustum);
+
+    if (!useLod) {
+        chunkWindow_.forEach([&](const Vec2i&, ChunkSlot& slot) {
+            if (!slot.visible) {
+                return;
+            }
+            lastRenderStats_.trianglesDrawn += renderChunk(*slot.chunk, chunkUniforms, nullptr, 0, 0, renderOrigin);
+            lastRenderStats_.chunksDrawn++;
+            lastRenderStats_.chunksPerLevel[0]++;
+        });
+        lastRenderStats_.trianglesDrawn += renderClusterBatch(chunkUniforms, frustum, renderOrigin, viewPosition);
+        renderFarField(terrainShader, frustum, renderOrigin);
+        return;
+    }
+
+    // Pick a level per chunk, then make neighbors agree before choosing stitch variants
+    chunkWindow_.forEach([&](const Vec2i&, ChunkSlot& slot) {
+        if (isSlotDrawable(slot)) {
+            Chunk* chunk = slot.chunk.get();
+            slot.lodLevel = chunk->supportsLod(lodIndexSet_) ? selectLodLevel(*chunk, viewPosition) : 0;
+        } else {
+            slot.lodLevel = -1;
+        }
+    });
+    constrainLodLevels();
+
+    lastRenderStats_.chunksPerLevel.assign(lodIndexSet_.getLevelCount(), 0);
+    const Vec2i neighborOffsets[4] = { Vec2i(-1, 0), Vec2i(1, 0), Vec2i(0, -1), Vec2i(0, 1) };
+    const int neighborEdges[4] = { EDGE_NEG_X, EDGE_POS_X, EDGE_NEG_Z, EDGE_POS_Z };
+
+    // Culled chunks still took part in the level constraints, so visible neighbors stitch against them correctly
+    chunkWindow_.forEach([&](const Vec2i& coords, ChunkSlot& slot) {
+        if (slot.lodLevel < 0 || !slot.visible) {
+            return;
+        }
+        Chunk* chunk = slot.chunk.get();
+        int level = slot.lodLevel;
+        int stitchMask = 0;
+        for (int i = 0; i < 4; ++i) {
+            const ChunkSlot* neighbor = chunkWindow_.find(Vec2i(coords.x + neighborOffsets[i].x, coords.z + neighborOffsets[i].z));
+            if (neighbor && neighbor->lodLevel > level) {
+                stitchMask |= neighborEdges[i];
+            }
+        }
+
+        lastRenderStats_.trianglesDrawn += renderChunk(*chunk, chunkUniforms, &lodIndexSet_, level, stitchMask, renderOrigin);
+        lastRenderStats_.chunksDrawn++;
+        lastRenderStats_.chunksPerLevel[level]++;
+    });
+    lastRenderStats_.trianglesDrawn += renderClusterBatch(chunkUniforms, frustum, renderOrigin, viewPosition);
+    renderFarField(terrainShader, frustum, renderOrigin);
+}
+
+void TerrainManager::updateFarField(Vec2i cameraChunkCoords) {
+    if (!farField_ || !farField.enabled) {
+        return;
+    }
+    // Tiles the chunks are about to cover are not requested. A circle only covers the square inscribed in it;
+    // the view-dependent shapes guarantee no square, so the whole ring is built (cells under drawable chunks
+    // are still skipped when drawing).
+    int coveredRadius = -1;
+    if (loadRegion.shape == LoadRegionShape::Square) {
+        coveredRadius = loadRadius;
+    } else if (loadRegion.shape == LoadRegionShape::Circle) {
+        coveredRadius = static_cast<int>(static_cast<float>(loadRadius) * 0.7071f);
+    }
+    size_t queued = farField_->update(cameraChunkCoords, coveredRadius);
+
+    startWorkers();
+    if (workers_) {
+        for (size_t i = 0; i < queued; ++i) {
+            workers_->submit([this]() { buildNextChunk(); }); // Each job still takes a chunk first if one is waiting
+        }
+    } else {
+        // On the render thread: a few tiles per frame, after this update's chunks were built
+        int builds = 0;
+        while (builds < farField_->getSettings().maxBuildsPerFrame && farField_->buildNext()) {
+            builds++;
+        }
+    }
+}
+
+void TerrainManager::renderFarField(Shader& terrainShader, const Frustum& frustum, const glm::dvec3& renderOrigin) {
+    if (!farField_ || !farField.enabled) {
+        return;
+    }
+    if (displacingShader_) {
+        terrainShader.setBool("displaceFromTexture", false); // Far tiles are ordinary meshes
+        displacingShader_ = false;
+    }
+    farField_->render(terrainShader, frustum, renderOrigin, [this](Vec2i chunkCoords) { return isChunkDrawable(chunkCoords); });
+}
+
+bool TerrainManager::isChunkDrawable(Vec2i chunkCoords) const {
+    const ChunkSlot* slot = chunkWindow_.find(chunkCoords);
+    return slot && isSlotDrawable(*slot);
+}
+
+void TerrainManager::renderCdlod(Shader& cdlodShader, const Frustum& frustum, const glm::dvec3& viewPosition) {
+    if (!cdlodTerrain_) {
+        cdlodTerrain_ = std::make_unique<CdlodTerrain>(&perlinGenerator_, cdlodSettings);
+    }
+    cdlodTerrain_->select(glm::vec3(viewPosition), frustum);
+    cdlodTerrain_->render(cdlodShader, viewPosition);
+
+    const CdlodStats& cdlodStats = cdlodTerrain_->getStats();
+    lastRenderStats_.chunksDrawn = cdlodStats.nodesSelected;
+    lastRenderStats_.trianglesDrawn = cdlodStats.trianglesDrawn;
+    lastRenderStats_.chunksPerLevel.clear();
+}
+
+void TerrainManager::renderClipmap(Shader& clipmapShader, const glm::dvec3& viewPosition) {
+    if (!clipmapTerrain_) {
+        return; // update() has not run in clipmap mode yet
+    }
+    clipmapTerrain_->render(clipmapShader, renderOriginFor(viewPosition));
+
+    lastRenderStats_.chunksDrawn = 0;
+    lastRenderStats_.trianglesDrawn = clipmapTerrain_->getStats().trianglesDrawn;
+    lastRenderStats_.chunksPerLevel.clear();
+}
+
+TerrainMemoryStats TerrainManager::computeMemoryStats() const {
+    TerrainMemoryStats stats;
+    chunkWindow_.forEach([&stats](const Vec2i&, const ChunkSlot& slot) {
+        const Chunk* chunk = slot.resident ? slot.chunk.get() : nullptr;
+        if (!chunk || !chunk->isLoaded()) return;
+        TerrainMemoryStats::PolicyTotals& totals = stats.perPolicy[static_cast<int>(chunk->getResidency())];
+        totals.chunks++;
+        totals.cpuBytes += chunk->getCpuBytes();
+        totals.gpuBytes += chunk->getGpuBytes();
+    });
+    if (displacementReady_) {
+        // The array keeps a CPU copy of every layer for regrowing, so its capacity counts on both sides
+        size_t arrayBytes = static_cast<size_t>(chunkHeightTextures_.getCapacity()) * chunkHeightTextures_.getLayerBytes();
+        stats.sharedCpuBytes += arrayBytes + displacedGrid_.getCpuBytes();
+        stats.sharedGpuBytes += arrayBytes + displacedGrid_.getGpuBytes();
+    }
+    return stats;
+}
+
+void TerrainManager::setupDisplacementResources() {
+    if (displacementReady_) {
+        return;
+    }
+    displacementReady_ = true;
 
-    for (const auto& pair : activeChunks_) {
-        Chunk* chunk = pair.second.get(); // Get raw pointer from unique_ptr
-        if (chunk && chunk->isLoaded()) { // Check if chunk exists and is loaded
-            chunk->render(terrainShader);
+    // A flat heightmap gives the grid the exact vertex layout of a chunk mesh, so the geomipmap
+    // index set and Mesh::drawWithIndexBuffer work unchanged
+    HeightMap flat(Chunk::CHUNK_VERTEX_RESOLUTION_X, Chunk::CHUNK_VERTEX_RESOLUTION_Z);
+    float horizontalScale = Chunk::CHUNK_WORLD_SIZE_X / static_cast<float>(Chunk::CHUNK_VERTEX_RESOLUTION_X - 1);
+    displacedGrid_.generateFromHeightMap(flat, horizontalScale, 1.0f);
+    displacedGrid_.setIndexBuildOptions(Chunk::MESH_INDEX_OPTIONS);
+    displacedGrid_.setupMesh();
+
+    int side = 2 * loadRadius + 1;
+    chunkHeightTextures_.configure(Chunk::CHUNK_VERTEX_RESOLUTION_X + 2, Chunk::CHUNK_VERTEX_RESOLUTION_Z + 2, side * side + 2 * side);
+}
+
+size_t TerrainManager::renderChunk(Chunk& chunk, const ChunkUniforms& uniforms, const GeoMipmapIndexSet* lodIndexSet, int level, int stitchMask,
+                                   const glm::dvec3& renderOrigin) {
+    bool displaced = chunk.usesDisplacement();
+    if (displaced != displacingShader_) {
+        uniforms.displaceFromTexture.set(displaced);
+        displacingShader_ = displaced;
+    }
+    bool lodRange = lodIndexSet && chunk.supportsLod(*lodIndexSet);
+    if (displaced) {
+        chunk.renderDisplaced(uniforms, renderOrigin, displacedGrid_, lodIndexSet, level, stitchMask);
+    } else if (cullingSettings.clusters && chunk.hasClusters() && (!lodRange || (level == 0 && stitchMask == 0))) {
+        // Level 0 without stitching is exactly the chunk's own index buffer, which is laid out by cluster
+        frameClusterChunks_.push_back({ &chunk, static_cast<uint32_t>(frameClusterBounds_.size()), static_cast<uint32_t>(chunk.getClusterCount()) });
+        chunk.appendClusterBounds(frameClusterBounds_);
+        return 0;
+    } else if (lodIndexSet) {
+        chunk.render(uniforms, renderOrigin, *lodIndexSet, level, stitchMask);
+    } else {
+        chunk.render(uniforms, renderOrigin);
+    }
+    return lodRange ? lodIndexSet->getRange(level, stitchMask).triangleCount : chunk.getTriangleCount();
+}
+
+size_t TerrainManager::renderClusterBatch(const ChunkUniforms& uniforms, const Frustum& frustum, const glm::dvec3& renderOrigin,
+                                          const glm::vec3& viewPosition) {
+    if (frameClusterChunks_.empty()) {
+        return 0;
+    }
+    ClusterCullStats& stats = lastRenderStats_.clusters;
+    size_t boxCount = frameClusterBounds_.size();
+    frameVisibleClusters_.resize(boxCount);
+    size_t visibleCount = frustum.cullBatch(frameClusterBounds_, frameVisibleClusters_.data());
+    stats.clustersTested += boxCount;
+    stats.frustumCulled += boxCount - visibleCount;
+
+    if (displacingShader_) {
+        uniforms.displaceFromTexture.set(false); // Cluster-drawn chunks are ordinary meshes
+        displacingShader_ = false;
+    }
+    size_t trianglesBefore = stats.trianglesDrawn;
+    // The visible indices come back in increasing order, so each chunk's survivors are one contiguous run;
+    // they are rebased to the chunk's own cluster indices in place
+    size_t v = 0;
+    for (const ClusterBatchChunk& entry : frameClusterChunks_) {
+        size_t runStart = v;
+        while (v < visibleCount && frameVisibleClusters_[v] < entry.firstBox + entry.boxCount) {
+            frameVisibleClusters_[v] -= entry.firstBox;
+            v++;
+        }
+        entry.chunk->storeClusterHints(frameClusterBounds_, entry.firstBox);
+        if (v > runStart) {
+            entry.chunk->renderClusters(uniforms, renderOrigin, frameVisibleClusters_.data() + runStart, v - runStart, viewPosition, stats);
         }
     }
-}
\ No newline at end of file
+    return stats.trianglesDrawn - trianglesBefore;
+}
+
+bool TerrainManager::isSlotDrawable(const ChunkSlot& slot) {
+    // CPU-only (cached) chunks are not drawn
+    return slot.resident && slot.chunk && slot.chunk->isLoaded() && slot.chunk->isGpuResident();
+}
+
+void TerrainManager::markCullTreeChanged(Vec2i chunkCoords) {
+    if (cullTreeUpdates_.size() >= chunkWindow_.getSlotCount()) {
+        cullTree_.invalidate(); // Nothing rendered for a while: a rebuild is cheaper than replaying the list
+        cullTreeUpdates_.clear();
+    }
+    cullTreeUpdates_.push_back(chunkCoords);
+}
+
+void TerrainManager::cullChunks(const Frustum& frustum) {
+    // Without frustum culling every drawable chunk is visible; otherwise the tests below mark the visible ones.
+    // A requested chunk that is not drawable yet while its column is in view leaves a hole: counted as a pop-in
+    // when it is uploaded.
+    chunkWindow_.forEach([this, &frustum](const Vec2i& coords, ChunkSlot& slot) {
+        slot.visible = !cullingSettings.frustum && isSlotDrawable(slot);
+        if (slot.chunk && !slot.resident && !slot.missingInView && frustum.isAABBVisible(chunkColumnBounds(coords))) {
+            slot.missingInView = true;
+        }
+    });
+    if (!cullingSettings.frustum || !cullingSettings.hierarchical) {
+        cullTree_.invalidate();
+        cullTreeUpdates_.clear();
+    }
+    if (!cullingSettings.frustum) {
+        return;
+    }
+
+    ChunkCullStats cullStats;
+    if (cullingSettings.hierarchical) {
+        auto boundsOf = [this](Vec2i coords, BoundingBox& bounds) {
+            const ChunkSlot* slot = chunkWindow_.find(coords);
+            if (!slot || !isSlotDrawable(*slot)) return false;
+            bounds = slot->chunk->getWorldBounds();
+            return true;
+        };
+        int radius = chunkWindow_.getRadius();
+        Vec2i origin(chunkWindow_.getCenter().x - radius, chunkWindow_.getCenter().z - radius);
+        if (!cullTree_.covers(origin, 2 * radius + 1)) {
+            cullTree_.build(origin, 2 * radius + 1, boundsOf); // The window moved or was resized
+        } else {
+            for (const Vec2i& coords : cullTreeUpdates_) {
+                cullTree_.update(coords, boundsOf);
+            }
+        }
+        cullTreeUpdates_.clear();
+        cullTree_.cull(frustum, [this](const Vec2i& coords) { chunkWindow_.at(coords).visible = true; }, cullStats);
+    } else {
+        chunkWindow_.forEach([&](const Vec2i&, ChunkSlot& slot) {
+            if (!isSlotDrawable(slot)) return;
+            cullStats.boundsTested++;
+            slot.visible = frustum.isAABBVisible(slot.chunk->getWorldBounds());
+            if (!slot.visible) cullStats.chunksCulled++;
+        });
+    }
+    lastRenderStats_.chunksCulled = cullStats.chunksCulled;
+    lastRenderStats_.blocksCulled = cullStats.blocksCulled;
+    lastRenderStats_.boundsTested = cullStats.boundsTested;
+}
+
+int TerrainManager::selectLodLevel(const Chunk& chunk, const glm::vec3& viewPosition) const {
+    int maxLevel = lodIndexSet_.getLevelCount() - 1;
+
+    // Distance from the viewer to the closest point of the chunk's bounds
+    glm::vec3 boundsMin = chunk.getWorldBoundsMin();
+    glm::vec3 boundsMax = chunk.getWorldBoundsMax();
+    glm::vec3 closest(std::max(boundsMin.x, std::min(viewPosition.x, boundsMax.x)),
+                      std::max(boundsMin.y, std::min(viewPosition.y, boundsMax.y)),
+                      std::max(boundsMin.z, std::min(viewPosition.z, boundsMax.z)));
+    float distance = glm::length(closest - viewPosition);
+
+    // The adaptive radius controller coarsens every level choice by its LOD bias (1 when it is off)
+    float lodBias = adaptiveStatus_.lodBias;
+    if (lodSettings.mode == LodSelectionMode::Distance) {
+        float baseDistance = lodSettings.baseDistance / lodBias;
+        if (distance < baseDistance || baseDistance <= 0.0f) return 0;
+        int level = static_cast<int>(std::floor(std::log2(distance / baseDistance))) + 1;
+        return std::max(0, std::min(level, maxLevel));
+    }
+
+    // Screen-space error: pixels = worldError * viewportHeight / (2 * tan(fov / 2) * distance)
+    float pixelsPerWorldUnit = lodSettings.viewportHeight / (2.0f * std::tan(lodSettings.fovYRadians * 0.5f));
+    float safeDistance = std::max(distance, 1.0f);
+    int level = 0;
+    while (level < maxLevel &&
+           chunk.getLodError(level + 1) * pixelsPerWorldUnit / safeDistance <= lodSettings.pixelTolerance * lodBias) {
+        ++level;
+    }
+    return level;
+}
+
+void TerrainManager::constrainLodLevels() {
+    // Only ever lowers levels, so this converges in at most levelCount passes
+    const Vec2i neighborOffsets[4] = { Vec2i(-1, 0), Vec2i(1, 0), Vec2i(0, -1), Vec2i(0, 1) };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        chunkWindow_.forEach([&](const Vec2i& coords, ChunkSlot& slot) {
+            if (slot.lodLevel < 0) return;
+            for (const Vec2i& offset : neighborOffsets) {
+                const ChunkSlot* neighbor = chunkWindow_.find(Vec2i(coords.x + offset.x, coords.z + offset.z));
+                if (neighbor && neighbor->lodLevel >= 0 && slot.lodLevel > neighbor->lodLevel + 1) {
+                    slot.lodLevel = neighbor->lodLevel + 1;
+                    changed = true;
+                }
+            }
+        });
+    }
+}